@@ -0,0 +1,87 @@
+#include "pch.h"
+#include "benchmark.h"
+#include "libcommon/arena.h"
+#include "libcommon/string.h"
+#include <string>
+
+namespace benchmarklibcommon
+{
+
+namespace
+{
+
+//
+// Semicolon separated settings, long enough that keys and values are heap allocated
+// by the default allocator.
+//
+std::wstring CreateSettings()
+{
+	std::wstring settings;
+
+	for (int i = 0; i < 40; ++i)
+	{
+		settings.append(L"setting-name-").append(std::to_wstring(i))
+			.append(L"=a value that does not fit inline ").append(std::to_wstring(i * 7)).append(L";");
+	}
+
+	return settings;
+}
+
+} // anonymous namespace
+
+BENCHMARK(ArenaTokenizeAndSplit)
+{
+	const auto settings = CreateSettings();
+
+	Report("Default allocator, per request", Measure([&settings]()
+	{
+		const auto tokens = common::string::Tokenize(settings, L";");
+		const auto pairs = common::string::SplitKeyValuePairs(tokens);
+
+		KeepAlive(pairs.size());
+	}, 10));
+
+	common::memory::Arena arena;
+	common::memory::ArenaResource resource(arena);
+
+	Report("Arena, reset per request", Measure([&settings, &arena, &resource]()
+	{
+		{
+			const auto tokens = common::string::Tokenize(settings, L";", &resource);
+			const auto pairs = common::string::SplitKeyValuePairs(tokens, &resource);
+
+			KeepAlive(pairs.size());
+		}
+
+		arena.reset();
+	}, 10));
+}
+
+BENCHMARK(ArenaAllocate)
+{
+	Report("operator new and delete, 48 bytes", Measure([]()
+	{
+		auto p = new char[48];
+		KeepAlive(p);
+		delete[] p;
+	}));
+
+	common::memory::Arena arena;
+
+	size_t allocations = 0;
+
+	Report("Arena::allocate, 48 bytes", Measure([&arena, &allocations]()
+	{
+		KeepAlive(arena.allocate(48));
+
+		//
+		// Stay within a few chunks, as a request would.
+		//
+		if (0 == (++allocations % 4096))
+		{
+			arena.reset();
+		}
+	}));
+}
+
+}
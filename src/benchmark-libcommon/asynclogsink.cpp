@@ -0,0 +1,167 @@
+#include "pch.h"
+#include "benchmark.h"
+#include "libcommon/logging/asynclogsink.h"
+#include "libcommon/logging/logsink.h"
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace benchmarklibcommon
+{
+
+namespace
+{
+
+constexpr size_t MessagesPerThread = 20000;
+
+//
+// Messages logged back to back before a thread pauses, well within the queue capacity.
+//
+constexpr size_t BurstSize = 100;
+constexpr auto BurstPause = std::chrono::milliseconds(2);
+
+constexpr const char *Message = "Adapter configuration changed, re-applying firewall policy";
+
+//
+// Appends each message to a temporary file and flushes it, as a file log would.
+//
+common::logging::LogTarget CreateFileTarget()
+{
+	std::shared_ptr<FILE> file(std::tmpfile(), [](FILE *f)
+	{
+		std::fclose(f);
+	});
+
+	if (!file)
+	{
+		throw std::runtime_error("Failed to create temporary file");
+	}
+
+	return [file](common::logging::LogLevel, const char *msg)
+	{
+		std::fputs(msg, file.get());
+		std::fputc('\n', file.get());
+		std::fflush(file.get());
+	};
+}
+
+void Flush(common::logging::LogSink &)
+{
+}
+
+void Flush(common::logging::AsyncLogSink &sink)
+{
+	sink.flush();
+}
+
+struct Result
+{
+	// Time spent in each logging call, as seen by the caller.
+	Duration perCall;
+
+	// Rate at which messages reach the target.
+	double delivered;
+};
+
+//
+// Log `MessagesPerThread` messages from each of `threads` threads, either continuously
+// or in bursts separated by pauses. Only time spent in logging calls counts as call time.
+//
+template<typename Sink>
+Result LogFromThreads(Sink &sink, size_t threads, bool bursty)
+{
+	std::atomic<uint64_t> callTime = 0;
+
+	std::vector<std::thread> producers;
+
+	const auto start = Clock::now();
+
+	for (size_t i = 0; i < threads; ++i)
+	{
+		producers.emplace_back([&sink, &callTime, bursty]()
+		{
+			const auto burstSize = (bursty ? BurstSize : MessagesPerThread);
+
+			Clock::duration logging(0);
+
+			for (size_t logged = 0; logged < MessagesPerThread; logged += burstSize)
+			{
+				const auto burstStart = Clock::now();
+
+				for (size_t message = 0; message < burstSize; ++message)
+				{
+					sink.info(Message);
+				}
+
+				logging += Clock::now() - burstStart;
+
+				if (bursty)
+				{
+					std::this_thread::sleep_for(BurstPause);
+				}
+			}
+
+			callTime.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(logging).count());
+		});
+	}
+
+	for (auto &producer : producers)
+	{
+		producer.join();
+	}
+
+	Flush(sink);
+
+	const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+	const auto messages = threads * MessagesPerThread;
+
+	return Result{ Duration(static_cast<double>(callTime)) / messages, messages / elapsed.count() };
+}
+
+template<typename Sink>
+void MeasureSink(const std::string &label, Sink &sink, size_t threads)
+{
+	const auto suffix = ", " + std::to_string(threads) + (1 == threads ? " thread" : " threads");
+
+	const auto continuous = LogFromThreads(sink, threads, false);
+
+	Report((label + suffix + ", per call").c_str(), continuous.perCall);
+	Report((label + suffix + ", delivered").c_str(), continuous.delivered, "messages/s");
+
+	const auto bursty = LogFromThreads(sink, threads, true);
+
+	Report((label + suffix + ", per call in bursts").c_str(), bursty.perCall);
+}
+
+} // anonymous namespace
+
+BENCHMARK(AsyncLogSinkThroughput)
+{
+	for (const size_t threads : { size_t(1), size_t(4) })
+	{
+		{
+			common::logging::LogSink sink(CreateFileTarget());
+
+			MeasureSink("LogSink", sink, threads);
+		}
+
+		{
+			//
+			// Blocking on overflow makes every message reach the target, as with `LogSink`.
+			//
+			common::logging::AsyncLogSink::Options options;
+			options.overflowPolicy = common::logging::AsyncLogSink::OverflowPolicy::Block;
+
+			common::logging::AsyncLogSink sink(CreateFileTarget(), options);
+
+			MeasureSink("AsyncLogSink", sink, threads);
+		}
+	}
+}
+
+}
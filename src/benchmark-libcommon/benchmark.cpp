@@ -0,0 +1,64 @@
+#include "pch.h"
+#include "benchmark.h"
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace benchmarklibcommon
+{
+
+namespace
+{
+
+using BenchmarkList = std::vector<std::pair<const char *, Benchmark> >;
+
+BenchmarkList &Benchmarks()
+{
+	//
+	// Constructed on first use, as registrations run during static initialization.
+	//
+	static BenchmarkList benchmarks;
+	return benchmarks;
+}
+
+} // anonymous namespace
+
+void Report(const char *name, Duration perOperation)
+{
+	std::printf("  %-48s %12.1f ns/op %16.0f ops/s\n", name, perOperation.count(), 1e9 / perOperation.count());
+}
+
+void Report(const char *name, double value, const char *unit)
+{
+	std::printf("  %-48s %12.1f %s\n", name, value, unit);
+}
+
+Registration::Registration(const char *name, Benchmark benchmark)
+{
+	Benchmarks().emplace_back(name, benchmark);
+}
+
+size_t RunBenchmarks(const char *filter)
+{
+	size_t run = 0;
+
+	for (const auto &[name, benchmark] : Benchmarks())
+	{
+		if (nullptr == strstr(name, filter))
+		{
+			continue;
+		}
+
+		std::printf("%s\n", name);
+		std::fflush(stdout);
+
+		benchmark();
+
+		++run;
+	}
+
+	return run;
+}
+
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+namespace benchmarklibcommon
+{
+
+using Clock = std::chrono::steady_clock;
+using Duration = std::chrono::duration<double, std::nano>;
+
+//
+// Time spent measuring a single operation, to even out timer resolution and noise.
+//
+constexpr auto MinimumDuration = std::chrono::milliseconds(200);
+
+// Written by `KeepAlive`, never read.
+inline const void *volatile g_keepAlive = nullptr;
+
+//
+// Keeps the compiler from discarding a value that is otherwise unused.
+//
+template<typename T>
+void KeepAlive(const T &value)
+{
+	g_keepAlive = &value;
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+//
+// Invokes `operation` in batches of `batchSize` calls until at least `MinimumDuration`
+// has passed, and returns the mean time per call.
+//
+template<typename Operation>
+Duration Measure(Operation &&operation, size_t batchSize = 1000)
+{
+	// Warm up caches and lazily initialized state.
+	operation();
+
+	size_t calls = 0;
+
+	const auto start = Clock::now();
+	Clock::duration elapsed;
+
+	do
+	{
+		for (size_t i = 0; i < batchSize; ++i)
+		{
+			operation();
+		}
+
+		calls += batchSize;
+		elapsed = Clock::now() - start;
+	}
+	while (elapsed < MinimumDuration);
+
+	return Duration(elapsed) / calls;
+}
+
+//
+// Print the time per operation and the resulting rate.
+//
+void Report(const char *name, Duration perOperation);
+
+//
+// Print a measured quantity other than time per operation.
+//
+void Report(const char *name, double value, const char *unit);
+
+using Benchmark = void (*)();
+
+//
+// Benchmarks register themselves with `BENCHMARK`.
+//
+struct Registration
+{
+	Registration(const char *name, Benchmark benchmark);
+};
+
+//
+// Run the benchmarks whose name contains `filter`, in registration order.
+// Returns the number of benchmarks run.
+//
+size_t RunBenchmarks(const char *filter);
+
+}
+
+#define BENCHMARK(name)\
+static void name();\
+static const ::benchmarklibcommon::Registration name##Registration(#name, name);\
+static void name()
@@ -0,0 +1,146 @@
+#include "pch.h"
+#include "benchmark.h"
+#include "libcommon/binaryreader.h"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace benchmarklibcommon
+{
+
+namespace
+{
+
+//
+// Records as they might appear in a driver or IPC blob:
+//
+// uint16_t type, big endian
+// uint16_t length, big endian
+// uint32_t value, native
+// uint8_t payload[length]
+//
+// Padded to a multiple of 4 bytes.
+//
+
+constexpr size_t RecordCount = 4096;
+
+std::vector<uint8_t> CreateRecords()
+{
+	std::vector<uint8_t> buffer;
+
+	for (size_t i = 0; i < RecordCount; ++i)
+	{
+		const auto length = static_cast<uint16_t>(i % 23);
+
+		const uint8_t header[] =
+		{
+			uint8_t(i >> 8), uint8_t(i), uint8_t(length >> 8), uint8_t(length)
+		};
+
+		const auto value = static_cast<uint32_t>(i * 2654435761u);
+
+		buffer.insert(buffer.end(), header, header + sizeof(header));
+		buffer.insert(buffer.end(), reinterpret_cast<const uint8_t *>(&value), reinterpret_cast<const uint8_t *>(&value + 1));
+		buffer.insert(buffer.end(), length, uint8_t(i));
+		buffer.resize(::common::math::RoundPowerTwo(buffer.size(), 4));
+	}
+
+	return buffer;
+}
+
+uint64_t ParseWithReader(const std::vector<uint8_t> &buffer)
+{
+	common::BinaryReader reader(common::ConstBufferView(buffer.data(), buffer.size()));
+
+	uint64_t sum = 0;
+
+	while (false == reader.exhausted())
+	{
+		const auto type = reader.read<uint16_t, common::ByteOrder::BigEndian>();
+		const auto length = reader.read<uint16_t, common::ByteOrder::BigEndian>();
+		const auto value = reader.read<uint32_t>();
+		const auto payload = reader.slice(length);
+
+		reader.align(4);
+
+		sum += type + value + (0 == payload.size() ? 0 : payload.data()[0]);
+	}
+
+	return sum;
+}
+
+//
+// What consumers wrote by hand before there was a reader, with the same checks.
+//
+uint64_t ParseManually(const std::vector<uint8_t> &buffer)
+{
+	const auto begin = buffer.data();
+	const auto end = begin + buffer.size();
+
+	auto current = begin;
+
+	uint64_t sum = 0;
+
+	while (current != end)
+	{
+		if (static_cast<size_t>(end - current) < 8)
+		{
+			throw std::runtime_error("Truncated record");
+		}
+
+		const auto type = static_cast<uint16_t>((current[0] << 8) | current[1]);
+		const auto length = static_cast<uint16_t>((current[2] << 8) | current[3]);
+
+		uint32_t value;
+		memcpy(&value, current + 4, sizeof(value));
+
+		current += 8;
+
+		if (static_cast<size_t>(end - current) < length)
+		{
+			throw std::runtime_error("Truncated record");
+		}
+
+		const auto payload = current;
+
+		current += length;
+
+		const auto padding = ::common::math::RoundPowerTwo(static_cast<size_t>(current - begin), 4) - (current - begin);
+
+		if (static_cast<size_t>(end - current) < padding)
+		{
+			throw std::runtime_error("Truncated record");
+		}
+
+		current += padding;
+
+		sum += type + value + (0 == length ? 0 : payload[0]);
+	}
+
+	return sum;
+}
+
+} // anonymous namespace
+
+BENCHMARK(BinaryReaderParseRecords)
+{
+	const auto buffer = CreateRecords();
+
+	if (ParseWithReader(buffer) != ParseManually(buffer))
+	{
+		throw std::logic_error("Parsers disagree");
+	}
+
+	Report("BinaryReader, per record", Measure([&buffer]()
+	{
+		KeepAlive(ParseWithReader(buffer));
+	}, 10) / RecordCount);
+
+	Report("Manual pointer arithmetic, per record", Measure([&buffer]()
+	{
+		KeepAlive(ParseManually(buffer));
+	}, 10) / RecordCount);
+}
+
+}
@@ -0,0 +1,266 @@
+#include "pch.h"
+#include "benchmark.h"
+#include "libcommon/burstguard.h"
+#include "libcommon/error.h"
+#include "libcommon/memory.h"
+#include "libcommon/timerwheel.h"
+#include <windows.h>
+#include <tlhelp32.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace benchmarklibcommon
+{
+
+namespace
+{
+
+constexpr size_t GuardCount = 1000;
+constexpr uint32_t BurstDuration = 20;
+constexpr size_t Rounds = 10;
+
+//
+// Number of threads in this process.
+//
+size_t ThreadCount()
+{
+	common::memory::UniqueKernelHandle snapshot(CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0));
+
+	if (false == bool(snapshot))
+	{
+		THROW_WINDOWS_ERROR(GetLastError(), "Create thread snapshot");
+	}
+
+	const auto processId = GetCurrentProcessId();
+
+	THREADENTRY32 entry;
+	entry.dwSize = sizeof(entry);
+
+	size_t count = 0;
+
+	for (auto found = Thread32First(snapshot.get(), &entry); FALSE != found; found = Thread32Next(snapshot.get(), &entry))
+	{
+		if (processId == entry.th32OwnerProcessID)
+		{
+			++count;
+		}
+	}
+
+	return count;
+}
+
+//
+// Create `GuardCount` guards, start a burst on each of them and wait for all of the callbacks.
+// The guards either share one timer wheel or each create their own.
+//
+void MeasureGuards(const std::string &label, bool shareScheduler)
+{
+	std::atomic<size_t> fired = 0;
+
+	const auto threadsBefore = ThreadCount();
+
+	auto start = Clock::now();
+
+	std::shared_ptr<common::TimerWheel> scheduler;
+
+	if (shareScheduler)
+	{
+		scheduler = std::make_shared<common::TimerWheel>();
+	}
+
+	std::vector<std::unique_ptr<common::BurstGuard> > guards;
+
+	for (size_t i = 0; i < GuardCount; ++i)
+	{
+		guards.push_back(std::make_unique<common::BurstGuard>([&fired]()
+		{
+			fired.fetch_add(1);
+		}, BurstDuration, 0, scheduler));
+	}
+
+	const std::chrono::duration<double, std::milli> creation = Clock::now() - start;
+
+	const auto threads = ThreadCount() - threadsBefore;
+
+	Duration arming(0);
+	std::chrono::duration<double, std::milli> lateness(0);
+
+	for (size_t round = 0; round < Rounds; ++round)
+	{
+		fired = 0;
+
+		start = Clock::now();
+
+		for (auto &guard : guards)
+		{
+			guard->trigger();
+		}
+
+		const auto triggered = Clock::now();
+
+		arming += triggered - start;
+
+		while (fired < GuardCount)
+		{
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+
+		//
+		// The burst of the last guard triggered ends `BurstDuration` after the loop.
+		//
+		lateness += Clock::now() - triggered - std::chrono::milliseconds(BurstDuration);
+	}
+
+	start = Clock::now();
+
+	guards.clear();
+	scheduler.reset();
+
+	const std::chrono::duration<double, std::milli> destruction = Clock::now() - start;
+
+	Report((label + ", threads created").c_str(), static_cast<double>(threads), "threads");
+	Report((label + ", create all guards").c_str(), creation.count(), "ms");
+	Report((label + ", destroy all guards").c_str(), destruction.count(), "ms");
+	Report((label + ", trigger that starts a burst").c_str(), arming / (Rounds * GuardCount));
+	Report((label + ", last callback after burst end").c_str(), lateness.count() / Rounds, "ms");
+}
+
+//
+// The trigger path before triggers within a burst became lock-free:
+// every trigger takes the lock, reads the tick count and re-arms the timer.
+//
+class LockedBurstGuard
+{
+public:
+
+	LockedBurstGuard(common::BurstGuard::Callback callback, uint32_t burstDuration,
+		std::shared_ptr<common::TimerWheel> scheduler)
+		: m_callback(std::move(callback))
+		, m_burstDuration(burstDuration)
+		, m_timestampBurstStart(0)
+		, m_scheduler(std::move(scheduler))
+		, m_timer(*m_scheduler, [this]() { burstEnded(); })
+	{
+	}
+
+	void trigger()
+	{
+		std::scoped_lock<std::mutex> lock(m_mutex);
+
+		const uint64_t timestampNow = static_cast<uint64_t>(GetTickCount64());
+
+		if (0 == m_timestampBurstStart)
+		{
+			m_timestampBurstStart = timestampNow;
+		}
+
+		m_timer.arm(common::TimerWheel::Duration(m_burstDuration));
+	}
+
+private:
+
+	void burstEnded()
+	{
+		std::scoped_lock<std::mutex> lock(m_mutex);
+
+		if (0 != m_timestampBurstStart)
+		{
+			m_callback();
+			m_timestampBurstStart = 0;
+		}
+	}
+
+	common::BurstGuard::Callback m_callback;
+	uint32_t m_burstDuration;
+
+	std::mutex m_mutex;
+	uint64_t m_timestampBurstStart;
+
+	std::shared_ptr<common::TimerWheel> m_scheduler;
+	common::TimerWheel::Timer m_timer;
+};
+
+//
+// Trigger `guard` from `producers` threads for `MinimumDuration`,
+// and return the total number of triggers per second.
+//
+template<typename Guard>
+double TriggerStorm(Guard &guard, size_t producers)
+{
+	std::atomic<bool> stop = false;
+	std::atomic<uint64_t> triggers = 0;
+
+	std::vector<std::thread> threads;
+
+	const auto start = Clock::now();
+
+	for (size_t i = 0; i < producers; ++i)
+	{
+		threads.emplace_back([&guard, &stop, &triggers]()
+		{
+			uint64_t count = 0;
+
+			while (false == stop.load(std::memory_order_relaxed))
+			{
+				guard.trigger();
+				++count;
+			}
+
+			triggers.fetch_add(count);
+		});
+	}
+
+	std::this_thread::sleep_for(MinimumDuration);
+
+	stop = true;
+
+	for (auto &thread : threads)
+	{
+		thread.join();
+	}
+
+	const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+	return triggers / elapsed.count();
+}
+
+} // anonymous namespace
+
+BENCHMARK(BurstGuardScheduling)
+{
+	MeasureGuards("Dedicated", false);
+	MeasureGuards("Shared wheel", true);
+}
+
+BENCHMARK(BurstGuardTriggerContention)
+{
+	//
+	// Long enough that the storm is a single burst.
+	//
+	constexpr uint32_t StormBurstDuration = 1000;
+
+	const auto scheduler = std::make_shared<common::TimerWheel>();
+
+	for (const size_t producers : { size_t(1), size_t(2), size_t(4), size_t(8) })
+	{
+		const auto threads = std::to_string(producers) + (1 == producers ? " thread" : " threads");
+
+		{
+			LockedBurstGuard guard([]() {}, StormBurstDuration, scheduler);
+
+			Report(("Locked trigger, " + threads).c_str(), TriggerStorm(guard, producers), "triggers/s");
+		}
+
+		{
+			common::BurstGuard guard([]() {}, StormBurstDuration, 0, scheduler);
+
+			Report(("Lock-free trigger, " + threads).c_str(), TriggerStorm(guard, producers), "triggers/s");
+		}
+	}
+}
+
+}
@@ -0,0 +1,122 @@
+#include "pch.h"
+#include "benchmark.h"
+#include "libcommon/memory.h"
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace benchmarklibcommon
+{
+
+namespace
+{
+
+//
+// Elements per table, about the size of the port and address tables in a large filter set.
+//
+constexpr size_t TableSize = 16 * 1024;
+
+template<typename T>
+std::vector<T> CreateTable()
+{
+	std::vector<T> table(TableSize);
+
+	for (size_t i = 0; i < table.size(); ++i)
+	{
+		table[i] = static_cast<T>(i * 0x9E3779B97F4A7C15ull);
+	}
+
+	return table;
+}
+
+//
+// One element at a time, as callers converted tables before the bulk functions existed.
+//
+template<typename T>
+void ByteSwapEach(std::vector<T> &table)
+{
+	for (auto &value : table)
+	{
+		value = common::memory::ByteSwap(value);
+	}
+}
+
+template<typename T>
+void ByteSwapBulk(std::vector<T> &table)
+{
+	if constexpr (sizeof(T) == sizeof(uint16_t))
+	{
+		common::memory::ByteSwap16(table.data(), table.data(), table.size());
+	}
+	else if constexpr (sizeof(T) == sizeof(uint32_t))
+	{
+		common::memory::ByteSwap32(table.data(), table.data(), table.size());
+	}
+	else
+	{
+		common::memory::ByteSwap64(table.data(), table.data(), table.size());
+	}
+}
+
+template<typename T>
+void Compare()
+{
+	auto table = CreateTable<T>();
+
+	auto expected = table;
+	auto actual = table;
+
+	ByteSwapEach(expected);
+	ByteSwapBulk(actual);
+
+	if (expected != actual)
+	{
+		throw std::logic_error("Bulk and scalar conversions disagree");
+	}
+
+	const auto bits = std::to_string(sizeof(T) * 8);
+
+	Report(("Scalar loop, " + bits + "-bit, per table").c_str(), Measure([&table]()
+	{
+		ByteSwapEach(table);
+		KeepAlive(table[0]);
+	}, 10));
+
+	Report(("ByteSwap" + bits + ", per table").c_str(), Measure([&table]()
+	{
+		ByteSwapBulk(table);
+		KeepAlive(table[0]);
+	}, 10));
+}
+
+} // anonymous namespace
+
+BENCHMARK(ByteSwapInPlace)
+{
+	Compare<uint16_t>();
+	Compare<uint32_t>();
+	Compare<uint64_t>();
+}
+
+BENCHMARK(ByteSwapUnaligned)
+{
+	//
+	// Addresses read straight out of a packed blob are rarely aligned.
+	//
+	std::vector<uint8_t> source(TableSize * sizeof(uint32_t) + 1);
+	std::vector<uint8_t> destination(source.size());
+
+	for (size_t i = 0; i < source.size(); ++i)
+	{
+		source[i] = static_cast<uint8_t>(i);
+	}
+
+	Report("ByteSwap32, unaligned, per table", Measure([&source, &destination]()
+	{
+		common::memory::ByteSwap32(source.data() + 1, destination.data() + 1, TableSize);
+		KeepAlive(destination[1]);
+	}, 10));
+}
+
+}
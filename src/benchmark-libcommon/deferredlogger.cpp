@@ -0,0 +1,91 @@
+#include "pch.h"
+#include "benchmark.h"
+#include "libcommon/logging/deferredlogger.h"
+#include "libcommon/logging/logsink.h"
+#include "libcommon/string.h"
+#include <atomic>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace benchmarklibcommon
+{
+
+namespace
+{
+
+constexpr size_t RecordCount = 200000;
+
+constexpr GUID AdapterGuid = { 0x4d36e972, 0xe325, 0x11ce, { 0xbf, 0xc1, 0x08, 0x00, 0x2b, 0xe1, 0x03, 0x18 } };
+constexpr uint32_t AdapterAddress = 0x0A400001;
+
+//
+// Counts delivered messages and otherwise discards them.
+//
+std::shared_ptr<common::logging::LogSink> CreateSink(std::atomic<uint64_t> &delivered)
+{
+	return std::make_shared<common::logging::LogSink>([&delivered](common::logging::LogLevel, const char *msg)
+	{
+		KeepAlive(msg);
+		delivered.fetch_add(1, std::memory_order_relaxed);
+	});
+}
+
+} // anonymous namespace
+
+BENCHMARK(DeferredLoggerThroughput)
+{
+	std::atomic<uint64_t> delivered = 0;
+
+	const auto sink = CreateSink(delivered);
+
+	uint32_t index = 0;
+
+	Report("Format, then LogSink::info", Measure([&sink, &index]()
+	{
+		std::stringstream ss;
+
+		ss << "Adapter " << common::string::ToAnsi(common::string::FormatGuid(AdapterGuid))
+			<< " has index " << ++index
+			<< " and address " << common::string::ToAnsi(common::string::FormatIpv4(AdapterAddress));
+
+		sink->info(ss.str().c_str());
+	}));
+
+	//
+	// The logger is large enough to hold every record, so the time per call
+	// is only the cost to the logging thread.
+	//
+	{
+		common::logging::DeferredLogger logger(sink, RecordCount * 64);
+
+		delivered = 0;
+
+		const auto start = Clock::now();
+
+		for (size_t i = 0; i < RecordCount; ++i)
+		{
+			LOG_DEFERRED(&logger, common::logging::LogLevel::Info, "Adapter {} has index {} and address {}",
+				AdapterGuid, ++index, common::logging::Ipv4Argument{ AdapterAddress });
+		}
+
+		const auto logged = Clock::now();
+
+		logger.flush();
+
+		const auto flushed = Clock::now();
+
+		if (0 != logger.dropped() || RecordCount != delivered)
+		{
+			throw std::logic_error("Records were dropped");
+		}
+
+		Report("LOG_DEFERRED, per call", Duration(logged - start) / RecordCount);
+		Report("LOG_DEFERRED, including formatting", Duration(flushed - start) / RecordCount);
+	}
+
+	KeepAlive(index);
+}
+
+}
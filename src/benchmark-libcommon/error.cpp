@@ -0,0 +1,138 @@
+#include "pch.h"
+#include "benchmark.h"
+#include "libcommon/error.h"
+#include "libcommon/memory.h"
+#include "libcommon/string.h"
+#include <windows.h>
+#include <iomanip>
+#include <ios>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace benchmarklibcommon
+{
+
+namespace
+{
+
+//
+// Returned by registry reads of a value that does not exist.
+//
+constexpr DWORD MissingValue = ERROR_FILE_NOT_FOUND;
+
+//
+// How `error::Throw` formatted Windows errors before messages became lazy:
+// the system message is looked up and the full message is built before throwing.
+//
+[[noreturn]] void ThrowEagerly(const char *operation, DWORD errorCode, const char *file, size_t line)
+{
+	common::memory::UniqueLocalMemory<LPSTR> buffer;
+
+	std::string systemMessage("System error");
+
+	if (0 != FormatMessageA(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
+		nullptr, errorCode, 0, reinterpret_cast<LPSTR>(buffer.receive()), 0, nullptr))
+	{
+		systemMessage = common::string::TrimRight(std::string(buffer.get()));
+	}
+
+	std::stringstream ss;
+
+	ss << operation << ": 0x" << std::setw(8) << std::setfill('0') << std::hex << errorCode
+		<< std::setw(1) << std::dec
+		<< ": " << systemMessage;
+
+	common::error::Throw<common::error::WindowsException>(ss.str().c_str(), file, line, errorCode);
+}
+
+//
+// Throw from `depth` frames below the caller, so a captured trace has a realistic number of frames to walk.
+//
+__declspec(noinline) void ThrowFromDepth(size_t depth)
+{
+	if (0 == depth)
+	{
+		THROW_WINDOWS_ERROR(MissingValue, "Read registry value");
+	}
+
+	ThrowFromDepth(depth - 1);
+
+	KeepAlive(depth);
+}
+
+Duration MeasureThrowFromDepth(size_t depth)
+{
+	return Measure([depth]()
+	{
+		try
+		{
+			ThrowFromDepth(depth);
+		}
+		catch (const std::exception &e)
+		{
+			KeepAlive(e);
+		}
+	});
+}
+
+} // anonymous namespace
+
+BENCHMARK(ErrorThrowMissingValue)
+{
+	Report("Eager message, caught and discarded", Measure([]()
+	{
+		try
+		{
+			ThrowEagerly("Read registry value", MissingValue, __FILE__, __LINE__);
+		}
+		catch (const std::exception &e)
+		{
+			KeepAlive(e);
+		}
+	}));
+
+	Report("Lazy message, caught and discarded", Measure([]()
+	{
+		try
+		{
+			THROW_WINDOWS_ERROR(MissingValue, "Read registry value");
+		}
+		catch (const std::exception &e)
+		{
+			KeepAlive(e);
+		}
+	}));
+
+	Report("Lazy message, what() read", Measure([]()
+	{
+		try
+		{
+			THROW_WINDOWS_ERROR(MissingValue, "Read registry value");
+		}
+		catch (const std::exception &e)
+		{
+			KeepAlive(e.what());
+		}
+	}));
+}
+
+BENCHMARK(ErrorThrowStackTrace)
+{
+	const auto enabled = common::error::StackTracesEnabled();
+
+	for (const size_t depth : { size_t(0), size_t(10), size_t(30) })
+	{
+		const auto frames = std::to_string(depth) + " frames deep";
+
+		common::error::EnableStackTraces(false);
+		Report(("Without stack trace, " + frames).c_str(), MeasureThrowFromDepth(depth));
+
+		common::error::EnableStackTraces(true);
+		Report(("With stack trace, " + frames).c_str(), MeasureThrowFromDepth(depth));
+	}
+
+	common::error::EnableStackTraces(enabled);
+}
+
+}
@@ -0,0 +1,140 @@
+#include "pch.h"
+#include "benchmark.h"
+#include "libcommon/logging/flightrecorderlogsink.h"
+#include "libcommon/logging/logsink.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace benchmarklibcommon
+{
+
+namespace
+{
+
+constexpr const char *ShortMessage = "Route table changed";
+
+constexpr const char *LongMessage =
+	"Adapter {4d36e972-e325-11ce-bfc1-08002be10318} changed state from connected to disconnected, "
+	"re-evaluating default route, DNS configuration and firewall policy for the tunnel interface";
+
+void Discard(common::logging::LogLevel, const char *msg)
+{
+	KeepAlive(msg);
+}
+
+//
+// Wall time per message with `threads` threads calling `trace()` at once.
+//
+Duration MeasureConcurrent(common::logging::ILogSink &sink, const char *msg, size_t threads)
+{
+	constexpr size_t MessagesPerThread = 1000000;
+
+	std::vector<std::thread> loggers;
+
+	const auto start = Clock::now();
+
+	for (size_t i = 0; i < threads; ++i)
+	{
+		loggers.emplace_back([&sink, msg]()
+		{
+			for (size_t message = 0; message < MessagesPerThread; ++message)
+			{
+				sink.trace(msg);
+			}
+		});
+	}
+
+	for (auto &logger : loggers)
+	{
+		logger.join();
+	}
+
+	return Duration(Clock::now() - start) / (threads * MessagesPerThread);
+}
+
+} // anonymous namespace
+
+BENCHMARK(FlightRecorderRecord)
+{
+	common::logging::FlightRecorderLogSink::Options options;
+	options.dumpOnError = false;
+
+	common::logging::FlightRecorderLogSink recorder(Discard, options);
+
+	Report("FlightRecorder, short message", Measure([&recorder]()
+	{
+		recorder.trace(ShortMessage);
+	}));
+
+	Report("FlightRecorder, long message", Measure([&recorder]()
+	{
+		recorder.trace(LongMessage);
+	}));
+
+	Report("FlightRecorder, short message, 4 threads", MeasureConcurrent(recorder, ShortMessage, 4));
+
+	//
+	// For reference, the cheapest possible synchronous sink.
+	//
+	common::logging::LogSink sink(Discard);
+
+	Report("LogSink with no-op target, short message", Measure([&sink]()
+	{
+		sink.trace(ShortMessage);
+	}));
+
+	Report("LogSink with no-op target, 4 threads", MeasureConcurrent(sink, ShortMessage, 4));
+}
+
+BENCHMARK(FlightRecorderDump)
+{
+	constexpr size_t Threads = 8;
+
+	common::logging::FlightRecorderLogSink::Options options;
+	options.dumpOnError = false;
+
+	common::logging::FlightRecorderLogSink recorder(Discard, options);
+
+	const auto fill = [&recorder, &options]()
+	{
+		std::vector<std::thread> loggers;
+
+		for (size_t i = 0; i < Threads; ++i)
+		{
+			loggers.emplace_back([&recorder, &options]()
+			{
+				for (size_t message = 0; message < options.entriesPerThread; ++message)
+				{
+					recorder.trace(ShortMessage);
+				}
+			});
+		}
+
+		for (auto &logger : loggers)
+		{
+			logger.join();
+		}
+	};
+
+	Duration dumping(0);
+
+	constexpr size_t Rounds = 20;
+
+	for (size_t round = 0; round < Rounds; ++round)
+	{
+		fill();
+
+		const auto start = Clock::now();
+
+		recorder.dump();
+
+		dumping += Clock::now() - start;
+	}
+
+	const auto entries = Rounds * Threads * options.entriesPerThread;
+
+	Report(("Dump " + std::to_string(Threads) + " full rings, per entry").c_str(), dumping / entries);
+}
+
+}
@@ -0,0 +1,72 @@
+#include "pch.h"
+#include "benchmark.h"
+#include "libcommon/guid.h"
+#include <stdexcept>
+#include <string>
+
+namespace benchmarklibcommon
+{
+
+namespace
+{
+
+//
+// Parse `candidate` the way a caller polling for optional input did before the try variants:
+// with the throwing function and a catch for the miss.
+//
+bool ParseOrCatch(const std::wstring &candidate)
+{
+	try
+	{
+		KeepAlive(common::Guid::FromString(candidate));
+		return true;
+	}
+	catch (const std::exception &)
+	{
+		return false;
+	}
+}
+
+bool TryParse(const std::wstring &candidate)
+{
+	const auto guid = common::Guid::TryFromString(candidate);
+
+	KeepAlive(guid);
+
+	return guid.hasValue();
+}
+
+void Compare(const std::string &label, const std::wstring &candidate)
+{
+	Report((label + ", FromString and catch").c_str(), Measure([&candidate]()
+	{
+		KeepAlive(ParseOrCatch(candidate));
+	}));
+
+	Report((label + ", TryFromString").c_str(), Measure([&candidate]()
+	{
+		KeepAlive(TryParse(candidate));
+	}));
+}
+
+} // anonymous namespace
+
+BENCHMARK(GuidParseMiss)
+{
+	//
+	// Rejected on length, before the string reaches the RPC runtime.
+	//
+	Compare("Wrong length", L"{00000000-0000}");
+
+	//
+	// Rejected by `UuidFromStringW`.
+	//
+	Compare("Bad digits", L"{zzzzzzzz-0000-0000-0000-000000000000}");
+
+	//
+	// Every lookup succeeds, so neither variant pays for a miss.
+	//
+	Compare("Valid", L"{6ba7b810-9dad-11d1-80b4-00c04fd430c8}");
+}
+
+}
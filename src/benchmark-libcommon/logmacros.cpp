@@ -0,0 +1,55 @@
+#include "pch.h"
+#include "benchmark.h"
+#include "libcommon/logging/logmacros.h"
+#include "libcommon/logging/logsink.h"
+#include "libcommon/string.h"
+#include <memory>
+#include <sstream>
+#include <string>
+
+namespace benchmarklibcommon
+{
+
+namespace
+{
+
+const std::wstring AdapterName = L"Mullvad Tunnel Adapter #2";
+
+} // anonymous namespace
+
+BENCHMARK(LogMacrosDisabledTrace)
+{
+	auto sink = std::make_shared<common::logging::LogSink>([](common::logging::LogLevel, const char *msg)
+	{
+		KeepAlive(msg);
+	});
+
+	sink->setMinimumLevel(common::logging::LogLevel::Info);
+
+	uint32_t index = 0;
+
+	//
+	// What callers wrote before the macros: the message is built and then discarded by the sink.
+	//
+	Report("Format, then call trace()", Measure([&sink, &index]()
+	{
+		std::stringstream ss;
+		ss << "Opened adapter " << common::string::ToAnsi(AdapterName) << ", index " << ++index;
+
+		sink->trace(ss.str().c_str());
+	}));
+
+	Report("LOG_TRACE, level disabled", Measure([&sink, &index]()
+	{
+		LOG_TRACE(sink, "Opened adapter " << common::string::ToAnsi(AdapterName) << ", index " << ++index);
+	}));
+
+	Report("LOG_INFO, level enabled", Measure([&sink, &index]()
+	{
+		LOG_INFO(sink, "Opened adapter " << common::string::ToAnsi(AdapterName) << ", index " << ++index);
+	}));
+
+	KeepAlive(index);
+}
+
+}
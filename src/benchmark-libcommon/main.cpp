@@ -0,0 +1,31 @@
+#include "pch.h"
+#include "benchmark.h"
+#include <cstdio>
+#include <exception>
+
+//
+// benchmark-libcommon [filter]
+//
+// Runs the benchmarks whose name contains `filter`, or all of them.
+// Build and run in a release configuration for meaningful numbers.
+//
+int main(int argc, const char *argv[])
+{
+	const auto filter = (argc > 1 ? argv[1] : "");
+
+	try
+	{
+		if (0 == benchmarklibcommon::RunBenchmarks(filter))
+		{
+			std::fprintf(stderr, "No benchmark matches \"%s\"\n", filter);
+			return 1;
+		}
+	}
+	catch (const std::exception &e)
+	{
+		std::fprintf(stderr, "Benchmark failed: %s\n", e.what());
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,152 @@
+#include "pch.h"
+#include "benchmark.h"
+#include "libcommon/clock.h"
+#include "libcommon/ratelimiter.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace benchmarklibcommon
+{
+
+namespace
+{
+
+//
+// Token bucket behind a lock, the obvious alternative to the GCRA state in `RateLimiter`.
+//
+class LockedTokenBucket
+{
+public:
+
+	LockedTokenBucket(common::IClock::Duration interval, uint32_t burst, std::shared_ptr<common::IClock> clock)
+		: m_clock(std::move(clock))
+		, m_interval(interval.count())
+		, m_capacity(burst)
+		, m_tokens(burst)
+		, m_refilled(m_clock->now().count())
+	{
+	}
+
+	bool tryAcquire(uint32_t permits = 1)
+	{
+		std::scoped_lock<std::mutex> lock(m_mutex);
+
+		const auto now = m_clock->now().count();
+		const auto earned = (now - m_refilled) / m_interval;
+
+		if (0 != earned)
+		{
+			m_tokens = static_cast<uint32_t>((std::min)(int64_t(m_capacity), m_tokens + earned));
+			m_refilled += earned * m_interval;
+		}
+
+		if (m_tokens < permits)
+		{
+			return false;
+		}
+
+		m_tokens -= permits;
+
+		return true;
+	}
+
+private:
+
+	std::shared_ptr<common::IClock> m_clock;
+
+	int64_t m_interval;
+	uint32_t m_capacity;
+
+	std::mutex m_mutex;
+	uint32_t m_tokens;
+	int64_t m_refilled;
+};
+
+//
+// Call `tryAcquire` on `limiter` from `threads` threads for `MinimumDuration`,
+// and return the total number of attempts per second.
+//
+template<typename Limiter>
+double AcquireStorm(Limiter &limiter, size_t threads)
+{
+	std::atomic<bool> stop = false;
+	std::atomic<uint64_t> attempts = 0;
+
+	std::vector<std::thread> workers;
+
+	const auto start = Clock::now();
+
+	for (size_t i = 0; i < threads; ++i)
+	{
+		workers.emplace_back([&limiter, &stop, &attempts]()
+		{
+			uint64_t attempted = 0;
+
+			while (false == stop.load(std::memory_order_relaxed))
+			{
+				KeepAlive(limiter.tryAcquire());
+				++attempted;
+			}
+
+			attempts.fetch_add(attempted);
+		});
+	}
+
+	std::this_thread::sleep_for(MinimumDuration);
+
+	stop = true;
+
+	for (auto &worker : workers)
+	{
+		worker.join();
+	}
+
+	const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+	return attempts / elapsed.count();
+}
+
+//
+// `interval` and `burst` decide whether most attempts are granted or denied.
+//
+void CompareLimiters(const std::string &label, common::IClock::Duration interval, uint32_t burst)
+{
+	const auto clock = std::make_shared<common::SteadyClock>();
+
+	for (const size_t threads : { size_t(1), size_t(2), size_t(4), size_t(8) })
+	{
+		const auto suffix = ", " + std::to_string(threads) + (1 == threads ? " thread" : " threads");
+
+		LockedTokenBucket bucket(interval, burst, clock);
+		const auto locked = AcquireStorm(bucket, threads);
+
+		common::RateLimiter limiter(interval, burst, clock);
+		const auto lockFree = AcquireStorm(limiter, threads);
+
+		Report((label + ", locked bucket" + suffix).c_str(), locked, "attempts/s");
+		Report((label + ", RateLimiter" + suffix).c_str(), lockFree, "attempts/s");
+	}
+}
+
+} // anonymous namespace
+
+BENCHMARK(RateLimiterContention)
+{
+	//
+	// Far more permits than callers can take, so every attempt updates the state.
+	//
+	CompareLimiters("Granted", std::chrono::nanoseconds(1), 1000000);
+
+	//
+	// Ten permits per second, so nearly every attempt is denied without a write.
+	//
+	CompareLimiters("Denied", std::chrono::milliseconds(100), 1);
+}
+
+}
@@ -0,0 +1,133 @@
+#include "pch.h"
+#include "benchmark.h"
+#include "libcommon/ringbuffer.h"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace benchmarklibcommon
+{
+
+namespace
+{
+
+constexpr size_t Capacity = 64 * 1024;
+constexpr size_t TransferSize = 256 * 1024 * 1024;
+
+//
+// Move `TransferSize` bytes from a producer thread to a consumer thread in chunks of
+// `chunkSize` bytes, and return the time taken.
+//
+Clock::duration Transfer(size_t chunkSize)
+{
+	common::ByteRingBuffer ring(Capacity);
+
+	const std::vector<uint8_t> chunk(chunkSize, 0xAB);
+
+	const auto start = Clock::now();
+
+	std::thread producer([&ring, &chunk]()
+	{
+		for (size_t sent = 0; sent < TransferSize;)
+		{
+			const auto written = ring.write(chunk.data(), (std::min)(chunk.size(), TransferSize - sent));
+
+			if (0 == written)
+			{
+				std::this_thread::yield();
+			}
+
+			sent += written;
+		}
+	});
+
+	uint64_t checksum = 0;
+
+	for (size_t received = 0; received < TransferSize;)
+	{
+		const auto region = ring.peek();
+
+		if (region.empty())
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		checksum += region[0];
+		ring.consume(region.size());
+
+		received += region.size();
+	}
+
+	producer.join();
+
+	const auto elapsed = Clock::now() - start;
+
+	KeepAlive(checksum);
+
+	return elapsed;
+}
+
+//
+// Wait for `bytes` bytes on `ring` and consume them.
+//
+void Receive(common::ByteRingBuffer &ring, void *data, size_t bytes)
+{
+	while (0 == ring.read(data, bytes))
+	{
+		std::this_thread::yield();
+	}
+}
+
+} // anonymous namespace
+
+BENCHMARK(RingBufferThroughput)
+{
+	for (const size_t chunkSize : { size_t(64), size_t(4096) })
+	{
+		const auto elapsed = std::chrono::duration<double>(Transfer(chunkSize));
+
+		const auto name = "Producer to consumer, " + std::to_string(chunkSize) + " byte writes";
+
+		Report(name.c_str(), TransferSize / elapsed.count() / (1024 * 1024), "MiB/s");
+	}
+}
+
+BENCHMARK(RingBufferRoundTrip)
+{
+	constexpr size_t RoundTrips = 100000;
+
+	common::ByteRingBuffer request(Capacity);
+	common::ByteRingBuffer response(Capacity);
+
+	std::thread echo([&request, &response]()
+	{
+		for (size_t i = 0; i < RoundTrips; ++i)
+		{
+			uint64_t value;
+
+			Receive(request, &value, sizeof(value));
+			response.write(&value, sizeof(value));
+		}
+	});
+
+	const auto start = Clock::now();
+
+	for (uint64_t i = 0; i < RoundTrips; ++i)
+	{
+		uint64_t value = i;
+
+		request.write(&value, sizeof(value));
+		Receive(response, &value, sizeof(value));
+	}
+
+	const auto elapsed = Clock::now() - start;
+
+	echo.join();
+
+	Report("Round trip through two rings", Duration(elapsed) / RoundTrips);
+}
+
+}
@@ -0,0 +1,144 @@
+#include "pch.h"
+#include "benchmark.h"
+#include "libcommon/error.h"
+#include "libcommon/logging/rotatingfilelog.h"
+#include "libcommon/memory.h"
+#include <windows.h>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+namespace benchmarklibcommon
+{
+
+namespace
+{
+
+constexpr size_t LineCount = 500000;
+
+constexpr const char *Message = "Adapter configuration changed, re-applying firewall policy";
+
+//
+// What deployments wrote by hand: the same line format, one WriteFile per line.
+//
+class LineBufferedLog
+{
+public:
+
+	explicit LineBufferedLog(const std::wstring &path)
+		: m_file(CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+			CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr))
+	{
+		if (false == bool(m_file))
+		{
+			THROW_WINDOWS_ERROR(GetLastError(), "Create log file");
+		}
+	}
+
+	void write(const char *msg)
+	{
+		SYSTEMTIME time;
+		GetLocalTime(&time);
+
+		char line[512];
+
+		const auto length = std::snprintf(line, sizeof(line),
+			"[%04u-%02u-%02u %02u:%02u:%02u.%03u][%s] %s\r\n",
+			time.wYear, time.wMonth, time.wDay, time.wHour, time.wMinute, time.wSecond, time.wMilliseconds,
+			"Info", msg);
+
+		DWORD written;
+
+		if (FALSE == WriteFile(m_file.get(), line, static_cast<DWORD>(length), &written, nullptr))
+		{
+			THROW_WINDOWS_ERROR(GetLastError(), "Write log file");
+		}
+	}
+
+private:
+
+	common::memory::UniqueKernelHandle m_file;
+};
+
+//
+// Directory that is removed on destruction.
+//
+class TemporaryDirectory
+{
+public:
+
+	TemporaryDirectory()
+		: m_path(std::filesystem::temp_directory_path() / "benchmark-libcommon-logs")
+	{
+		std::filesystem::remove_all(m_path);
+		std::filesystem::create_directories(m_path);
+	}
+
+	~TemporaryDirectory()
+	{
+		std::error_code error;
+		std::filesystem::remove_all(m_path, error);
+	}
+
+	TemporaryDirectory(const TemporaryDirectory &) = delete;
+	TemporaryDirectory &operator=(const TemporaryDirectory &) = delete;
+
+	const std::filesystem::path &path() const
+	{
+		return m_path;
+	}
+
+private:
+
+	std::filesystem::path m_path;
+};
+
+} // anonymous namespace
+
+BENCHMARK(RotatingFileLogLines)
+{
+	{
+		TemporaryDirectory directory;
+
+		LineBufferedLog log((directory.path() / L"line-buffered.log").wstring());
+
+		const auto start = Clock::now();
+
+		for (size_t i = 0; i < LineCount; ++i)
+		{
+			log.write(Message);
+		}
+
+		const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+		Report("One WriteFile per line", LineCount / elapsed.count(), "lines/s");
+	}
+
+	{
+		TemporaryDirectory directory;
+
+		//
+		// About a dozen segments are filled, so rolling is part of the measurement.
+		//
+		common::logging::RotatingFileLog::Options options;
+		options.directory = directory.path().wstring();
+		options.baseName = L"rotating";
+
+		const auto start = Clock::now();
+
+		{
+			common::logging::RotatingFileLog log(options);
+
+			for (size_t i = 0; i < LineCount; ++i)
+			{
+				log.write(common::logging::LogLevel::Info, Message);
+			}
+		}
+
+		const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+		Report("RotatingFileLog, including close", LineCount / elapsed.count(), "lines/s");
+	}
+}
+
+}
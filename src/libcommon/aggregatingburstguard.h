@@ -0,0 +1,103 @@
+#pragma once
+
+#include "burstguard.h"
+#include <functional>
+#include <mutex>
+#include <set>
+#include <utility>
+
+namespace common
+{
+
+//
+// Debouncer that collects a payload with every trigger and delivers the payloads
+// of a burst as a single aggregate.
+//
+// Payloads are merged into `Aggregate` by the reducer. By default the aggregate is
+// a set, so repeated payloads are delivered once. A custom reducer can merge into
+// anything else, e.g. OR-ing flags into a bitmask.
+//
+// Timing, dispatch and overlap handling are those of `BurstGuard`.
+// A payload that arrives while the callback is running is delivered with the next burst.
+//
+template<typename Payload, typename Aggregate = std::set<Payload>>
+class AggregatingBurstGuard
+{
+public:
+
+	using Callback = std::function<void(Aggregate &&)>;
+	using Reducer = std::function<void(Aggregate &, Payload)>;
+
+	AggregatingBurstGuard(Callback callback, BurstGuard::Options options, Reducer reducer = DefaultReducer())
+		: m_callback(std::move(callback))
+		, m_reducer(std::move(reducer))
+		, m_aggregate{}
+		, m_payloads(0)
+		, m_guard([this]() { flush(); }, std::move(options))
+	{
+	}
+
+	AggregatingBurstGuard(const AggregatingBurstGuard &) = delete;
+	AggregatingBurstGuard &operator=(const AggregatingBurstGuard &) = delete;
+	AggregatingBurstGuard(AggregatingBurstGuard &&) = delete;
+	AggregatingBurstGuard &operator=(AggregatingBurstGuard &&) = delete;
+
+	void trigger(Payload payload)
+	{
+		{
+			std::scoped_lock<std::mutex> lock(m_mutex);
+
+			m_reducer(m_aggregate, std::move(payload));
+			++m_payloads;
+		}
+
+		//
+		// The payload is recorded before triggering, so the burst that covers
+		// this trigger also covers the payload.
+		//
+		m_guard.trigger();
+	}
+
+private:
+
+	static Reducer DefaultReducer()
+	{
+		return [](Aggregate &aggregate, Payload payload)
+		{
+			aggregate.insert(std::move(payload));
+		};
+	}
+
+	void flush()
+	{
+		Aggregate aggregate{};
+
+		{
+			std::scoped_lock<std::mutex> lock(m_mutex);
+
+			//
+			// Bursts that were merged into an earlier invocation have nothing left to deliver.
+			//
+			if (0 == m_payloads)
+			{
+				return;
+			}
+
+			std::swap(aggregate, m_aggregate);
+			m_payloads = 0;
+		}
+
+		m_callback(std::move(aggregate));
+	}
+
+	Callback m_callback;
+	Reducer m_reducer;
+
+	std::mutex m_mutex;
+	Aggregate m_aggregate;
+	size_t m_payloads;
+
+	BurstGuard m_guard;
+};
+
+}
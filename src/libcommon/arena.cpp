@@ -0,0 +1,95 @@
+#include "stdafx.h"
+#include "arena.h"
+#include <new>
+
+namespace common::memory
+{
+
+Arena::Arena(size_t chunkSize)
+	: m_chunkSize(chunkSize)
+	, m_chunks(nullptr)
+	, m_current(nullptr)
+	, m_offset(0)
+	, m_allocated(0)
+{
+}
+
+Arena::~Arena()
+{
+	while (nullptr != m_chunks)
+	{
+		auto next = m_chunks->next;
+		::operator delete(m_chunks);
+		m_chunks = next;
+	}
+}
+
+void Arena::reset()
+{
+	Chunk *largest = nullptr;
+
+	for (auto chunk = m_chunks; nullptr != chunk; chunk = chunk->next)
+	{
+		if (nullptr == largest || chunk->size > largest->size)
+		{
+			largest = chunk;
+		}
+	}
+
+	while (nullptr != m_chunks)
+	{
+		auto next = m_chunks->next;
+
+		if (m_chunks != largest)
+		{
+			::operator delete(m_chunks);
+		}
+
+		m_chunks = next;
+	}
+
+	if (nullptr != largest)
+	{
+		largest->next = nullptr;
+	}
+
+	m_chunks = largest;
+	m_current = largest;
+	m_offset = 0;
+	m_allocated = 0;
+}
+
+size_t Arena::reserved() const
+{
+	size_t total = 0;
+
+	for (auto chunk = m_chunks; nullptr != chunk; chunk = chunk->next)
+	{
+		total += chunk->size;
+	}
+
+	return total;
+}
+
+void *Arena::allocateSlow(size_t bytes, size_t alignment)
+{
+	//
+	// Chunk data starts at an address aligned for `Chunk`, so reserve enough
+	// to satisfy stricter alignment requests.
+	//
+	const auto worstCase = bytes + (alignment > alignof(Chunk) ? alignment : 0);
+	const auto size = (worstCase > m_chunkSize ? worstCase : m_chunkSize);
+
+	auto chunk = reinterpret_cast<Chunk *>(::operator new(sizeof(Chunk) + size));
+
+	chunk->next = m_chunks;
+	chunk->size = size;
+
+	m_chunks = chunk;
+	m_current = chunk;
+	m_offset = 0;
+
+	return allocate(bytes, alignment);
+}
+
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+namespace common::memory
+{
+
+//
+// Monotonic arena.
+//
+// Allocations are carved sequentially out of larger chunks and are never released
+// individually. Everything is released at once, either by calling `reset()` or by
+// destroying the arena.
+//
+// Use `ArenaResource` to back std::pmr containers with an arena, so all temporaries
+// created while serving a request can be dropped in one go.
+//
+// This class is not thread safe.
+//
+class Arena
+{
+public:
+
+	static constexpr size_t DefaultChunkSize = 64 * 1024;
+
+	Arena(size_t chunkSize = DefaultChunkSize);
+	~Arena();
+
+	Arena(const Arena &) = delete;
+	Arena &operator=(const Arena &) = delete;
+	Arena(Arena &&) = delete;
+	Arena &operator=(Arena &&) = delete;
+
+	void *allocate(size_t bytes, size_t alignment = alignof(std::max_align_t))
+	{
+		if (nullptr != m_current) [[likely]]
+		{
+			const auto base = reinterpret_cast<uintptr_t>(m_current + 1);
+			const auto start = AlignUp(base + m_offset, alignment) - base;
+
+			if (start + bytes <= m_current->size) [[likely]]
+			{
+				m_offset = start + bytes;
+				m_allocated += bytes;
+
+				return reinterpret_cast<void *>(base + start);
+			}
+		}
+
+		return allocateSlow(bytes, alignment);
+	}
+
+	//
+	// Release all allocations.
+	// The largest chunk is kept for reuse.
+	//
+	void reset();
+
+	//
+	// Number of bytes handed out since construction or the last reset.
+	//
+	size_t allocated() const
+	{
+		return m_allocated;
+	}
+
+	//
+	// Number of bytes currently reserved from the heap.
+	//
+	size_t reserved() const;
+
+private:
+
+	struct Chunk
+	{
+		Chunk *next;
+		size_t size;
+	};
+
+	static uintptr_t AlignUp(uintptr_t value, size_t alignment)
+	{
+		return (value + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+	}
+
+	void *allocateSlow(size_t bytes, size_t alignment);
+
+	size_t m_chunkSize;
+
+	// Most recently allocated chunk first.
+	Chunk *m_chunks;
+
+	Chunk *m_current;
+	size_t m_offset;
+
+	size_t m_allocated;
+};
+
+//
+// Adapter that exposes an `Arena` as a std::pmr::memory_resource.
+// Deallocation is a no-op, memory is reclaimed when the arena is reset.
+//
+class ArenaResource : public std::pmr::memory_resource
+{
+public:
+
+	ArenaResource(Arena &arena)
+		: m_arena(arena)
+	{
+	}
+
+private:
+
+	void *do_allocate(size_t bytes, size_t alignment) override
+	{
+		return m_arena.allocate(bytes, alignment);
+	}
+
+	void do_deallocate(void *, size_t, size_t) override
+	{
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+	{
+		return this == &other;
+	}
+
+	Arena &m_arena;
+};
+
+}
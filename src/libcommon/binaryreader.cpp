@@ -0,0 +1,20 @@
+#include "stdafx.h"
+#include "binaryreader.h"
+#include "error.h"
+#include <sstream>
+
+namespace common
+{
+
+//static
+void BinaryReader::ThrowOutOfBounds(size_t offset, size_t bytes, size_t size)
+{
+	std::stringstream ss;
+
+	ss << "Attempted to read " << bytes << " byte(s) at offset " << offset
+		<< " in buffer of size " << size;
+
+	THROW_ERROR(ss.str().c_str());
+}
+
+}
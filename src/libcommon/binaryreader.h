@@ -0,0 +1,166 @@
+#pragma once
+
+#include "buffer.h"
+#include "math.h"
+#include "memory.h"
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace common
+{
+
+enum class ByteOrder
+{
+	LittleEndian,
+	BigEndian
+};
+
+//
+// Sequential reader for binary blobs, e.g. those produced by `BinaryComposer`.
+//
+// Nothing is copied out of the buffer except the values being read.
+// Slices are returned as views into the original buffer, which must therefore
+// outlive both the reader and any views obtained from it.
+//
+// Reading beyond the end of the buffer throws.
+//
+class BinaryReader
+{
+public:
+
+	BinaryReader(ConstBufferView buffer)
+		: m_data(buffer.data())
+		, m_size(buffer.size())
+		, m_offset(0)
+	{
+	}
+
+	//
+	// Read a value in native representation.
+	// The source does not need to be aligned.
+	//
+	template<typename T>
+	T read()
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Type must be trivially copyable");
+
+		T value;
+		memcpy(&value, consume(sizeof(T)), sizeof(T));
+
+		return value;
+	}
+
+	//
+	// Read an integer stored with the specified byte order.
+	//
+	template<typename T, ByteOrder order>
+	T read()
+	{
+		static_assert(std::is_integral_v<T>, "Byte order can only be specified for integers");
+
+		auto value = read<T>();
+
+		constexpr auto native = (std::endian::native == std::endian::little
+			? ByteOrder::LittleEndian : ByteOrder::BigEndian);
+
+		if constexpr (sizeof(T) > 1 && order != native)
+		{
+			value = static_cast<T>(Swap(static_cast<std::make_unsigned_t<T>>(value)));
+		}
+
+		return value;
+	}
+
+	//
+	// Return a view of the next `bytes` bytes and advance past them.
+	//
+	ConstBufferView slice(size_t bytes)
+	{
+		return ConstBufferView(consume(bytes), bytes);
+	}
+
+	void skip(size_t bytes)
+	{
+		consume(bytes);
+	}
+
+	//
+	// Advance to the next offset that is a multiple of `alignment`.
+	// Offsets are relative to the start of the buffer.
+	//
+	void align(size_t alignment)
+	{
+		skip(::common::math::RoundPowerTwo(m_offset, alignment) - m_offset);
+	}
+
+	//
+	// Matches the padding inserted between parts by `BinaryComposer`.
+	//
+	void alignNative()
+	{
+		align(sizeof(size_t));
+	}
+
+	ConstBufferView remainder() const
+	{
+		return ConstBufferView(m_data + m_offset, m_size - m_offset);
+	}
+
+	size_t offset() const
+	{
+		return m_offset;
+	}
+
+	size_t remaining() const
+	{
+		return m_size - m_offset;
+	}
+
+	bool exhausted() const
+	{
+		return m_offset == m_size;
+	}
+
+private:
+
+	const uint8_t *consume(size_t bytes)
+	{
+		if (bytes > m_size - m_offset) [[unlikely]]
+		{
+			ThrowOutOfBounds(m_offset, bytes, m_size);
+		}
+
+		const auto current = m_data + m_offset;
+		m_offset += bytes;
+
+		return current;
+	}
+
+	template<typename T>
+	static T Swap(T value)
+	{
+		if constexpr (sizeof(T) == sizeof(uint16_t))
+		{
+			return static_cast<T>(::common::memory::ByteSwap(static_cast<uint16_t>(value)));
+		}
+		else if constexpr (sizeof(T) == sizeof(uint32_t))
+		{
+			return static_cast<T>(::common::memory::ByteSwap(static_cast<uint32_t>(value)));
+		}
+		else
+		{
+			static_assert(sizeof(T) == sizeof(uint64_t), "Unsupported integer size");
+			return static_cast<T>(::common::memory::ByteSwap(static_cast<uint64_t>(value)));
+		}
+	}
+
+	[[noreturn]] static void ThrowOutOfBounds(size_t offset, size_t bytes, size_t size);
+
+	const uint8_t *m_data;
+	size_t m_size;
+	size_t m_offset;
+};
+
+}
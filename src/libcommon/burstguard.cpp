@@ -1,137 +1,500 @@
 #include "stdafx.h"
 #include "burstguard.h"
-#include <process.h>
-#include <libcommon/error.h>
+#include "error.h"
+#include "memory.h"
+#include <cmath>
+#include <deque>
+#include <thread>
 
-namespace common
+namespace
 {
 
-BurstGuard::BurstGuard(Callback callback, uint32_t burstDuration, uint32_t interferenceInterval)
-	: m_callback(callback)
-	, m_burstDuration(burstDuration)
-	, m_interferenceInterval(interferenceInterval)
-	, m_timestampBurstStart(0)
-	, m_threadState(ThreadState::Sleeping)
+class Worker
 {
-	m_stateEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+public:
 
-	if (nullptr == m_stateEvent)
+	using Job = std::function<void()>;
+
+	Worker()
+		: m_state(std::make_shared<State>())
 	{
-		THROW_WINDOWS_ERROR(GetLastError(), "Create BurstGuard thread state event object");
+		m_thread = std::thread(&Worker::Run, m_state);
 	}
 
-	const auto t = _beginthreadex(nullptr, 0, BurstGuard::Thread, this, 0, nullptr);
+	~Worker()
+	{
+		{
+			std::scoped_lock<std::mutex> lock(m_state->mutex);
+
+			m_state->exiting = true;
+			m_state->wake.notify_one();
+		}
 
-	if (0 == t)
+		//
+		// The last reference may be released by a job. The thread then keeps
+		// the state alive on its own until it has drained the queue.
+		//
+		if (std::this_thread::get_id() == m_thread.get_id())
+		{
+			m_thread.detach();
+			return;
+		}
+
+		m_thread.join();
+	}
+
+	Worker(const Worker &) = delete;
+	Worker &operator=(const Worker &) = delete;
+
+	void post(Job job)
+	{
+		std::scoped_lock<std::mutex> lock(m_state->mutex);
+
+		m_state->jobs.push_back(std::move(job));
+		m_state->wake.notify_one();
+	}
+
+private:
+
+	//
+	// Shared with the thread, which must not refer to the worker itself.
+	//
+	struct State
 	{
-		CloseHandle(m_stateEvent);
-		THROW_ERROR("Failed to create BurstGuard thread");
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::deque<Job> jobs;
+		bool exiting = false;
+	};
+
+	static void Run(std::shared_ptr<State> state)
+	{
+		std::unique_lock<std::mutex> lock(state->mutex);
+
+		for (;;)
+		{
+			state->wake.wait(lock, [&state]()
+			{
+				return state->exiting || false == state->jobs.empty();
+			});
+
+			if (state->jobs.empty())
+			{
+				break;
+			}
+
+			auto job = std::move(state->jobs.front());
+			state->jobs.pop_front();
+
+			lock.unlock();
+
+			job();
+
+			//
+			// Destroy the job before locking, since it may hold the last reference to the worker.
+			//
+			job = nullptr;
+
+			lock.lock();
+		}
 	}
 
-	m_thread = reinterpret_cast<HANDLE>(t);
+	std::shared_ptr<State> m_state;
+	std::thread m_thread;
+};
+
+} // anonymous namespace
+
+namespace common
+{
+
+BurstGuard::BurstGuard(Callback callback, uint32_t burstDuration, uint32_t interferenceInterval)
+	: BurstGuard(std::move(callback), Options{ .burstDuration = burstDuration, .interferenceInterval = interferenceInterval })
+{
 }
 
-BurstGuard::~BurstGuard()
+BurstGuard::BurstGuard(Callback callback, uint32_t burstDuration, uint32_t interferenceInterval,
+	std::shared_ptr<TimerWheel> scheduler)
+	: BurstGuard(std::move(callback), Options{ .burstDuration = burstDuration,
+		.interferenceInterval = interferenceInterval, .scheduler = std::move(scheduler) })
 {
+}
+
+BurstGuard::BurstGuard(Callback callback, Options options)
+	: m_callback(std::move(callback))
+	, m_burstDuration(options.burstDuration)
+	, m_interferenceInterval(options.interferenceInterval)
+	, m_timestampBurstStart(NoBurst)
+	, m_timestampLastTrigger(NoBurst)
+	, m_burstTriggers(0)
+	, m_adaptivePolicy(options.adaptivePolicy)
+	, m_quietWindow(options.burstDuration)
+	, m_averageGap(0)
+	, m_gapSum(0)
+	, m_gapSamples(0)
+	, m_windowIncreases(0)
+	, m_windowDecreases(0)
+	, m_maximumDelayFires(0)
+	, m_executor(std::move(options.executor))
+	, m_overlapPolicy(options.overlapPolicy)
+	, m_running(0)
+	, m_pending(false)
+	, m_closing(false)
+	, m_triggers(0)
+	, m_bursts(0)
+	, m_interferences(0)
+	, m_callbacksSkipped(0)
+	, m_scheduler(options.scheduler ? std::move(options.scheduler) : std::make_shared<TimerWheel>())
+	, m_timer(*m_scheduler, [this]() { burstEnded(); })
+{
+	if (m_adaptivePolicy.has_value())
 	{
-		std::scoped_lock<std::mutex> lock(m_mutex);
+		const auto &policy = m_adaptivePolicy.value();
+
+		if (policy.minimumQuietWindow > policy.maximumQuietWindow
+			|| policy.smoothing <= 0 || policy.smoothing > 1
+			|| policy.gapMultiplier <= 0)
+		{
+			THROW_ERROR("Invalid adaptive BurstGuard policy");
+		}
 
-		m_threadState = ThreadState::Exiting;
-		SetEvent(m_stateEvent);
+		const auto initial = (std::min)((std::max)(m_burstDuration, policy.minimumQuietWindow),
+			policy.maximumQuietWindow);
+
+		m_quietWindow = initial;
+		m_averageGap = initial / policy.gapMultiplier;
 	}
+}
 
-	WaitForSingleObject(m_thread, INFINITE);
+BurstGuard::~BurstGuard()
+{
+	std::unique_lock<std::mutex> lock(m_dispatchMutex);
 
-	CloseHandle(m_thread);
-	CloseHandle(m_stateEvent);
+	m_closing = true;
+	m_pending = false;
+
+	m_dispatchIdle.wait(lock, [this]()
+	{
+		return 0 == m_running;
+	});
+}
+
+//static
+BurstGuard::Executor BurstGuard::DedicatedWorker()
+{
+	return [worker = std::make_shared<Worker>()](Callback job)
+	{
+		worker->post(std::move(job));
+	};
 }
 
 void BurstGuard::trigger()
 {
+	const auto timestampNow = timestamp();
+
+	//
+	// The timestamp must be published before the burst state is inspected.
+	// Either the timer handler observes it, or this thread observes the burst as ended.
+	//
+	const auto timestampPrevious = m_timestampLastTrigger.exchange(timestampNow);
+
+	m_triggers.fetch_add(1, std::memory_order_relaxed);
+	m_burstTriggers.fetch_add(1, std::memory_order_relaxed);
+
+	if (m_adaptivePolicy.has_value()
+		&& NoBurst != timestampPrevious
+		&& timestampNow >= timestampPrevious
+		&& timestampNow - timestampPrevious < m_adaptivePolicy->maximumQuietWindow)
+	{
+		m_gapSum.fetch_add(timestampNow - timestampPrevious, std::memory_order_relaxed);
+		m_gapSamples.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	//
+	// Another producer may have opened the burst with a later timestamp after this one was read.
+	// Such a trigger belongs to the burst, it must not be mistaken for interference.
+	//
+	const auto insideInterferenceInterval = [this, timestampNow](uint64_t burstStart)
+	{
+		return timestampNow < burstStart
+			|| timestampNow - burstStart < m_interferenceInterval;
+	};
+
+	auto burstStart = m_timestampBurstStart.load();
+
+	if (NoBurst != burstStart
+		&& (0 == m_interferenceInterval || insideInterferenceInterval(burstStart)))
+	{
+		return;
+	}
+
 	std::scoped_lock<std::mutex> lock(m_mutex);
 
-	const uint64_t timestampNow = static_cast<uint64_t>(GetTickCount64());
+	burstStart = m_timestampBurstStart.load();
 
-	if (0 == m_timestampBurstStart)
+	if (NoBurst == burstStart)
 	{
-		m_timestampBurstStart = timestampNow;
+		m_timestampBurstStart.store(timestampNow);
+
+		auto delay = m_quietWindow.load(std::memory_order_relaxed);
+
+		if (m_adaptivePolicy.has_value() && 0 != m_adaptivePolicy->maximumDelay)
+		{
+			delay = (std::min)(delay, m_adaptivePolicy->maximumDelay);
+		}
+
+		m_timer.arm(TimerWheel::Duration(delay));
+
+		return;
 	}
-	else if (0 != m_interferenceInterval
-		&& timestampNow - m_timestampBurstStart >= m_interferenceInterval)
+
+	if (0 != m_interferenceInterval
+		&& false == insideInterferenceInterval(burstStart))
 	{
-		m_callback();
-		m_timestampBurstStart = 0;
+		m_timestampBurstStart.store(NoBurst);
+		recordBurstEnd(true);
 
-		m_threadState = ThreadState::Sleeping;
-		SetEvent(m_stateEvent);
+		m_timer.cancel();
 
+		fire();
+	}
+}
+
+uint64_t BurstGuard::timestamp() const
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(m_scheduler->now()).count());
+}
+
+void BurstGuard::burstEnded()
+{
+	std::scoped_lock<std::mutex> lock(m_mutex);
+
+	const auto timestampBurstStart = m_timestampBurstStart.load();
+
+	if (NoBurst == timestampBurstStart)
+	{
 		return;
 	}
 
+	if (m_adaptivePolicy.has_value())
+	{
+		adapt(false);
+	}
+
+	const auto timestampNow = timestamp();
+	const auto timestampLastTrigger = m_timestampLastTrigger.load();
+
+	const auto quiet = (timestampNow > timestampLastTrigger ? timestampNow - timestampLastTrigger : 0);
+	const auto quietWindow = m_quietWindow.load(std::memory_order_relaxed);
+
+	const uint64_t maximumDelay = (m_adaptivePolicy.has_value() ? m_adaptivePolicy->maximumDelay : 0);
+	const auto elapsed = timestampNow - timestampBurstStart;
+
+	if (0 != maximumDelay && elapsed >= maximumDelay)
+	{
+		m_maximumDelayFires.fetch_add(1, std::memory_order_relaxed);
+	}
+	else if (quiet < quietWindow)
+	{
+		//
+		// Triggers that arrived after the timer was armed extend the burst.
+		//
+		auto remaining = quietWindow - quiet;
+
+		if (0 != maximumDelay)
+		{
+			remaining = (std::min)(remaining, maximumDelay - elapsed);
+		}
+
+		m_timer.arm(TimerWheel::Duration(remaining));
+
+		return;
+	}
+
+	const auto triggers = m_burstTriggers.load(std::memory_order_relaxed);
+
+	if (m_adaptivePolicy.has_value() && triggers <= 1)
+	{
+		adapt(true);
+	}
+
+	recordBurstEnd(false);
+
 	//
-	// Reset timer.
+	// Triggers racing with this are covered by the callback below,
+	// or will observe the burst as ended and start a new one.
 	//
+	m_timestampBurstStart.store(NoBurst);
 
-	m_threadState = ThreadState::WaitingBurstEnd;
-	SetEvent(m_stateEvent);
+	fire();
 }
 
-//static
-unsigned __stdcall BurstGuard::Thread(void *context)
+void BurstGuard::adapt(bool isolatedBurst)
 {
-	reinterpret_cast<BurstGuard *>(context)->thread();
-	return 0;
+	const auto smoothing = m_adaptivePolicy->smoothing;
+
+	if (isolatedBurst)
+	{
+		m_averageGap.store(m_averageGap.load(std::memory_order_relaxed) * (1 - smoothing), std::memory_order_relaxed);
+	}
+	else
+	{
+		const auto samples = m_gapSamples.exchange(0, std::memory_order_relaxed);
+		const auto sum = m_gapSum.exchange(0, std::memory_order_relaxed);
+
+		if (0 == samples)
+		{
+			return;
+		}
+
+		const auto averageGap = m_averageGap.load(std::memory_order_relaxed);
+
+		m_averageGap.store(averageGap + smoothing * (static_cast<double>(sum) / samples - averageGap),
+			std::memory_order_relaxed);
+	}
+
+	updateQuietWindow();
 }
 
-void BurstGuard::thread()
+void BurstGuard::updateQuietWindow()
 {
-	for (;;)
+	const auto &policy = m_adaptivePolicy.value();
+
+	const auto target = static_cast<uint32_t>(std::lround(policy.gapMultiplier * m_averageGap.load(std::memory_order_relaxed)));
+	const auto quietWindow = (std::min)((std::max)(target, policy.minimumQuietWindow), policy.maximumQuietWindow);
+
+	const auto previous = m_quietWindow.exchange(quietWindow, std::memory_order_relaxed);
+
+	if (quietWindow > previous)
 	{
-		WaitForSingleObject(m_stateEvent, INFINITE);
+		m_windowIncreases.fetch_add(1, std::memory_order_relaxed);
+	}
+	else if (quietWindow < previous)
+	{
+		m_windowDecreases.fetch_add(1, std::memory_order_relaxed);
+	}
+}
 
-ack_and_process:
+BurstGuard::Statistics BurstGuard::statistics() const
+{
+	Statistics statistics;
 
-		ThreadState state;
+	statistics.triggers = m_triggers.load(std::memory_order_relaxed);
+	statistics.bursts = m_bursts.load(std::memory_order_relaxed);
+	statistics.interferences = m_interferences.load(std::memory_order_relaxed);
+	statistics.callbacksSkipped = m_callbacksSkipped.load(std::memory_order_relaxed);
+	statistics.triggersPerBurst = m_triggersPerBurst.snapshot();
+	statistics.callbackDuration = m_callbackDuration.snapshot();
 
-		{
-			std::scoped_lock<std::mutex> lock(m_mutex);
+	return statistics;
+}
 
-			ResetEvent(m_stateEvent);
-			state = m_threadState;
-		}
+void BurstGuard::recordBurstEnd(bool interference)
+{
+	(interference ? m_interferences : m_bursts).fetch_add(1, std::memory_order_relaxed);
+
+	m_triggersPerBurst.record(m_burstTriggers.exchange(0, std::memory_order_relaxed));
+}
+
+void BurstGuard::invokeCallback()
+{
+	const auto start = m_scheduler->now();
 
-		if (ThreadState::Sleeping == state)
+	m_callback();
+
+	const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(m_scheduler->now() - start);
+
+	m_callbackDuration.record(static_cast<uint64_t>(duration.count()));
+}
+
+BurstGuard::AdaptiveCounters BurstGuard::adaptiveCounters() const
+{
+	AdaptiveCounters counters;
+
+	counters.quietWindow = m_quietWindow.load(std::memory_order_relaxed);
+	counters.averageGap = static_cast<uint32_t>(std::lround(m_averageGap.load(std::memory_order_relaxed)));
+	counters.windowIncreases = m_windowIncreases.load(std::memory_order_relaxed);
+	counters.windowDecreases = m_windowDecreases.load(std::memory_order_relaxed);
+	counters.maximumDelayFires = m_maximumDelayFires.load(std::memory_order_relaxed);
+
+	return counters;
+}
+
+void BurstGuard::fire()
+{
+	if (!m_executor)
+	{
+		invokeCallback();
+		return;
+	}
+
+	dispatch();
+}
+
+void BurstGuard::dispatch()
+{
+	{
+		std::scoped_lock<std::mutex> lock(m_dispatchMutex);
+
+		if (m_closing)
 		{
-			continue;
+			return;
 		}
 
-		if (ThreadState::Exiting == state)
+		if (0 != m_running && OverlapPolicy::Concurrent != m_overlapPolicy)
 		{
-			break;
+			if (OverlapPolicy::Skip == m_overlapPolicy || m_pending)
+			{
+				m_callbacksSkipped.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			m_pending = (OverlapPolicy::QueueOne == m_overlapPolicy);
+			return;
 		}
 
-		//
-		// Wait for burst to end.
-		//
+		++m_running;
+	}
 
-		if (WAIT_TIMEOUT != WaitForSingleObject(m_stateEvent, m_burstDuration))
-		{
-			goto ack_and_process;
-		}
+	//
+	// If the executor throws, the job was not accepted and won't account for itself.
+	//
+	common::memory::ScopeGuard rejected([this]()
+	{
+		std::scoped_lock<std::mutex> lock(m_dispatchMutex);
+
+		--m_running;
+		m_dispatchIdle.notify_all();
+	});
+
+	m_executor([this]()
+	{
+		run();
+	});
+
+	rejected.dismiss();
+}
+
+void BurstGuard::run()
+{
+	for (;;)
+	{
+		invokeCallback();
+
+		std::scoped_lock<std::mutex> lock(m_dispatchMutex);
 
 		//
-		// Burst has ended.
+		// Queued invocations run back to back on the same job.
 		//
-
+		if (m_pending && false == m_closing)
 		{
-			std::scoped_lock<std::mutex> lock(m_mutex);
-
-			if (0 != m_timestampBurstStart)
-			{
-				m_callback();
-				m_timestampBurstStart = 0;
-			}
+			m_pending = false;
+			continue;
 		}
+
+		--m_running;
+		m_dispatchIdle.notify_all();
+
+		return;
 	}
 }
 
@@ -1,9 +1,15 @@
 #pragma once
 
-#include <windows.h>
+#include "histogram.h"
+#include "timerwheel.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
 #include <functional>
+#include <limits>
+#include <memory>
 #include <mutex>
-#include <thread>
+#include <optional>
 
 namespace common
 {
@@ -14,6 +20,138 @@ public:
 
 	using Callback = std::function<void()>;
 
+	//
+	// Runs a job, typically on another thread.
+	// Must not block on the completion of the job.
+	//
+	using Executor = std::function<void(Callback)>;
+
+	//
+	// How to handle a burst that ends while the callback for a previous burst
+	// is still running on the executor.
+	//
+	enum class OverlapPolicy
+	{
+		// Drop the new invocation.
+		Skip,
+
+		// Run once more when the current invocation completes.
+		// Further bursts are merged into that invocation.
+		QueueOne,
+
+		// Dispatch the invocation regardless.
+		Concurrent,
+	};
+
+	//
+	// Adapts the quiet window that ends a burst to the observed traffic.
+	//
+	// An exponentially weighted moving average is kept over the gaps between triggers.
+	// Gaps of `maximumQuietWindow` or longer are idle time and are not sampled.
+	// The quiet window is set to a multiple of the average gap, bounded by the
+	// configured minimum and maximum. Bursts consisting of a single trigger decay
+	// the average, so the window shrinks again when traffic is light.
+	//
+	// All values are specified in milliseconds.
+	//
+	struct AdaptivePolicy
+	{
+		uint32_t minimumQuietWindow = 0;
+		uint32_t maximumQuietWindow = 0;
+
+		//
+		// Upper bound on the time from the first trigger in a burst to the callback.
+		// If specified as 0, the delay is unbounded.
+		//
+		uint32_t maximumDelay = 0;
+
+		// Weight of new samples, in the range (0, 1].
+		double smoothing = 0.25;
+
+		// Quiet window as a multiple of the average gap.
+		double gapMultiplier = 2.0;
+	};
+
+	//
+	// Decisions made by the adaptive policy.
+	//
+	struct AdaptiveCounters
+	{
+		uint32_t quietWindow;
+		uint32_t averageGap;
+		uint64_t windowIncreases;
+		uint64_t windowDecreases;
+		uint64_t maximumDelayFires;
+	};
+
+	//
+	// Counters for sizing the burst parameters.
+	//
+	// Histogram bucket 0 counts zero values and bucket `i` counts values in [2^(i-1), 2^i).
+	//
+	struct Statistics
+	{
+		uint64_t triggers;
+
+		// Callbacks due to a burst ending, including those forced by the maximum delay.
+		uint64_t bursts;
+
+		// Callbacks due to interference.
+		uint64_t interferences;
+
+		// Invocations dropped or merged by the overlap policy.
+		uint64_t callbacksSkipped;
+
+		Log2Histogram<16>::Snapshot triggersPerBurst;
+
+		// Callback run time in microseconds.
+		Log2Histogram<24>::Snapshot callbackDuration;
+	};
+
+	struct Options
+	{
+		//
+		// Requests to trigger the callback are clumped together if occuring within this timeframe.
+		// The value is specified in milliseconds.
+		//
+		uint32_t burstDuration = 0;
+
+		//
+		// For extended periods of bursts you may want to call through to the callback even
+		// though the burst is still on-going.
+		// The value is specified in milliseconds.
+		// If specified as 0, it means interference is disabled.
+		//
+		uint32_t interferenceInterval = 0;
+
+		//
+		// Timer wheel to schedule the burst timer on.
+		// Time is read from the clock of the wheel.
+		// If not specified, the guard uses a dedicated timer thread.
+		//
+		std::shared_ptr<TimerWheel> scheduler;
+
+		//
+		// Where to run the callback.
+		//
+		// If not specified, the callback runs on the timer thread, or on the triggering
+		// thread when interfering, with the guard lock held.
+		//
+		// If specified, no lock is held while the callback runs and `trigger()`
+		// never waits for it.
+		//
+		Executor executor;
+
+		// Only applies when an executor is specified.
+		OverlapPolicy overlapPolicy = OverlapPolicy::QueueOne;
+
+		//
+		// If specified, `burstDuration` is the initial quiet window and
+		// is adjusted according to the policy.
+		//
+		std::optional<AdaptivePolicy> adaptivePolicy;
+	};
+
 	//
 	// `burstDuration`
 	// Requests to trigger the callback are clumped together if occuring within this timeframe.
@@ -25,7 +163,23 @@ public:
 	// The value is specified in milliseconds.
 	// If specified as 0, it means interference is disabled.
 	//
+	// The guard uses a dedicated timer thread.
+	//
 	BurstGuard(Callback callback, uint32_t burstDuration, uint32_t interferenceInterval = 0);
+
+	//
+	// Schedule the burst timer on a shared timer wheel rather than a dedicated thread.
+	// Callbacks of all guards on the same wheel are serialized on the wheel thread.
+	//
+	BurstGuard(Callback callback, uint32_t burstDuration, uint32_t interferenceInterval,
+		std::shared_ptr<TimerWheel> scheduler);
+
+	BurstGuard(Callback callback, Options options);
+
+	//
+	// Pending bursts are discarded.
+	// Waits for callbacks already dispatched to the executor.
+	//
 	~BurstGuard();
 
 	BurstGuard(const BurstGuard &) = delete;
@@ -33,30 +187,98 @@ public:
 	BurstGuard(BurstGuard &&) = delete;
 	BurstGuard &operator=(BurstGuard &&) = delete;
 
+	//
+	// Triggering during an ongoing burst is lock-free.
+	//
 	void trigger();
 
+	//
+	// Create an executor that runs jobs in order on a thread of its own.
+	// The thread exits once the last copy of the executor is destroyed.
+	//
+	static Executor DedicatedWorker();
+
+	AdaptiveCounters adaptiveCounters() const;
+
+	Statistics statistics() const;
+
 private:
 
+	static constexpr uint64_t NoBurst = std::numeric_limits<uint64_t>::max();
+
+	// Milliseconds according to the clock of the scheduler.
+	uint64_t timestamp() const;
+
+	void burstEnded();
+
+	// Invoked with `m_mutex` held.
+	void adapt(bool isolatedBurst);
+	void updateQuietWindow();
+
+	// Invoked with `m_mutex` held.
+	void fire();
+
+	void dispatch();
+	void run();
+
+	// Runs the callback and records its duration.
+	void invokeCallback();
+
+	void recordBurstEnd(bool interference);
+
 	Callback m_callback;
 	uint32_t m_burstDuration;
 	uint32_t m_interferenceInterval;
 
+	//
+	// Triggers within an active burst only record their timestamp.
+	// The lock is taken to start a burst, to interfere and when the timer expires.
+	//
 	std::mutex m_mutex;
-	uint64_t m_timestampBurstStart;
 
-	enum ThreadState
-	{
-		Sleeping,
-		WaitingBurstEnd,
-		Exiting,
-	};
+	// `NoBurst` when no burst is active.
+	std::atomic<uint64_t> m_timestampBurstStart;
+	std::atomic<uint64_t> m_timestampLastTrigger;
 
-	ThreadState m_threadState;
-	HANDLE m_stateEvent;
-	HANDLE m_thread;
+	std::atomic<uint64_t> m_burstTriggers;
+
+	//
+	// Adaptive window state.
+	// Gaps are sampled by `trigger()` and folded into the average by the timer handler.
+	//
+	std::optional<AdaptivePolicy> m_adaptivePolicy;
+	std::atomic<uint32_t> m_quietWindow;
+	std::atomic<double> m_averageGap;
+	std::atomic<uint64_t> m_gapSum;
+	std::atomic<uint64_t> m_gapSamples;
+	std::atomic<uint64_t> m_windowIncreases;
+	std::atomic<uint64_t> m_windowDecreases;
+	std::atomic<uint64_t> m_maximumDelayFires;
+
+	Executor m_executor;
+	OverlapPolicy m_overlapPolicy;
+
+	//
+	// State of callbacks dispatched to the executor.
+	//
+	std::mutex m_dispatchMutex;
+	std::condition_variable m_dispatchIdle;
+	size_t m_running;
+	bool m_pending;
+	bool m_closing;
+
+	//
+	// Statistics, updated with relaxed atomics.
+	//
+	std::atomic<uint64_t> m_triggers;
+	std::atomic<uint64_t> m_bursts;
+	std::atomic<uint64_t> m_interferences;
+	std::atomic<uint64_t> m_callbacksSkipped;
+	Log2Histogram<16> m_triggersPerBurst;
+	Log2Histogram<24> m_callbackDuration;
 
-	static unsigned __stdcall Thread(void *context);
-	void thread();
+	std::shared_ptr<TimerWheel> m_scheduler;
+	TimerWheel::Timer m_timer;
 };
 
 }
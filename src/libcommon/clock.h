@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <thread>
+
+namespace common
+{
+
+//
+// Monotonic time source.
+//
+// Time is measured from an arbitrary epoch and never goes backwards.
+// Implementations must be safe to call from any thread.
+//
+class IClock
+{
+public:
+
+	using Duration = std::chrono::nanoseconds;
+
+	virtual ~IClock() = default;
+
+	virtual Duration now() const = 0;
+
+	//
+	// Block the calling thread until `now()` has reached `deadline`.
+	//
+	virtual void sleepUntil(Duration deadline) const = 0;
+};
+
+class SteadyClock : public IClock
+{
+public:
+
+	Duration now() const override
+	{
+		return std::chrono::duration_cast<Duration>(std::chrono::steady_clock::now().time_since_epoch());
+	}
+
+	void sleepUntil(Duration deadline) const override
+	{
+		std::this_thread::sleep_until(std::chrono::steady_clock::time_point(
+			std::chrono::duration_cast<std::chrono::steady_clock::duration>(deadline)));
+	}
+};
+
+}
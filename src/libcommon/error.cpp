@@ -1,6 +1,9 @@
 #include "stdafx.h"
 #include "error.h"
+#include "errormessagecache.h"
 #include "string.h"
+#include "memory.h"
+#include <atomic>
 #include <exception>
 #include <ios>
 #include <iomanip>
@@ -8,18 +11,15 @@
 
 namespace common::error {
 
-WindowsException::WindowsException(const char *message, uint32_t errorCode)
-	: std::runtime_error(message)
-	, m_errorCode(errorCode)
+namespace
 {
-}
 
-std::string FormatWindowsError(DWORD errorCode)
+std::string FormatSystemError(uint32_t errorCode)
 {
-	LPSTR buffer;
+	common::memory::UniqueLocalMemory<LPSTR> buffer;
 
 	auto status = FormatMessageA(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
-		nullptr, errorCode, 0, (LPSTR)&buffer, 0, nullptr);
+		nullptr, errorCode, 0, reinterpret_cast<LPSTR>(buffer.receive()), 0, nullptr);
 
 	if (0 == status)
 	{
@@ -30,10 +30,80 @@ std::string FormatWindowsError(DWORD errorCode)
 		return ss.str();
 	}
 
-	auto result = common::string::TrimRight(std::string(buffer));
-	LocalFree(buffer);
+	return common::string::TrimRight(std::string(buffer.get()));
+}
+
+ErrorMessageCache &SystemErrorMessages()
+{
+	static ErrorMessageCache cache(FormatSystemError);
+
+	return cache;
+}
+
+std::atomic<bool> CaptureStackTraces(false);
+
+} // anonymous namespace
+
+WindowsException::WindowsException(const char *message, uint32_t errorCode)
+	: std::runtime_error(message)
+	, m_errorCode(errorCode)
+{
+}
+
+WindowsException::WindowsException(const char *operation, uint32_t errorCode, const char *file, size_t line)
+	: std::runtime_error(operation)
+	, m_errorCode(errorCode)
+	, m_lazyMessage(std::make_shared<LazyMessage>())
+{
+	m_lazyMessage->file = file;
+	m_lazyMessage->line = line;
+}
+
+const char *WindowsException::what() const noexcept
+{
+	if (!m_lazyMessage)
+	{
+		return std::runtime_error::what();
+	}
+
+	try
+	{
+		std::call_once(m_lazyMessage->formatted, [this]()
+		{
+			std::stringstream ss;
 
-	return result;
+			ss << std::runtime_error::what() << ": 0x" << std::setw(8) << std::setfill('0') << std::hex << m_errorCode
+				<< std::setw(1) << std::dec
+				<< ": " << common::error::FormatWindowsError(m_errorCode)
+				<< " (" << IsolateFilename(m_lazyMessage->file) << ": " << m_lazyMessage->line << ")";
+
+			m_lazyMessage->message = ss.str();
+		});
+	}
+	catch (...)
+	{
+		//
+		// Formatting failed, the operation is better than nothing.
+		//
+		return std::runtime_error::what();
+	}
+
+	return m_lazyMessage->message.c_str();
+}
+
+void EnableStackTraces(bool enable)
+{
+	CaptureStackTraces.store(enable, std::memory_order_relaxed);
+}
+
+bool StackTracesEnabled()
+{
+	return CaptureStackTraces.load(std::memory_order_relaxed);
+}
+
+std::string FormatWindowsError(DWORD errorCode)
+{
+	return SystemErrorMessages().message(errorCode);
 }
 
 const char *IsolateFilename(const char *filepath)
@@ -51,13 +121,7 @@ const char *IsolateFilename(const char *filepath)
 
 [[noreturn]] void Throw(const char *operation, DWORD errorCode, const char *file, size_t line)
 {
-	std::stringstream ss;
-
-	ss << operation << ": 0x" << std::setw(8) << std::setfill('0') << std::hex << errorCode
-		<< std::setw(1) << std::dec
-		<< ": " << common::error::FormatWindowsError(errorCode);
-
-	Throw<WindowsException>(ss.str().c_str(), file, line, errorCode);
+	ThrowException<WindowsException>(operation, static_cast<uint32_t>(errorCode), file, line);
 }
 
 [[noreturn]] void Throw(const std::string &operation, DWORD errorCode, const char *file, size_t line)
@@ -69,6 +133,14 @@ void UnwindException(const std::exception &err, std::shared_ptr<common::logging:
 {
 	logSink->error(err.what());
 
+	if (const auto traced = dynamic_cast<const StackTraceHolder *>(&err); nullptr != traced)
+	{
+		for (const auto &frame : traced->stackTrace().symbolize())
+		{
+			logSink->error(std::string("    at ").append(frame).c_str());
+		}
+	}
+
 	try
 	{
 		std::rethrow_if_nested(err);
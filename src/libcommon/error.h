@@ -1,9 +1,11 @@
 #pragma once
 
 #include "logging/ilogsink.h"
+#include "stacktrace.h"
 #include <stdexcept>
 #include <string>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <windows.h>
 
@@ -30,31 +32,118 @@ public:
 
 	WindowsException(const char *message, uint32_t errorCode);
 
+	//
+	// The message is formatted on the first call to `what()`, rather than on construction.
+	// Many exceptions are caught and discarded without their message being read.
+	//
+	// `file` is not copied and must have static storage duration, such as `__FILE__`.
+	//
+	WindowsException(const char *operation, uint32_t errorCode, const char *file, size_t line);
+
+	const char *what() const noexcept override;
+
 	DWORD errorCode() const { return m_errorCode; }
 
 private:
 
+	//
+	// Shared between copies of the exception, so the message is only formatted once.
+	//
+	struct LazyMessage
+	{
+		const char *file;
+		size_t line;
+		std::once_flag formatted;
+		std::string message;
+	};
+
 	uint32_t m_errorCode;
+	std::shared_ptr<LazyMessage> m_lazyMessage;
+};
+
+//
+// Base of exceptions that carry the stack trace of where they were thrown.
+//
+class StackTraceHolder
+{
+public:
+
+	const StackTrace &stackTrace() const { return m_stackTrace; }
+
+protected:
+
+	explicit StackTraceHolder(const StackTrace &stackTrace)
+		: m_stackTrace(stackTrace)
+	{
+	}
+
+	virtual ~StackTraceHolder() = default;
+
+private:
+
+	StackTrace m_stackTrace;
 };
 
+template<typename ExceptionClass>
+class TracedException : public ExceptionClass, public StackTraceHolder
+{
+public:
+
+	template<class ...ArgTs>
+	TracedException(const StackTrace &stackTrace, ArgTs... args)
+		: ExceptionClass(args...)
+		, StackTraceHolder(stackTrace)
+	{
+	}
+};
+
+//
+// Capture the stack when throwing through `Throw`, for `UnwindException` to log.
+// Disabled by default.
+//
+void EnableStackTraces(bool enable);
+bool StackTracesEnabled();
+
 std::string FormatWindowsError(DWORD errorCode);
 const char *IsolateFilename(const char *filepath);
 
+//
+// Throw, nesting the exception currently being handled, if any.
+//
 template<typename ExceptionClass, class ...ArgTs>
-[[noreturn]] void Throw(const char *message, const char *file, size_t line, ArgTs... args)
+[[noreturn]] void ThrowException(ArgTs... args)
 {
-	std::stringstream ss;
+	if (StackTracesEnabled())
+	{
+		const TracedException<ExceptionClass> exception(StackTrace::Capture(), args...);
 
-	ss << message << " (" << IsolateFilename(file) << ": " << line << ")";
+		if (std::current_exception())
+		{
+			std::throw_with_nested(exception);
+		}
 
-	const auto formattedMessage = ss.str();
+		throw exception;
+	}
 
 	if (std::current_exception())
 	{
-		std::throw_with_nested(ExceptionClass(formattedMessage.c_str(), args...));
+		std::throw_with_nested(ExceptionClass(args...));
 	}
 
-	throw ExceptionClass(formattedMessage.c_str(), args...);
+	throw ExceptionClass(args...);
+}
+
+template<typename ExceptionClass, class ...ArgTs>
+[[noreturn]] void Throw(const char *message, const char *file, size_t line, ArgTs... args)
+{
+	const auto formattedMessage = std::string(message)
+		.append(" (")
+		.append(IsolateFilename(file))
+		.append(": ")
+		.append(std::to_string(line))
+		.append(")");
+
+	ThrowException<ExceptionClass>(formattedMessage.c_str(), args...);
 }
 
 template<typename ExceptionClass, class ...ArgTs>
@@ -0,0 +1,60 @@
+#include "stdafx.h"
+#include "errormessagecache.h"
+#include <mutex>
+#include <system_error>
+#include <utility>
+
+namespace common::error
+{
+
+ErrorMessageCache::ErrorMessageCache(Formatter formatter)
+	: ErrorMessageCache(std::move(formatter), 256)
+{
+}
+
+ErrorMessageCache::ErrorMessageCache(Formatter formatter, size_t capacity)
+	: m_formatter(std::move(formatter))
+	, m_capacity(capacity)
+{
+}
+
+std::string ErrorMessageCache::message(uint32_t code)
+{
+	{
+		std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+		if (const auto cached = m_messages.find(code); m_messages.end() != cached)
+		{
+			return cached->second;
+		}
+	}
+
+	//
+	// Format without holding the lock. Should another thread get there first,
+	// its message is kept and this one is discarded.
+	//
+	auto formatted = m_formatter(code);
+
+	std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+	if (m_messages.size() >= m_capacity)
+	{
+		return formatted;
+	}
+
+	return m_messages.try_emplace(code, std::move(formatted)).first->second;
+}
+
+size_t ErrorMessageCache::size() const
+{
+	std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+	return m_messages.size();
+}
+
+std::string FormatStandardError(uint32_t code)
+{
+	return std::generic_category().message(static_cast<int>(code));
+}
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+namespace common::error
+{
+
+//
+// Formatted error messages, keyed by error code.
+//
+// The same few error codes tend to be formatted over and over, and formatting
+// is comparatively expensive. Lookups of cached codes only take a shared lock.
+//
+// The number of cached messages is bounded. Once the cache is full, messages for
+// codes not already cached are formatted on every lookup.
+//
+class ErrorMessageCache
+{
+public:
+
+	using Formatter = std::function<std::string(uint32_t code)>;
+
+	explicit ErrorMessageCache(Formatter formatter);
+	ErrorMessageCache(Formatter formatter, size_t capacity);
+
+	ErrorMessageCache(const ErrorMessageCache &) = delete;
+	ErrorMessageCache &operator=(const ErrorMessageCache &) = delete;
+	ErrorMessageCache(ErrorMessageCache &&) = delete;
+	ErrorMessageCache &operator=(ErrorMessageCache &&) = delete;
+
+	std::string message(uint32_t code);
+
+	size_t size() const;
+
+private:
+
+	Formatter m_formatter;
+	size_t m_capacity;
+
+	mutable std::shared_mutex m_mutex;
+	std::unordered_map<uint32_t, std::string> m_messages;
+};
+
+//
+// Formats `code` as a C runtime `errno` value.
+//
+// Unlike system messages, these are available on every platform.
+//
+std::string FormatStandardError(uint32_t code);
+
+}
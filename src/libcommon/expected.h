@@ -0,0 +1,122 @@
+#pragma once
+
+#include "error.h"
+#include <stdexcept>
+#include <utility>
+#include <variant>
+#include <windows.h>
+
+#define MAKE_WINDOWS_ERROR(errorCode, operation)\
+	(::common::Error{ operation, true, static_cast<DWORD>(errorCode), __FILE__, __LINE__ })
+
+#define MAKE_ERROR(message)\
+	(::common::Error{ message, false, 0, __FILE__, __LINE__ })
+
+namespace common
+{
+
+//
+// Failure reported by a non-throwing operation.
+//
+// All strings have static storage duration, so creating, copying and discarding
+// an error never allocates.
+//
+struct Error
+{
+	// Description of the failed operation, or of the failure if `system` is false.
+	const char *operation;
+
+	// Whether `code` holds a system error code.
+	bool system;
+
+	// Zero if the failure is not a system error.
+	DWORD code;
+
+	const char *file;
+	size_t line;
+};
+
+//
+// Throw the exception that the throwing variant of the operation would have thrown.
+//
+[[noreturn]] inline void ThrowError(const Error &error)
+{
+	if (error.system)
+	{
+		::common::error::Throw(error.operation, error.code, error.file, error.line);
+	}
+
+	::common::error::Throw<std::runtime_error>(error.operation, error.file, error.line);
+}
+
+//
+// Either a value or the error that prevented producing one.
+//
+// For operations where failure is an expected outcome, and unwinding on every miss
+// would dominate the cost.
+//
+template<typename T>
+class Expected
+{
+public:
+
+	Expected(T value)
+		: m_state(std::in_place_index<0>, std::move(value))
+	{
+	}
+
+	Expected(Error error)
+		: m_state(std::in_place_index<1>, error)
+	{
+	}
+
+	bool hasValue() const
+	{
+		return 0 == m_state.index();
+	}
+
+	explicit operator bool() const
+	{
+		return hasValue();
+	}
+
+	//
+	// Throws the error if there is no value.
+	//
+	T &value() &
+	{
+		throwIfError();
+		return std::get<0>(m_state);
+	}
+
+	const T &value() const &
+	{
+		throwIfError();
+		return std::get<0>(m_state);
+	}
+
+	T &&value() &&
+	{
+		throwIfError();
+		return std::get<0>(std::move(m_state));
+	}
+
+	const Error &error() const
+	{
+		return std::get<1>(m_state);
+	}
+
+private:
+
+	void throwIfError() const
+	{
+		if (false == hasValue())
+		{
+			ThrowError(error());
+		}
+	}
+
+	std::variant<T, Error> m_state;
+};
+
+}
@@ -16,27 +16,19 @@ FileEnumerator::FileEnumerator(const std::wstring &directory, const std::wstring
 {
 	const auto findspec = std::filesystem::path(directory).append(objectMask);
 
-	m_enumHandle = FindFirstFileW
+	m_enumHandle.reset(FindFirstFileW
 	(
 		std::wstring(L"\\\\?\\").append(findspec).c_str(),
 		&m_cached
-	);
+	));
 
-	if (m_enumHandle != INVALID_HANDLE_VALUE)
+	if (m_enumHandle)
 	{
 		m_exhausted = false;
 		m_haveCachedEntry = true;
 	}
 }
 
-FileEnumerator::~FileEnumerator()
-{
-	if (m_enumHandle != INVALID_HANDLE_VALUE)
-	{
-		FindClose(m_enumHandle);
-	}
-}
-
 bool FileEnumerator::next(WIN32_FIND_DATAW &found)
 {
 	if (m_exhausted)
@@ -59,7 +51,7 @@ bool FileEnumerator::next(WIN32_FIND_DATAW &found)
 		//
 	}
 
-	while (FALSE != FindNextFileW(m_enumHandle, &found))
+	while (FALSE != FindNextFileW(m_enumHandle.get(), &found))
 	{
 		if (match(found))
 		{
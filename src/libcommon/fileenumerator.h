@@ -1,5 +1,6 @@
 #pragma once
 
+#include "memory.h"
 #include <string>
 #include <memory>
 #include <vector>
@@ -114,8 +115,6 @@ public:
 	FileEnumerator(const FileEnumerator &) = delete;
 	FileEnumerator &operator=(const FileEnumerator &) = delete;
 
-	~FileEnumerator();
-
 	void addFilter(std::unique_ptr<IFileEnumeratorFilter> &&filter)
 	{
 		m_filters.emplace_back(std::move(filter));
@@ -135,7 +134,7 @@ private:
 
 	const std::wstring m_directory;
 
-	HANDLE m_enumHandle;
+	common::memory::UniqueFindHandle m_enumHandle;
 
 	WIN32_FIND_DATAW m_cached;
 
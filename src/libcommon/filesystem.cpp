@@ -2,6 +2,7 @@
 #include "filesystem.h"
 #include "string.h"
 #include "error.h"
+#include "memory.h"
 
 namespace common::fs
 {
@@ -62,21 +63,15 @@ void Mkdir(const std::wstring &path)
 
 std::wstring GetKnownFolderPath(REFKNOWNFOLDERID folderId, DWORD flags, HANDLE userToken)
 {
-	PWSTR folder = nullptr;
+	common::memory::UniqueCoTaskMemory<PWSTR> folder;
 
-	const auto status = SHGetKnownFolderPath(folderId, flags, userToken, &folder);
+	const auto status = SHGetKnownFolderPath(folderId, flags, userToken, folder.receive());
 
 	if (S_OK == status)
 	{
-		std::wstring result(folder);
-
-		CoTaskMemFree(folder);
-
-		return result;
+		return std::wstring(folder.get());
 	}
 
-	CoTaskMemFree(folder);
-
 	THROW_ERROR("Failed to retrieve \"known folder\" path");
 }
 
@@ -45,6 +45,12 @@ bool Guid::Empty(const GUID &candidate)
 
 //static
 GUID Guid::FromString(const std::wstring &guid)
+{
+	return TryFromString(guid).value();
+}
+
+//static
+Expected<GUID> Guid::TryFromString(const std::wstring &guid)
 {
 	//
 	// There are two standard ways of formatting a GUID
@@ -67,7 +73,7 @@ GUID Guid::FromString(const std::wstring &guid)
 		}
 		default:
 		{
-			THROW_ERROR("Invalid GUID format");
+			return MAKE_ERROR("Invalid GUID format");
 		}
 	}
 
@@ -79,7 +85,7 @@ GUID Guid::FromString(const std::wstring &guid)
 
 	if (RPC_S_OK != status)
 	{
-		THROW_WINDOWS_ERROR(status, "Convert formatted GUID to raw representation");
+		return MAKE_WINDOWS_ERROR(status, "Convert formatted GUID to raw representation");
 	}
 
 	return convertedGuid;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "expected.h"
 #include <string>
 #include <guiddef.h>
 
@@ -21,6 +22,7 @@ public:
 	static bool Empty(const GUID &candidate);
 
 	static GUID FromString(const std::wstring &guid);
+	static Expected<GUID> TryFromString(const std::wstring &guid);
 };
 
 }
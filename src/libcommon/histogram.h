@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace common
+{
+
+//
+// Concurrent histogram with power-of-two buckets.
+//
+// Bucket 0 counts zero values and bucket `i` counts values in [2^(i-1), 2^i).
+// Values beyond the range of the last bucket are counted in the last bucket.
+//
+// Recording is a single relaxed increment. Snapshots are not atomic as a whole,
+// which is acceptable for diagnostics.
+//
+template<size_t Buckets>
+class Log2Histogram
+{
+public:
+
+	using Snapshot = std::array<uint64_t, Buckets>;
+
+	Log2Histogram()
+	{
+		for (auto &bucket : m_buckets)
+		{
+			bucket.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	Log2Histogram(const Log2Histogram &) = delete;
+	Log2Histogram &operator=(const Log2Histogram &) = delete;
+
+	void record(uint64_t value)
+	{
+		const auto bucket = (std::min)(static_cast<size_t>(std::bit_width(value)), Buckets - 1);
+
+		m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	Snapshot snapshot() const
+	{
+		Snapshot snapshot;
+
+		for (size_t i = 0; i < Buckets; ++i)
+		{
+			snapshot[i] = m_buckets[i].load(std::memory_order_relaxed);
+		}
+
+		return snapshot;
+	}
+
+private:
+
+	std::array<std::atomic<uint64_t>, Buckets> m_buckets;
+};
+
+}
@@ -0,0 +1,342 @@
+#include "stdafx.h"
+#include "asynclogsink.h"
+#include <algorithm>
+#include <cstring>
+
+namespace common::logging
+{
+
+namespace
+{
+
+size_t RoundUpPowerTwo(size_t value)
+{
+	size_t result = 1;
+
+	while (result < value)
+	{
+		result <<= 1;
+	}
+
+	return result;
+}
+
+} // anonymous namespace
+
+AsyncLogSink::AsyncLogSink(LogTarget target)
+	: AsyncLogSink(std::move(target), Options())
+{
+}
+
+AsyncLogSink::AsyncLogSink(LogTarget target, Options options)
+	: m_target(std::move(target))
+	, m_mask(RoundUpPowerTwo((std::max)(options.capacity, size_t(2))) - 1)
+	, m_maximumMessageLength((std::max)(options.maximumMessageLength, size_t(1)))
+	, m_overflowPolicy(options.overflowPolicy)
+	, m_slots(std::make_unique<Slot[]>(m_mask + 1))
+	, m_text(std::make_unique<char[]>((m_mask + 1) * m_maximumMessageLength))
+	, m_enqueuePosition(0)
+	, m_dequeuePosition(0)
+	, m_dropped(0)
+	, m_writerSleeping(false)
+	, m_blockedProducers(0)
+	, m_completed(0)
+	, m_exiting(false)
+{
+	for (size_t i = 0; i <= m_mask; ++i)
+	{
+		m_slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	m_thread = std::thread(&AsyncLogSink::thread, this);
+}
+
+AsyncLogSink::~AsyncLogSink()
+{
+	{
+		std::scoped_lock<std::mutex> lock(m_mutex);
+
+		m_exiting = true;
+		m_writerWake.notify_one();
+	}
+
+	m_thread.join();
+}
+
+void AsyncLogSink::error(const char *msg)
+{
+	enqueue(LogLevel::Error, msg);
+}
+
+void AsyncLogSink::warning(const char *msg)
+{
+	enqueue(LogLevel::Warning, msg);
+}
+
+void AsyncLogSink::info(const char *msg)
+{
+	enqueue(LogLevel::Info, msg);
+}
+
+void AsyncLogSink::debug(const char *msg)
+{
+	enqueue(LogLevel::Debug, msg);
+}
+
+void AsyncLogSink::trace(const char *msg)
+{
+	enqueue(LogLevel::Trace, msg);
+}
+
+void AsyncLogSink::flush()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	const auto target = m_enqueuePosition.load();
+
+	m_writerWake.notify_one();
+
+	m_flushed.wait(lock, [this, target]()
+	{
+		return m_completed >= target;
+	});
+}
+
+void AsyncLogSink::enqueue(LogLevel level, const char *msg)
+{
+	const auto length = (std::min)(strlen(msg), m_maximumMessageLength - 1);
+
+	if (tryEnqueue(level, msg, length))
+	{
+		wakeWriter();
+		return;
+	}
+
+	switch (m_overflowPolicy)
+	{
+		case OverflowPolicy::Drop:
+		{
+			m_dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		case OverflowPolicy::OverwriteOldest:
+		{
+			do
+			{
+				size_t position;
+
+				if (auto slot = tryClaim(position); nullptr != slot)
+				{
+					release(slot, position);
+					m_dropped.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+			while (false == tryEnqueue(level, msg, length));
+
+			break;
+		}
+		case OverflowPolicy::Block:
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			++m_blockedProducers;
+
+			m_spaceAvailable.wait(lock, [&]()
+			{
+				return tryEnqueue(level, msg, length);
+			});
+
+			--m_blockedProducers;
+
+			break;
+		}
+	}
+
+	wakeWriter();
+}
+
+bool AsyncLogSink::tryEnqueue(LogLevel level, const char *msg, size_t length)
+{
+	auto position = m_enqueuePosition.load(std::memory_order_relaxed);
+	Slot *slot;
+
+	for (;;)
+	{
+		slot = &m_slots[position & m_mask];
+
+		const auto sequence = slot->sequence.load(std::memory_order_acquire);
+		const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+		if (0 == difference)
+		{
+			if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if (difference < 0)
+		{
+			return false;
+		}
+		else
+		{
+			position = m_enqueuePosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	slot->level = level;
+	slot->length = length;
+
+	auto destination = text(slot);
+
+	memcpy(destination, msg, length);
+	destination[length] = '\0';
+
+	slot->sequence.store(position + 1, std::memory_order_release);
+
+	return true;
+}
+
+AsyncLogSink::Slot *AsyncLogSink::tryClaim(size_t &position)
+{
+	position = m_dequeuePosition.load(std::memory_order_relaxed);
+
+	for (;;)
+	{
+		auto slot = &m_slots[position & m_mask];
+
+		const auto sequence = slot->sequence.load(std::memory_order_acquire);
+		const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+
+		if (0 == difference)
+		{
+			if (m_dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				return slot;
+			}
+		}
+		else if (difference < 0)
+		{
+			return nullptr;
+		}
+		else
+		{
+			position = m_dequeuePosition.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+void AsyncLogSink::release(Slot *slot, size_t position)
+{
+	slot->sequence.store(position + m_mask + 1, std::memory_order_release);
+}
+
+void AsyncLogSink::notifySpaceAvailable()
+{
+	//
+	// Pairs with the increment made by blocked producers before their last attempt.
+	//
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (0 != m_blockedProducers.load(std::memory_order_relaxed))
+	{
+		std::scoped_lock<std::mutex> lock(m_mutex);
+		m_spaceAvailable.notify_all();
+	}
+}
+
+void AsyncLogSink::wakeWriter()
+{
+	//
+	// Pairs with the writer announcing that it is going to sleep.
+	//
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (m_writerSleeping.load(std::memory_order_relaxed))
+	{
+		std::scoped_lock<std::mutex> lock(m_mutex);
+		m_writerWake.notify_one();
+	}
+}
+
+void AsyncLogSink::thread()
+{
+	//
+	// Messages are copied out and their slots released before delivery.
+	// A slot held during a slow delivery would otherwise stall the queue, and
+	// producers overwriting the oldest message would wait on the target.
+	//
+	auto message = std::make_unique<char[]>(m_maximumMessageLength);
+
+	for (;;)
+	{
+		//
+		// Deliver everything that is available.
+		// Blocked producers are woken each time a quarter of the queue has been freed,
+		// and once the queue is empty.
+		//
+		const auto batchSize = (std::max)((m_mask + 1) / 4, size_t(1));
+
+		size_t released = 0;
+		size_t position;
+
+		while (auto slot = tryClaim(position))
+		{
+			const auto level = slot->level;
+
+			memcpy(message.get(), text(slot), slot->length + 1);
+
+			release(slot, position);
+
+			if (batchSize == ++released)
+			{
+				notifySpaceAvailable();
+				released = 0;
+			}
+
+			if (m_target)
+			{
+				try
+				{
+					m_target(level, message.get());
+				}
+				catch (...)
+				{
+				}
+			}
+		}
+
+		if (0 != released)
+		{
+			notifySpaceAvailable();
+		}
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		m_completed = m_dequeuePosition.load();
+		m_flushed.notify_all();
+
+		const auto empty = [this]()
+		{
+			const auto position = m_dequeuePosition.load();
+			return m_slots[position & m_mask].sequence.load(std::memory_order_acquire) != position + 1;
+		};
+
+		if (m_exiting && empty())
+		{
+			break;
+		}
+
+		m_writerSleeping.store(true);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		m_writerWake.wait(lock, [this, &empty]()
+		{
+			return m_exiting || false == empty();
+		});
+
+		m_writerSleeping.store(false, std::memory_order_relaxed);
+	}
+}
+
+}
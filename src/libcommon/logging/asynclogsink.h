@@ -0,0 +1,156 @@
+#pragma once
+
+#include "ilogsink.h"
+#include "logsink.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace common::logging
+{
+
+//
+// C4324: The queue positions are deliberately padded onto separate cache lines.
+//
+#pragma warning(push)
+#pragma warning(disable: 4324)
+
+//
+// Log sink that hands messages to a background thread, which forwards them to the target.
+//
+// Messages are copied into preallocated slots of a bounded lock-free queue, so logging
+// threads never wait on the target. Messages longer than the slot size are truncated.
+//
+// Messages that are still queued when the sink is destroyed are delivered before the
+// destructor returns.
+//
+class AsyncLogSink : public ILogSink
+{
+public:
+
+	enum class OverflowPolicy
+	{
+		// Discard the new message.
+		Drop,
+
+		// Wait for the writer to make room.
+		Block,
+
+		// Discard the oldest queued message.
+		OverwriteOldest,
+	};
+
+	struct Options
+	{
+		// Number of slots, rounded up to a power of two.
+		size_t capacity = 1024;
+
+		// Including the terminating null character.
+		size_t maximumMessageLength = 512;
+
+		OverflowPolicy overflowPolicy = OverflowPolicy::Drop;
+	};
+
+	explicit AsyncLogSink(LogTarget target);
+	AsyncLogSink(LogTarget target, Options options);
+	~AsyncLogSink();
+
+	AsyncLogSink(const AsyncLogSink &) = delete;
+	AsyncLogSink &operator=(const AsyncLogSink &) = delete;
+	AsyncLogSink(AsyncLogSink &&) = delete;
+	AsyncLogSink &operator=(AsyncLogSink &&) = delete;
+
+	void error(const char *msg) override;
+	void warning(const char *msg) override;
+	void info(const char *msg) override;
+	void debug(const char *msg) override;
+	void trace(const char *msg) override;
+
+	//
+	// Wait until every message logged before the call has been delivered or discarded.
+	//
+	void flush();
+
+	//
+	// Number of messages discarded due to overflow.
+	//
+	uint64_t dropped() const
+	{
+		return m_dropped.load(std::memory_order_relaxed);
+	}
+
+private:
+
+	static constexpr size_t CacheLineSize = 64;
+
+	struct Slot
+	{
+		std::atomic<size_t> sequence;
+		LogLevel level;
+		size_t length;
+	};
+
+	void enqueue(LogLevel level, const char *msg);
+
+	bool tryEnqueue(LogLevel level, const char *msg, size_t length);
+
+	//
+	// Claim the oldest message, returns nullptr if the queue is empty.
+	// The slot must be released after use.
+	//
+	Slot *tryClaim(size_t &position);
+	void release(Slot *slot, size_t position);
+
+	//
+	// Wake producers blocked on a full queue.
+	// The writer calls this once per batch of released slots rather than per slot,
+	// so that woken producers do not preempt it for every message.
+	//
+	void notifySpaceAvailable();
+
+	char *text(const Slot *slot)
+	{
+		return m_text.get() + (slot - m_slots.get()) * m_maximumMessageLength;
+	}
+
+	void wakeWriter();
+
+	void thread();
+
+	LogTarget m_target;
+
+	size_t m_mask;
+	size_t m_maximumMessageLength;
+	OverflowPolicy m_overflowPolicy;
+
+	std::unique_ptr<Slot[]> m_slots;
+	std::unique_ptr<char[]> m_text;
+
+	alignas(CacheLineSize) std::atomic<size_t> m_enqueuePosition;
+	alignas(CacheLineSize) std::atomic<size_t> m_dequeuePosition;
+
+	alignas(CacheLineSize) std::atomic<uint64_t> m_dropped;
+
+	//
+	// Only used to put threads to sleep.
+	//
+	std::mutex m_mutex;
+	std::condition_variable m_writerWake;
+	std::condition_variable m_spaceAvailable;
+	std::condition_variable m_flushed;
+	std::atomic<bool> m_writerSleeping;
+	std::atomic<size_t> m_blockedProducers;
+
+	// Position up to which messages have been delivered or discarded.
+	size_t m_completed;
+	bool m_exiting;
+
+	std::thread m_thread;
+};
+
+#pragma warning(pop)
+
+}
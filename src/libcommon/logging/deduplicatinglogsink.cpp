@@ -0,0 +1,323 @@
+#include "stdafx.h"
+#include "deduplicatinglogsink.h"
+#include <libcommon/error.h>
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace common::logging
+{
+
+namespace
+{
+
+//
+// 64-bit FNV-1a over the level and the message.
+//
+uint64_t Hash(LogLevel level, const char *msg)
+{
+	constexpr uint64_t Prime = 0x100000001b3;
+
+	uint64_t hash = 0xcbf29ce484222325;
+
+	hash = (hash ^ static_cast<uint8_t>(level)) * Prime;
+
+	for (auto current = msg; '\0' != *current; ++current)
+	{
+		hash = (hash ^ static_cast<uint8_t>(*current)) * Prime;
+	}
+
+	return hash;
+}
+
+size_t RoundUpPowerTwo(size_t value)
+{
+	size_t result = 1;
+
+	while (result < value)
+	{
+		result <<= 1;
+	}
+
+	return result;
+}
+
+template<size_t Size>
+void CopyTruncated(char (&destination)[Size], const char *source)
+{
+	const auto length = (std::min)(strlen(source), Size - 1);
+
+	memcpy(destination, source, length);
+	destination[length] = '\0';
+}
+
+} // anonymous namespace
+
+DeduplicatingLogSink::DeduplicatingLogSink(std::shared_ptr<ILogSink> sink)
+	: DeduplicatingLogSink(std::move(sink), Options())
+{
+}
+
+DeduplicatingLogSink::DeduplicatingLogSink(std::shared_ptr<ILogSink> sink, Options options)
+	: m_sink(std::move(sink))
+	, m_scheduler(options.scheduler ? std::move(options.scheduler) : std::make_shared<TimerWheel>())
+	, m_window(options.window)
+	, m_mask(RoundUpPowerTwo((std::max)(options.tableSize, size_t(1))) - 1)
+	, m_entries(std::make_unique<Entry[]>(m_mask + 1))
+	, m_duplicatesSuppressed(0)
+	, m_rateLimited(0)
+	, m_expiryTimer(*m_scheduler, [this]() { reportExpired(); })
+{
+	if (!m_sink)
+	{
+		THROW_ERROR("Invalid log sink");
+	}
+
+	for (size_t level = 0; level < LevelCount; ++level)
+	{
+		m_rateDropped[level].store(0, std::memory_order_relaxed);
+
+		if (const auto &cap = options.rateCaps[level]; cap.has_value())
+		{
+			m_limiters[level] = std::make_unique<RateLimiter>(cap->interval, cap->burst, m_scheduler->clock());
+		}
+	}
+}
+
+DeduplicatingLogSink::~DeduplicatingLogSink()
+{
+	try
+	{
+		flush();
+	}
+	catch (...)
+	{
+	}
+}
+
+void DeduplicatingLogSink::error(const char *msg)
+{
+	forward(LogLevel::Error, msg);
+}
+
+void DeduplicatingLogSink::warning(const char *msg)
+{
+	forward(LogLevel::Warning, msg);
+}
+
+void DeduplicatingLogSink::info(const char *msg)
+{
+	forward(LogLevel::Info, msg);
+}
+
+void DeduplicatingLogSink::debug(const char *msg)
+{
+	forward(LogLevel::Debug, msg);
+}
+
+void DeduplicatingLogSink::trace(const char *msg)
+{
+	forward(LogLevel::Trace, msg);
+}
+
+void DeduplicatingLogSink::flush()
+{
+	for (size_t index = 0; index <= m_mask; ++index)
+	{
+		std::optional<Summary> summary;
+
+		{
+			std::scoped_lock<std::mutex> lock(stripe(index));
+
+			auto &entry = m_entries[index];
+
+			if (0 == entry.repeats)
+			{
+				continue;
+			}
+
+			summary.emplace();
+			summary->level = entry.level;
+			summary->repeats = entry.repeats;
+			memcpy(summary->text, entry.text, sizeof(entry.text));
+
+			//
+			// The window carries on, so further repeats are still suppressed.
+			//
+			entry.repeats = 0;
+		}
+
+		report(*summary);
+	}
+}
+
+void DeduplicatingLogSink::forward(LogLevel level, const char *msg)
+{
+	const auto hash = Hash(level, msg);
+	const auto index = static_cast<size_t>(hash) & m_mask;
+	const auto now = m_scheduler->now();
+
+	std::optional<Summary> summary;
+	uint64_t dropped = 0;
+
+	// Set when the message starts counting repeats, to the time left in its window.
+	std::optional<IClock::Duration> expiresIn;
+
+	{
+		std::scoped_lock<std::mutex> lock(stripe(index));
+
+		auto &entry = m_entries[index];
+
+		if (entry.used && entry.hash == hash && now - entry.windowStart < m_window)
+		{
+			m_duplicatesSuppressed.fetch_add(1, std::memory_order_relaxed);
+
+			if (1 != ++entry.repeats)
+			{
+				return;
+			}
+
+			expiresIn = entry.windowStart + m_window - now;
+		}
+		else
+		{
+			//
+			// Messages discarded by the rate cap are not tracked, so their repeats
+			// are not summarized either.
+			//
+			if (false == admit(level, dropped))
+			{
+				return;
+			}
+
+			//
+			// Either the window has passed or the entry belonged to another message.
+			//
+			if (entry.used && 0 != entry.repeats)
+			{
+				summary.emplace();
+				summary->level = entry.level;
+				summary->repeats = entry.repeats;
+				memcpy(summary->text, entry.text, sizeof(entry.text));
+			}
+
+			entry.used = true;
+			entry.hash = hash;
+			entry.level = level;
+			entry.windowStart = now;
+			entry.repeats = 0;
+			CopyTruncated(entry.text, msg);
+		}
+	}
+
+	if (expiresIn.has_value())
+	{
+		//
+		// An armed timer has yet to scan the table, so it will pick up this entry and
+		// schedule its report.
+		//
+		if (false == m_expiryTimer.armed())
+		{
+			m_expiryTimer.arm(std::chrono::ceil<TimerWheel::Duration>(*expiresIn));
+		}
+
+		return;
+	}
+
+	if (summary.has_value())
+	{
+		report(*summary);
+	}
+
+	if (0 != dropped)
+	{
+		const auto message = std::to_string(dropped).append(" message(s) discarded due to rate limit");
+		Forward(*m_sink, level, message.c_str());
+	}
+
+	Forward(*m_sink, level, msg);
+}
+
+bool DeduplicatingLogSink::admit(LogLevel level, uint64_t &dropped)
+{
+	const auto index = static_cast<size_t>(level);
+	const auto &limiter = m_limiters[index];
+
+	if (!limiter)
+	{
+		return true;
+	}
+
+	if (false == limiter->tryAcquire())
+	{
+		m_rateDropped[index].fetch_add(1, std::memory_order_relaxed);
+		m_rateLimited.fetch_add(1, std::memory_order_relaxed);
+
+		return false;
+	}
+
+	dropped = m_rateDropped[index].exchange(0, std::memory_order_relaxed);
+
+	return true;
+}
+
+void DeduplicatingLogSink::reportExpired()
+{
+	std::optional<IClock::Duration> nextExpiry;
+
+	for (size_t index = 0; index <= m_mask; ++index)
+	{
+		std::optional<Summary> summary;
+
+		{
+			std::scoped_lock<std::mutex> lock(stripe(index));
+
+			auto &entry = m_entries[index];
+
+			if (false == entry.used || 0 == entry.repeats)
+			{
+				continue;
+			}
+
+			const auto now = m_scheduler->now();
+
+			if (now - entry.windowStart < m_window)
+			{
+				const auto expiresIn = entry.windowStart + m_window - now;
+				nextExpiry = (nextExpiry.has_value() ? (std::min)(*nextExpiry, expiresIn) : expiresIn);
+
+				continue;
+			}
+
+			summary.emplace();
+			summary->level = entry.level;
+			summary->repeats = entry.repeats;
+			memcpy(summary->text, entry.text, sizeof(entry.text));
+
+			//
+			// The window has passed, so the next occurrence is forwarded anyway.
+			//
+			entry.used = false;
+			entry.repeats = 0;
+		}
+
+		report(*summary);
+	}
+
+	if (nextExpiry.has_value())
+	{
+		m_expiryTimer.arm(std::chrono::ceil<TimerWheel::Duration>(*nextExpiry));
+	}
+}
+
+void DeduplicatingLogSink::report(const Summary &summary)
+{
+	const auto message = std::string("Message repeated ")
+		.append(std::to_string(summary.repeats))
+		.append(" time(s): ")
+		.append(summary.text);
+
+	Forward(*m_sink, summary.level, message.c_str());
+}
+
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "ilogsink.h"
+#include "../ratelimiter.h"
+#include "../timerwheel.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+namespace common::logging
+{
+
+//
+// Log sink decorator that suppresses repeated messages and caps the message rate per level.
+//
+// A message that was already forwarded within the last `window` is counted rather than
+// forwarded. The count is reported as a single summary message once the window has
+// passed, when its table entry is reused for a different message, on `flush()` and
+// on destruction.
+//
+// Seen messages are tracked by hash in a fixed-size table, so memory use is bounded.
+// Each entry is guarded by one of a small number of striped locks, which are only held
+// for the table update. The wrapped sink is never invoked with a lock held.
+//
+// Messages exceeding the rate cap of their level are discarded without being tracked.
+// The number discarded is reported ahead of the next message that is admitted at that
+// level.
+//
+class DeduplicatingLogSink : public ILogSink
+{
+public:
+
+	struct RateCap
+	{
+		// One message is admitted per interval, with bursts of up to `burst` messages.
+		RateLimiter::Duration interval;
+		uint32_t burst;
+	};
+
+	static constexpr size_t LevelCount = 5;
+
+	struct Options
+	{
+		std::chrono::milliseconds window = std::chrono::milliseconds(10000);
+
+		// Number of table entries, rounded up to a power of two.
+		size_t tableSize = 256;
+
+		// Indexed by `LogLevel`. Levels without a cap are not rate limited.
+		std::array<std::optional<RateCap>, LevelCount> rateCaps;
+
+		//
+		// Timer wheel to schedule the report of expired repeat counts on.
+		// Time is read from the clock of the wheel.
+		// If not specified, a dedicated timer thread is used.
+		//
+		std::shared_ptr<TimerWheel> scheduler;
+	};
+
+	explicit DeduplicatingLogSink(std::shared_ptr<ILogSink> sink);
+	DeduplicatingLogSink(std::shared_ptr<ILogSink> sink, Options options);
+
+	//
+	// Reports outstanding repeat counts.
+	//
+	~DeduplicatingLogSink();
+
+	DeduplicatingLogSink(const DeduplicatingLogSink &) = delete;
+	DeduplicatingLogSink &operator=(const DeduplicatingLogSink &) = delete;
+	DeduplicatingLogSink(DeduplicatingLogSink &&) = delete;
+	DeduplicatingLogSink &operator=(DeduplicatingLogSink &&) = delete;
+
+	bool enabled(LogLevel level) const override
+	{
+		return m_sink->enabled(level);
+	}
+
+	void error(const char *msg) override;
+	void warning(const char *msg) override;
+	void info(const char *msg) override;
+	void debug(const char *msg) override;
+	void trace(const char *msg) override;
+
+	//
+	// Report outstanding repeat counts now.
+	//
+	void flush();
+
+	uint64_t duplicatesSuppressed() const
+	{
+		return m_duplicatesSuppressed.load(std::memory_order_relaxed);
+	}
+
+	uint64_t rateLimited() const
+	{
+		return m_rateLimited.load(std::memory_order_relaxed);
+	}
+
+private:
+
+	static constexpr size_t LockStripes = 16;
+
+	// Leading part of the message kept for the summary.
+	static constexpr size_t SummaryTextLength = 128;
+
+	struct Entry
+	{
+		bool used;
+		uint64_t hash;
+		LogLevel level;
+		IClock::Duration windowStart;
+		uint64_t repeats;
+		char text[SummaryTextLength];
+	};
+
+	struct Summary
+	{
+		LogLevel level;
+		uint64_t repeats;
+		char text[SummaryTextLength];
+	};
+
+	std::mutex &stripe(size_t index)
+	{
+		return m_stripes[index % LockStripes];
+	}
+
+	void forward(LogLevel level, const char *msg);
+
+	// Apply the rate cap, returns whether the message may be forwarded.
+	// `dropped` receives the number of messages discarded since the last admitted one.
+	bool admit(LogLevel level, uint64_t &dropped);
+
+	// Report the repeat counts of entries whose window has passed.
+	void reportExpired();
+
+	void report(const Summary &summary);
+
+	std::shared_ptr<ILogSink> m_sink;
+	std::shared_ptr<TimerWheel> m_scheduler;
+	IClock::Duration m_window;
+
+	size_t m_mask;
+	std::unique_ptr<Entry[]> m_entries;
+	std::mutex m_stripes[LockStripes];
+
+	std::array<std::unique_ptr<RateLimiter>, LevelCount> m_limiters;
+	std::array<std::atomic<uint64_t>, LevelCount> m_rateDropped;
+
+	std::atomic<uint64_t> m_duplicatesSuppressed;
+	std::atomic<uint64_t> m_rateLimited;
+
+	// Armed while there are repeat counts waiting for their window to pass.
+	TimerWheel::Timer m_expiryTimer;
+};
+
+}
@@ -0,0 +1,458 @@
+#include "stdafx.h"
+#include "deferredlogger.h"
+#include <libcommon/binaryreader.h>
+#include <libcommon/error.h>
+#include <libcommon/math.h>
+#include <libcommon/string.h>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+
+namespace common::logging
+{
+
+namespace
+{
+
+//
+// Records are stored in the ring in frames:
+//
+// uint32_t frameSize
+// uint32_t recordSize, or `PaddingFrame`
+// uint8_t record[recordSize]
+//
+// Frames are padded to a multiple of `FrameAlignment`. A padding frame fills out
+// the end of the ring when the next frame does not fit before the wrap point.
+//
+
+constexpr size_t FrameHeaderSize = 2 * sizeof(uint32_t);
+constexpr size_t FrameAlignment = 8;
+constexpr uint32_t PaddingFrame = 0xFFFFFFFF;
+
+void WriteFrameHeader(uint8_t *frame, size_t frameSize, uint32_t recordSize)
+{
+	const uint32_t header[] = { static_cast<uint32_t>(frameSize), recordSize };
+	memcpy(frame, header, sizeof(header));
+}
+
+void AppendInteger(std::string &output, auto value)
+{
+	char buffer[32];
+
+	const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+
+	output.append(buffer, result.ptr);
+}
+
+void AppendArgument(std::string &output, BinaryReader &reader)
+{
+	using deferred::ArgumentType;
+
+	switch (reader.read<ArgumentType>())
+	{
+		case ArgumentType::Signed:
+		{
+			AppendInteger(output, reader.read<int64_t>());
+			break;
+		}
+		case ArgumentType::Unsigned:
+		{
+			AppendInteger(output, reader.read<uint64_t>());
+			break;
+		}
+		case ArgumentType::Boolean:
+		{
+			output.append(0 != reader.read<uint8_t>() ? "true" : "false");
+			break;
+		}
+		case ArgumentType::Guid:
+		{
+			output.append(common::string::ToAnsi(common::string::FormatGuid(reader.read<GUID>())));
+			break;
+		}
+		case ArgumentType::Ipv4:
+		{
+			output.append(common::string::ToAnsi(common::string::FormatIpv4(reader.read<uint32_t>())));
+			break;
+		}
+		case ArgumentType::Ipv6:
+		{
+			const auto address = reader.slice(16);
+			output.append(common::string::ToAnsi(common::string::FormatIpv6(address.data())));
+			break;
+		}
+		case ArgumentType::String:
+		{
+			const auto length = reader.read<uint16_t>();
+			const auto text = reader.slice(length);
+
+			output.append(reinterpret_cast<const char *>(text.data()), text.size());
+			break;
+		}
+		case ArgumentType::WideString:
+		{
+			const auto length = reader.read<uint16_t>();
+			const auto text = reader.slice(length * sizeof(wchar_t));
+
+			std::wstring wide(length, L'\0');
+			memcpy(wide.data(), text.data(), text.size());
+
+			output.append(common::string::ToAnsi(wide));
+			break;
+		}
+		default:
+		{
+			THROW_ERROR("Invalid argument type in log record");
+		}
+	}
+}
+
+std::string Format(const char *format, BinaryReader &reader)
+{
+	std::string output;
+
+	for (auto current = format; '\0' != *current; ++current)
+	{
+		if ('{' == current[0] && '{' == current[1])
+		{
+			output.push_back('{');
+			++current;
+		}
+		else if ('}' == current[0] && '}' == current[1])
+		{
+			output.push_back('}');
+			++current;
+		}
+		else if ('{' == current[0] && '}' == current[1])
+		{
+			if (reader.exhausted())
+			{
+				output.append("{?}");
+			}
+			else
+			{
+				AppendArgument(output, reader);
+			}
+
+			++current;
+		}
+		else
+		{
+			output.push_back(*current);
+		}
+	}
+
+	return output;
+}
+
+std::atomic<uint64_t> NextLoggerId(0);
+
+} // anonymous namespace
+
+DecodedRecord DecodeRecord(ConstBufferView record)
+{
+	return DecodeRecord(record, [](uint64_t id)
+	{
+		return reinterpret_cast<const LogFormat *>(static_cast<uintptr_t>(id));
+	});
+}
+
+DecodedRecord DecodeRecord(ConstBufferView record, const LogFormatResolver &resolver)
+{
+	BinaryReader reader(record);
+
+	const auto id = reader.read<uint64_t>();
+	const auto format = resolver(id);
+
+	if (nullptr == format)
+	{
+		std::stringstream ss;
+
+		ss << "Unknown log format descriptor: 0x" << std::hex << id;
+
+		THROW_ERROR(ss.str().c_str());
+	}
+
+	return DecodedRecord{ format->level, Format(format->format, reader) };
+}
+
+DeferredLogger::DeferredLogger(std::shared_ptr<ILogSink> sink, size_t capacity)
+	: m_sink(std::move(sink))
+	, m_capacity((std::max)(capacity, size_t(64)))
+	, m_id(NextLoggerId.fetch_add(1, std::memory_order_relaxed))
+	, m_producersVersion(0)
+	, m_dropped(0)
+	, m_consumerSleeping(false)
+	, m_exiting(false)
+{
+	if (!m_sink)
+	{
+		THROW_ERROR("Invalid log sink");
+	}
+
+	m_thread = std::thread(&DeferredLogger::thread, this);
+}
+
+DeferredLogger::~DeferredLogger()
+{
+	{
+		std::scoped_lock<std::mutex> lock(m_mutex);
+
+		m_exiting = true;
+		m_consumerWake.notify_one();
+	}
+
+	m_thread.join();
+}
+
+void DeferredLogger::flush()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	//
+	// Hold on to the producers, the consumer releases abandoned ones as it drains them.
+	//
+	std::vector<std::pair<std::shared_ptr<Producer>, uint64_t> > targets;
+
+	for (const auto &producer : m_producers)
+	{
+		targets.emplace_back(producer, producer->written.load());
+	}
+
+	m_flushed.wait(lock, [&targets]()
+	{
+		return std::all_of(targets.begin(), targets.end(), [](const auto &target)
+		{
+			return target.first->completed >= target.second;
+		});
+	});
+}
+
+DeferredLogger::Producer &DeferredLogger::threadProducer()
+{
+	//
+	// Rings of the calling thread, by logger.
+	//
+	struct ThreadProducers
+	{
+		~ThreadProducers()
+		{
+			for (const auto &entry : entries)
+			{
+				entry.second->abandoned.store(true, std::memory_order_release);
+			}
+		}
+
+		std::vector<std::pair<uint64_t, std::shared_ptr<Producer> > > entries;
+	};
+
+	static thread_local ThreadProducers producers;
+
+	for (const auto &entry : producers.entries)
+	{
+		if (m_id == entry.first)
+		{
+			return *entry.second;
+		}
+	}
+
+	//
+	// Forget rings of loggers that have been destroyed.
+	//
+	std::erase_if(producers.entries, [](const auto &entry)
+	{
+		return 1 == entry.second.use_count();
+	});
+
+	auto producer = std::make_shared<Producer>(m_capacity);
+
+	{
+		std::scoped_lock<std::mutex> lock(m_mutex);
+
+		m_producers.push_back(producer);
+		++m_producersVersion;
+	}
+
+	producers.entries.emplace_back(m_id, producer);
+
+	return *producer;
+}
+
+uint8_t *DeferredLogger::reserve(Producer &producer, size_t recordSize)
+{
+	const auto frameSize = common::math::RoundPowerTwo(FrameHeaderSize + recordSize, FrameAlignment);
+
+	auto &ring = producer.ring;
+
+	if (frameSize > ring.capacity())
+	{
+		m_dropped.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	auto region = ring.reserve(frameSize);
+
+	if (false == region.empty() && region.size() < frameSize && ring.endsAtWrapPoint(region))
+	{
+		//
+		// The free space is split by the wrap point. Anywhere else, a short region
+		// means the ring is nearly full and padding would only waste the space.
+		//
+		WriteFrameHeader(region.data(), region.size(), PaddingFrame);
+		ring.commit(region.size());
+
+		region = ring.reserve(frameSize);
+	}
+
+	if (region.size() < frameSize)
+	{
+		m_dropped.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	WriteFrameHeader(region.data(), frameSize, static_cast<uint32_t>(recordSize));
+	producer.frameSize = frameSize;
+
+	return region.data() + FrameHeaderSize;
+}
+
+void DeferredLogger::commit(Producer &producer)
+{
+	producer.ring.commit(producer.frameSize);
+	producer.written.fetch_add(1, std::memory_order_release);
+
+	wakeConsumer();
+}
+
+void DeferredLogger::wakeConsumer()
+{
+	//
+	// Pairs with the consumer announcing that it is going to sleep.
+	//
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (m_consumerSleeping.load(std::memory_order_relaxed))
+	{
+		std::scoped_lock<std::mutex> lock(m_mutex);
+		m_consumerWake.notify_one();
+	}
+}
+
+void DeferredLogger::thread()
+{
+	std::vector<std::shared_ptr<Producer> > producers;
+	std::vector<uint64_t> delivered;
+
+	uint64_t producersVersion = 0;
+
+	for (;;)
+	{
+		bool found = false;
+
+		for (size_t index = 0; index < producers.size(); ++index)
+		{
+			auto &ring = producers[index]->ring;
+
+			//
+			// Frames are published whole, so the region holds complete frames only.
+			//
+			const auto region = ring.peek();
+
+			if (region.empty())
+			{
+				continue;
+			}
+
+			found = true;
+
+			BinaryReader frames(ConstBufferView(region.data(), region.size()));
+
+			while (false == frames.exhausted())
+			{
+				const auto frameSize = frames.read<uint32_t>();
+				const auto recordSize = frames.read<uint32_t>();
+
+				const auto frame = frames.slice(frameSize - FrameHeaderSize);
+
+				if (PaddingFrame == recordSize)
+				{
+					continue;
+				}
+
+				++delivered[index];
+
+				try
+				{
+					const auto record = DecodeRecord(ConstBufferView(frame.data(), recordSize));
+					Forward(*m_sink, record.level, record.message.c_str());
+				}
+				catch (...)
+				{
+				}
+			}
+
+			ring.consume(region.size());
+		}
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		for (size_t index = 0; index < producers.size(); ++index)
+		{
+			producers[index]->completed += delivered[index];
+		}
+
+		m_flushed.notify_all();
+
+		//
+		// Release rings of exited threads once everything they wrote has been delivered.
+		//
+		const auto drained = std::erase_if(m_producers, [](const auto &producer)
+		{
+			return producer->abandoned.load(std::memory_order_acquire)
+				&& producer->completed == producer->written.load(std::memory_order_acquire);
+		});
+
+		if (0 != drained)
+		{
+			++m_producersVersion;
+		}
+
+		if (producersVersion != m_producersVersion)
+		{
+			producers = m_producers;
+			producersVersion = m_producersVersion;
+		}
+
+		delivered.assign(producers.size(), 0);
+
+		if (found)
+		{
+			continue;
+		}
+
+		const auto empty = [this]()
+		{
+			return std::all_of(m_producers.begin(), m_producers.end(), [](const auto &producer)
+			{
+				return producer->ring.peek().empty();
+			});
+		};
+
+		if (m_exiting && empty())
+		{
+			break;
+		}
+
+		m_consumerSleeping.store(true);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		m_consumerWake.wait(lock, [this, &empty]()
+		{
+			return m_exiting || false == empty();
+		});
+
+		m_consumerSleeping.store(false, std::memory_order_relaxed);
+	}
+}
+
+}
@@ -0,0 +1,435 @@
+#pragma once
+
+#include "ilogsink.h"
+#include "../buffer.h"
+#include "../ringbuffer.h"
+#include <guiddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace common::logging
+{
+
+//
+// Describes a deferred log statement.
+//
+// Records refer to the descriptor by address, so instances must have static storage
+// duration. `LOG_DEFERRED` takes care of this.
+//
+// Placeholders are written as `{}` and are replaced by the arguments in order.
+// Use `{{` and `}}` for literal braces.
+//
+struct LogFormat
+{
+	LogLevel level;
+	const char *format;
+};
+
+// IPv4 address in host byte order.
+struct Ipv4Argument
+{
+	uint32_t address;
+};
+
+// IPv6 address, the 16 bytes are copied into the record.
+struct Ipv6Argument
+{
+	const uint8_t *address;
+};
+
+struct DecodedRecord
+{
+	LogLevel level;
+	std::string message;
+};
+
+//
+// Maps the descriptor identifier stored in a record back to the descriptor.
+// Returns nullptr if the identifier is unknown.
+//
+using LogFormatResolver = std::function<const LogFormat *(uint64_t id)>;
+
+namespace deferred
+{
+
+enum class ArgumentType : uint8_t
+{
+	Signed,
+	Unsigned,
+	Boolean,
+	Guid,
+	Ipv4,
+	Ipv6,
+	String,
+	WideString
+};
+
+// Longer strings are truncated. Specified in characters.
+constexpr size_t MaximumStringLength = 1024;
+
+//
+// Arguments are normalized to one of the encodable types below.
+//
+
+inline std::string_view Normalize(const char *value)
+{
+	return (nullptr == value ? std::string_view("(null)") : std::string_view(value));
+}
+
+inline std::string_view Normalize(const std::string &value)
+{
+	return value;
+}
+
+inline std::wstring_view Normalize(const wchar_t *value)
+{
+	return (nullptr == value ? std::wstring_view(L"(null)") : std::wstring_view(value));
+}
+
+inline std::wstring_view Normalize(const std::wstring &value)
+{
+	return value;
+}
+
+template<typename T>
+const T &Normalize(const T &value)
+{
+	return value;
+}
+
+inline size_t StringLength(size_t length)
+{
+	return (length > MaximumStringLength ? MaximumStringLength : length);
+}
+
+inline size_t EncodedSize(bool)
+{
+	return 1 + sizeof(uint8_t);
+}
+
+template<typename T>
+requires std::is_integral_v<T>
+size_t EncodedSize(T)
+{
+	return 1 + sizeof(uint64_t);
+}
+
+inline size_t EncodedSize(const GUID &)
+{
+	return 1 + sizeof(GUID);
+}
+
+inline size_t EncodedSize(const Ipv4Argument &)
+{
+	return 1 + sizeof(uint32_t);
+}
+
+inline size_t EncodedSize(const Ipv6Argument &)
+{
+	return 1 + 16;
+}
+
+inline size_t EncodedSize(std::string_view value)
+{
+	return 1 + sizeof(uint16_t) + StringLength(value.size());
+}
+
+inline size_t EncodedSize(std::wstring_view value)
+{
+	return 1 + sizeof(uint16_t) + StringLength(value.size()) * sizeof(wchar_t);
+}
+
+//
+// Writes unaligned values into a buffer that is known to be large enough.
+//
+class RecordWriter
+{
+public:
+
+	RecordWriter(uint8_t *destination)
+		: m_cursor(destination)
+	{
+	}
+
+	template<typename T>
+	void write(const T &value)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Type must be trivially copyable");
+
+		memcpy(m_cursor, &value, sizeof(T));
+		m_cursor += sizeof(T);
+	}
+
+	void write(const void *data, size_t size)
+	{
+		memcpy(m_cursor, data, size);
+		m_cursor += size;
+	}
+
+	void encode(bool value)
+	{
+		write(ArgumentType::Boolean);
+		write(static_cast<uint8_t>(value));
+	}
+
+	template<typename T>
+	requires std::is_integral_v<T>
+	void encode(T value)
+	{
+		if constexpr (std::is_signed_v<T>)
+		{
+			write(ArgumentType::Signed);
+			write(static_cast<int64_t>(value));
+		}
+		else
+		{
+			write(ArgumentType::Unsigned);
+			write(static_cast<uint64_t>(value));
+		}
+	}
+
+	void encode(const GUID &value)
+	{
+		write(ArgumentType::Guid);
+		write(value);
+	}
+
+	void encode(const Ipv4Argument &value)
+	{
+		write(ArgumentType::Ipv4);
+		write(value.address);
+	}
+
+	void encode(const Ipv6Argument &value)
+	{
+		write(ArgumentType::Ipv6);
+		write(value.address, 16);
+	}
+
+	void encode(std::string_view value)
+	{
+		const auto length = StringLength(value.size());
+
+		write(ArgumentType::String);
+		write(static_cast<uint16_t>(length));
+		write(value.data(), length);
+	}
+
+	void encode(std::wstring_view value)
+	{
+		const auto length = StringLength(value.size());
+
+		write(ArgumentType::WideString);
+		write(static_cast<uint16_t>(length));
+		write(value.data(), length * sizeof(wchar_t));
+	}
+
+private:
+
+	uint8_t *m_cursor;
+};
+
+template<typename ...Args>
+size_t RecordSize(const Args &...args)
+{
+	return sizeof(uint64_t) + (size_t(0) + ... + EncodedSize(Normalize(args)));
+}
+
+template<typename ...Args>
+void EncodeRecord(uint8_t *destination, const LogFormat *format, const Args &...args)
+{
+	RecordWriter writer(destination);
+
+	writer.write(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(format)));
+	(writer.encode(Normalize(args)), ...);
+}
+
+}
+
+//
+// Encode a record into a standalone buffer, e.g. for storing it elsewhere.
+//
+template<typename ...Args>
+std::vector<uint8_t> EncodeRecord(const LogFormat *format, const Args &...args)
+{
+	std::vector<uint8_t> record(deferred::RecordSize(args...));
+	deferred::EncodeRecord(record.data(), format, args...);
+
+	return record;
+}
+
+//
+// Format a record produced in the current process.
+//
+DecodedRecord DecodeRecord(ConstBufferView record);
+
+//
+// Format a record using `resolver` to look up the descriptor.
+// Use this when decoding records that were produced by another process.
+//
+DecodedRecord DecodeRecord(ConstBufferView record, const LogFormatResolver &resolver);
+
+//
+// Structured logging front end that defers formatting to a background thread.
+//
+// Call sites store a pointer to a static descriptor and the raw argument values
+// in a byte ring. The background thread formats the records and forwards them to
+// the sink. Records that do not fit in the ring are discarded and counted.
+//
+// Each logging thread is given its own single-producer ring of `capacity` bytes the
+// first time it logs, so producers never contend with each other. Records from one
+// thread are delivered in order, records from different threads may be interleaved
+// differently from the order in which they were logged. The ring of a thread that
+// exits is released once it has been drained.
+//
+// Supported arguments are integers, booleans, GUIDs, IPv4 and IPv6 addresses
+// (see `Ipv4Argument` and `Ipv6Argument`) and narrow or wide strings.
+// Strings are copied, so the caller need not keep them alive.
+//
+// Records still queued when the logger is destroyed are delivered before
+// the destructor returns.
+//
+class DeferredLogger
+{
+public:
+
+	explicit DeferredLogger(std::shared_ptr<ILogSink> sink, size_t capacity = 64 * 1024);
+	~DeferredLogger();
+
+	DeferredLogger(const DeferredLogger &) = delete;
+	DeferredLogger &operator=(const DeferredLogger &) = delete;
+	DeferredLogger(DeferredLogger &&) = delete;
+	DeferredLogger &operator=(DeferredLogger &&) = delete;
+
+	bool enabled(LogLevel level) const
+	{
+		return m_sink->enabled(level);
+	}
+
+	template<typename ...Args>
+	void log(const LogFormat *format, const Args &...args)
+	{
+		const auto recordSize = deferred::RecordSize(args...);
+
+		auto &producer = threadProducer();
+
+		if (auto record = reserve(producer, recordSize); nullptr != record)
+		{
+			deferred::EncodeRecord(record, format, args...);
+			commit(producer);
+		}
+	}
+
+	//
+	// Wait until every record logged before the call has been delivered.
+	//
+	void flush();
+
+	//
+	// Number of records discarded because the ring was full.
+	//
+	uint64_t dropped() const
+	{
+		return m_dropped.load(std::memory_order_relaxed);
+	}
+
+private:
+
+	//
+	// Ring written by a single thread.
+	//
+	struct Producer
+	{
+		explicit Producer(size_t capacity)
+			: ring(capacity)
+			, frameSize(0)
+			, written(0)
+			, completed(0)
+			, abandoned(false)
+		{
+		}
+
+		ByteRingBuffer ring;
+
+		// Size of the frame most recently reserved.
+		size_t frameSize;
+
+		// Number of records committed.
+		std::atomic<uint64_t> written;
+
+		// Number of records delivered. Guarded by `m_mutex`.
+		uint64_t completed;
+
+		// Set when the thread exits.
+		std::atomic<bool> abandoned;
+	};
+
+	//
+	// Returns the ring of the calling thread, which is registered on first use.
+	//
+	Producer &threadProducer();
+
+	//
+	// Invoked on the thread that owns `producer`.
+	// Returns nullptr if there is no room for the record.
+	//
+	uint8_t *reserve(Producer &producer, size_t recordSize);
+	void commit(Producer &producer);
+
+	void wakeConsumer();
+
+	void thread();
+
+	std::shared_ptr<ILogSink> m_sink;
+	size_t m_capacity;
+
+	// Distinguishes this logger from earlier ones at the same address.
+	uint64_t m_id;
+
+	//
+	// Only used for registering producers, flushing and putting the consumer to sleep.
+	//
+	std::mutex m_mutex;
+	std::condition_variable m_consumerWake;
+	std::condition_variable m_flushed;
+
+	std::vector<std::shared_ptr<Producer>> m_producers;
+
+	// Incremented when `m_producers` changes.
+	uint64_t m_producersVersion;
+
+	std::atomic<uint64_t> m_dropped;
+	std::atomic<bool> m_consumerSleeping;
+	bool m_exiting;
+
+	std::thread m_thread;
+};
+
+}
+
+//
+// LOG_DEFERRED(logger, LogLevel::Debug, "Adapter {} has index {}", guid, index);
+//
+// `logger` is anything that can be dereferenced with `->` to reach a DeferredLogger.
+// Arguments are not evaluated if the level is not enabled.
+//
+#define LOG_DEFERRED(logger, level, format, ...)\
+{\
+	static constexpr ::common::logging::LogFormat libcommonLogFormat{ level, format };\
+	auto &&libcommonLogger = (logger);\
+	if (libcommonLogger->enabled(level))\
+	{\
+		libcommonLogger->log(&libcommonLogFormat, ##__VA_ARGS__);\
+	}\
+}\
+
@@ -0,0 +1,221 @@
+#include "stdafx.h"
+#include "fanoutlogsink.h"
+#include <libcommon/memory.h>
+#include <algorithm>
+
+namespace common::logging
+{
+
+using LockType = std::scoped_lock<std::mutex>;
+
+FanOutLogSink::TargetList::TargetList(std::vector<Entry> &&entries, LogLevel minimumLevel)
+	: entries(std::move(entries))
+	, minimumLevel(minimumLevel)
+	, references(0)
+{
+}
+
+FanOutLogSink::FanOutLogSink()
+	: m_targets(reinterpret_cast<uintptr_t>(new TargetList({}, LogLevel::Error)))
+	, m_nextId(1)
+{
+}
+
+FanOutLogSink::~FanOutLogSink()
+{
+	Retire(m_targets.exchange(0));
+}
+
+FanOutLogSink::TargetId FanOutLogSink::addTarget(LogTarget target, LogLevel minimumLevel)
+{
+	LockType lock(m_updateMutex);
+
+	auto entries = current().entries;
+
+	const auto id = m_nextId++;
+
+	entries.push_back(Entry{ id, minimumLevel, std::make_shared<const LogTarget>(std::move(target)) });
+
+	publish(std::move(entries));
+
+	return id;
+}
+
+bool FanOutLogSink::removeTarget(TargetId id)
+{
+	LockType lock(m_updateMutex);
+
+	auto entries = current().entries;
+
+	const auto it = std::find_if(entries.begin(), entries.end(), [id](const Entry &entry)
+	{
+		return entry.id == id;
+	});
+
+	if (entries.end() == it)
+	{
+		return false;
+	}
+
+	entries.erase(it);
+
+	publish(std::move(entries));
+
+	return true;
+}
+
+bool FanOutLogSink::setTargetLevel(TargetId id, LogLevel minimumLevel)
+{
+	LockType lock(m_updateMutex);
+
+	auto entries = current().entries;
+
+	const auto it = std::find_if(entries.begin(), entries.end(), [id](const Entry &entry)
+	{
+		return entry.id == id;
+	});
+
+	if (entries.end() == it)
+	{
+		return false;
+	}
+
+	it->minimumLevel = minimumLevel;
+
+	publish(std::move(entries));
+
+	return true;
+}
+
+bool FanOutLogSink::enabled(LogLevel level) const
+{
+	const auto targets = acquire();
+
+	const auto result = false == targets->entries.empty() && level <= targets->minimumLevel;
+
+	release(targets);
+
+	return result;
+}
+
+void FanOutLogSink::error(const char *msg)
+{
+	forward(LogLevel::Error, msg);
+}
+
+void FanOutLogSink::warning(const char *msg)
+{
+	forward(LogLevel::Warning, msg);
+}
+
+void FanOutLogSink::info(const char *msg)
+{
+	forward(LogLevel::Info, msg);
+}
+
+void FanOutLogSink::debug(const char *msg)
+{
+	forward(LogLevel::Debug, msg);
+}
+
+void FanOutLogSink::trace(const char *msg)
+{
+	forward(LogLevel::Trace, msg);
+}
+
+void FanOutLogSink::forward(LogLevel level, const char *msg)
+{
+	//
+	// The reference keeps the list, and the targets in it, alive while forwarding.
+	//
+	const auto targets = acquire();
+
+	common::memory::ScopeGuard releaseTargets([this, targets]()
+	{
+		release(targets);
+	});
+
+	for (const auto &entry : targets->entries)
+	{
+		if (level <= entry.minimumLevel)
+		{
+			(*entry.target)(level, msg);
+		}
+	}
+}
+
+void FanOutLogSink::publish(std::vector<Entry> &&entries)
+{
+	auto minimumLevel = LogLevel::Error;
+
+	for (const auto &entry : entries)
+	{
+		minimumLevel = (std::max)(minimumLevel, entry.minimumLevel);
+	}
+
+	const auto list = new TargetList(std::move(entries), minimumLevel);
+
+	Retire(m_targets.exchange(reinterpret_cast<uintptr_t>(list), std::memory_order_acq_rel));
+}
+
+const FanOutLogSink::TargetList *FanOutLogSink::acquire() const
+{
+	const auto targets = m_targets.fetch_add(uint64_t(1) << ReferenceShift, std::memory_order_acquire);
+
+	return reinterpret_cast<const TargetList *>(targets & AddressMask);
+}
+
+void FanOutLogSink::release(const TargetList *list) const
+{
+	auto targets = m_targets.load(std::memory_order_relaxed);
+
+	//
+	// While the list is still current, the reference is returned to `m_targets`.
+	// The list can't be replaced and reallocated at the same address meanwhile,
+	// since the reference keeps it alive.
+	//
+	while ((targets & AddressMask) == reinterpret_cast<uintptr_t>(list))
+	{
+		if (m_targets.compare_exchange_weak(targets, targets - (uint64_t(1) << ReferenceShift),
+			std::memory_order_release, std::memory_order_relaxed))
+		{
+			return;
+		}
+	}
+
+	//
+	// The list has been replaced, and the references acquired through `m_targets`
+	// are counted by the list itself.
+	//
+	Unreference(list, -1);
+}
+
+const FanOutLogSink::TargetList &FanOutLogSink::current() const
+{
+	//
+	// Only updaters replace the list, so it remains valid without acquiring it.
+	//
+	return *reinterpret_cast<const TargetList *>(m_targets.load(std::memory_order_acquire) & AddressMask);
+}
+
+//static
+void FanOutLogSink::Retire(uint64_t targets)
+{
+	const auto list = reinterpret_cast<const TargetList *>(targets & AddressMask);
+
+	if (nullptr != list)
+	{
+		Unreference(list, static_cast<int64_t>(targets >> ReferenceShift));
+	}
+}
+
+//static
+void FanOutLogSink::Unreference(const TargetList *list, int64_t count)
+{
+	if (0 == list->references.fetch_add(count, std::memory_order_acq_rel) + count)
+	{
+		delete list;
+	}
+}
+
+}
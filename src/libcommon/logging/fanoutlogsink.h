@@ -0,0 +1,126 @@
+#pragma once
+
+#include "ilogsink.h"
+#include "logsink.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace common::logging
+{
+
+//
+// Log sink that forwards each message to any number of targets, each with a level of its own.
+//
+// The target list is immutable once published. Changes copy the list and swap in the copy.
+// Logging threads acquire the current list with a single atomic addition and never take
+// a lock, so they don't wait for each other or for changes to the list.
+//
+// Since logging threads are not serialized, targets must be safe to invoke concurrently.
+// A thread that loaded the list before a target was removed may still invoke the target
+// after `removeTarget()` returns. The target is destroyed once no thread refers to it.
+//
+class FanOutLogSink : public ILogSink
+{
+public:
+
+	using TargetId = uint64_t;
+
+	FanOutLogSink();
+	~FanOutLogSink();
+
+	FanOutLogSink(const FanOutLogSink &) = delete;
+	FanOutLogSink &operator=(const FanOutLogSink &) = delete;
+	FanOutLogSink(FanOutLogSink &&) = delete;
+	FanOutLogSink &operator=(FanOutLogSink &&) = delete;
+
+	//
+	// `minimumLevel` is the least severe level forwarded to the target.
+	//
+	TargetId addTarget(LogTarget target, LogLevel minimumLevel = LogLevel::Trace);
+
+	// Returns whether the target was found.
+	bool removeTarget(TargetId id);
+
+	// Returns whether the target was found.
+	bool setTargetLevel(TargetId id, LogLevel minimumLevel);
+
+	//
+	// Whether any target accepts messages at the specified level.
+	//
+	bool enabled(LogLevel level) const override;
+
+	void error(const char *msg) override;
+	void warning(const char *msg) override;
+	void info(const char *msg) override;
+	void debug(const char *msg) override;
+	void trace(const char *msg) override;
+
+private:
+
+	struct Entry
+	{
+		TargetId id;
+		LogLevel minimumLevel;
+
+		// Shared between list versions.
+		std::shared_ptr<const LogTarget> target;
+	};
+
+	struct TargetList
+	{
+		TargetList(std::vector<Entry> &&entries, LogLevel minimumLevel);
+
+		std::vector<Entry> entries;
+
+		// Most verbose level of any target. Not meaningful if there are no entries.
+		LogLevel minimumLevel;
+
+		//
+		// References held by logging threads that acquired the list before it was replaced,
+		// minus those released since. It may drop below zero until the replacing thread has
+		// added the acquisitions.
+		//
+		mutable std::atomic<int64_t> references;
+	};
+
+	//
+	// `m_targets` holds the address of the current list in the low bits and the number of
+	// references acquired through it in the high bits.
+	//
+	static constexpr int ReferenceShift = 48;
+	static constexpr uint64_t AddressMask = (uint64_t(1) << ReferenceShift) - 1;
+
+	//
+	// Each acquired list must be released.
+	//
+	const TargetList *acquire() const;
+	void release(const TargetList *list) const;
+
+	// Invoked with `m_updateMutex` held.
+	const TargetList &current() const;
+
+	//
+	// Release the list held by a word taken out of `m_targets`.
+	//
+	static void Retire(uint64_t targets);
+
+	static void Unreference(const TargetList *list, int64_t count);
+
+	void forward(LogLevel level, const char *msg);
+
+	// Invoked with `m_updateMutex` held.
+	void publish(std::vector<Entry> &&entries);
+
+	mutable std::atomic<uint64_t> m_targets;
+
+	//
+	// Serializes changes to the list.
+	//
+	std::mutex m_updateMutex;
+	TargetId m_nextId;
+};
+
+}
@@ -0,0 +1,365 @@
+#include "stdafx.h"
+#include "flightrecorderlogsink.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+
+namespace common::logging
+{
+
+namespace
+{
+
+std::atomic<uint64_t> NextRecorderId(1);
+
+//
+// Recorder that is dumped by the unhandled exception filter, and the filter it replaced.
+//
+std::atomic<FlightRecorderLogSink *> CrashRecorder(nullptr);
+LPTOP_LEVEL_EXCEPTION_FILTER PreviousExceptionFilter = nullptr;
+
+} // anonymous namespace
+
+//
+// Rings claimed by the current thread, one per recorder it has logged to.
+// Releases the rings for reuse when the thread exits.
+//
+struct FlightRecorderLogSink::ThreadRings
+{
+	~ThreadRings()
+	{
+		for (const auto &[id, ring] : rings)
+		{
+			ring->owned.store(false, std::memory_order_release);
+		}
+	}
+
+	std::vector<std::pair<uint64_t, std::shared_ptr<Ring>>> rings;
+};
+
+FlightRecorderLogSink::Ring::Ring(size_t entryCount, size_t wordsPerEntry)
+	: entries(std::make_unique<Entry[]>(entryCount))
+	, text(std::make_unique<std::atomic<uint64_t>[]>(entryCount * wordsPerEntry))
+	, next(0)
+	, owned(false)
+	, dumped(0)
+{
+}
+
+FlightRecorderLogSink::FlightRecorderLogSink(LogTarget dumpTarget)
+	: FlightRecorderLogSink(std::move(dumpTarget), Options())
+{
+}
+
+FlightRecorderLogSink::FlightRecorderLogSink(LogTarget dumpTarget, Options options)
+	: m_id(NextRecorderId.fetch_add(1))
+	, m_dumpTarget(std::move(dumpTarget))
+	, m_entriesPerThread((std::max)(options.entriesPerThread, size_t(1)))
+	, m_maximumMessageLength((std::max)(options.maximumMessageLength, size_t(1)))
+	, m_wordsPerEntry((m_maximumMessageLength + sizeof(uint64_t) - 1) / sizeof(uint64_t))
+	, m_dumpOnError(options.dumpOnError)
+	, m_clock(options.clock ? std::move(options.clock) : std::make_shared<SteadyClock>())
+	, m_epoch(m_clock->now())
+{
+}
+
+FlightRecorderLogSink::~FlightRecorderLogSink()
+{
+	auto self = this;
+
+	if (CrashRecorder.compare_exchange_strong(self, nullptr))
+	{
+		//
+		// Leave the filter alone if someone else has replaced it since.
+		//
+		const auto current = SetUnhandledExceptionFilter(PreviousExceptionFilter);
+
+		if (current != &FlightRecorderLogSink::UnhandledExceptionHook)
+		{
+			SetUnhandledExceptionFilter(current);
+		}
+	}
+}
+
+void FlightRecorderLogSink::error(const char *msg)
+{
+	record(LogLevel::Error, msg);
+
+	if (m_dumpOnError)
+	{
+		dump(false);
+	}
+}
+
+void FlightRecorderLogSink::warning(const char *msg)
+{
+	record(LogLevel::Warning, msg);
+}
+
+void FlightRecorderLogSink::info(const char *msg)
+{
+	record(LogLevel::Info, msg);
+}
+
+void FlightRecorderLogSink::debug(const char *msg)
+{
+	record(LogLevel::Debug, msg);
+}
+
+void FlightRecorderLogSink::trace(const char *msg)
+{
+	record(LogLevel::Trace, msg);
+}
+
+void FlightRecorderLogSink::dump()
+{
+	dump(false);
+}
+
+void FlightRecorderLogSink::dumpOnUnhandledException()
+{
+	const auto previous = CrashRecorder.exchange(this);
+
+	if (nullptr == previous)
+	{
+		PreviousExceptionFilter = SetUnhandledExceptionFilter(&FlightRecorderLogSink::UnhandledExceptionHook);
+	}
+}
+
+FlightRecorderLogSink::Ring &FlightRecorderLogSink::threadRing()
+{
+	thread_local ThreadRings threadRings;
+
+	for (const auto &[id, ring] : threadRings.rings)
+	{
+		if (id == m_id)
+		{
+			return *ring;
+		}
+	}
+
+	//
+	// Drop rings of recorders that have been destroyed,
+	// this thread holds the only remaining reference.
+	//
+	threadRings.rings.erase(std::remove_if(threadRings.rings.begin(), threadRings.rings.end(),
+		[](const auto &entry)
+	{
+		return 1 == entry.second.use_count();
+	}), threadRings.rings.end());
+
+	std::shared_ptr<Ring> ring;
+
+	{
+		std::scoped_lock<std::mutex> lock(m_ringsMutex);
+
+		const auto available = std::find_if(m_rings.begin(), m_rings.end(), [](const auto &candidate)
+		{
+			return false == candidate->owned.load(std::memory_order_acquire);
+		});
+
+		if (m_rings.end() != available)
+		{
+			ring = *available;
+		}
+		else
+		{
+			ring = std::make_shared<Ring>(m_entriesPerThread, m_wordsPerEntry);
+			m_rings.push_back(ring);
+		}
+
+		ring->owned.store(true, std::memory_order_relaxed);
+	}
+
+	threadRings.rings.emplace_back(m_id, ring);
+
+	return *ring;
+}
+
+void FlightRecorderLogSink::record(LogLevel level, const char *msg)
+{
+	const auto timestamp = (m_clock->now() - m_epoch).count();
+
+	auto &ring = threadRing();
+
+	const auto position = ring.next++;
+	const auto index = static_cast<size_t>(position % m_entriesPerThread);
+
+	auto &entry = ring.entries[index];
+	const auto text = ring.text.get() + index * m_wordsPerEntry;
+
+	const auto length = (std::min)(strlen(msg), m_maximumMessageLength - 1);
+
+	entry.sequence.store(2 * position + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	entry.timestamp.store(timestamp, std::memory_order_relaxed);
+	entry.threadId.store(GetCurrentThreadId(), std::memory_order_relaxed);
+	entry.level.store(level, std::memory_order_relaxed);
+	entry.length.store(static_cast<uint32_t>(length), std::memory_order_relaxed);
+
+	for (size_t offset = 0; offset < length; offset += sizeof(uint64_t))
+	{
+		uint64_t word = 0;
+		memcpy(&word, msg + offset, (std::min)(length - offset, sizeof(uint64_t)));
+
+		text[offset / sizeof(uint64_t)].store(word, std::memory_order_relaxed);
+	}
+
+	entry.sequence.store(2 * position + 2, std::memory_order_release);
+}
+
+void FlightRecorderLogSink::dump(bool crashing)
+{
+	std::unique_lock<std::mutex> dumpLock(m_dumpMutex, std::defer_lock);
+
+	if (crashing)
+	{
+		if (false == dumpLock.try_lock())
+		{
+			return;
+		}
+	}
+	else
+	{
+		dumpLock.lock();
+	}
+
+	struct Snapshot
+	{
+		int64_t timestamp;
+		uint64_t position;
+		DWORD threadId;
+		LogLevel level;
+		std::string message;
+	};
+
+	std::vector<Snapshot> snapshots;
+
+	std::vector<std::shared_ptr<Ring>> rings;
+
+	{
+		std::unique_lock<std::mutex> ringsLock(m_ringsMutex, std::defer_lock);
+
+		if (crashing)
+		{
+			if (false == ringsLock.try_lock())
+			{
+				return;
+			}
+		}
+		else
+		{
+			ringsLock.lock();
+		}
+
+		rings = m_rings;
+	}
+
+	for (const auto &ring : rings)
+	{
+		uint64_t dumped = ring->dumped;
+
+		for (size_t index = 0; index < m_entriesPerThread; ++index)
+		{
+			auto &entry = ring->entries[index];
+
+			const auto before = entry.sequence.load(std::memory_order_acquire);
+
+			//
+			// Skip entries that have never been written, are being written, or have been dumped.
+			//
+			if (0 == before || 0 != (before & 1) || before / 2 - 1 < ring->dumped)
+			{
+				continue;
+			}
+
+			Snapshot snapshot;
+
+			snapshot.timestamp = entry.timestamp.load(std::memory_order_relaxed);
+			snapshot.position = before / 2 - 1;
+			snapshot.threadId = entry.threadId.load(std::memory_order_relaxed);
+			snapshot.level = entry.level.load(std::memory_order_relaxed);
+
+			const auto length = (std::min)(size_t(entry.length.load(std::memory_order_relaxed)), m_maximumMessageLength - 1);
+			const auto text = ring->text.get() + index * m_wordsPerEntry;
+
+			snapshot.message.resize(length);
+
+			for (size_t offset = 0; offset < length; offset += sizeof(uint64_t))
+			{
+				const auto word = text[offset / sizeof(uint64_t)].load(std::memory_order_relaxed);
+				memcpy(snapshot.message.data() + offset, &word, (std::min)(length - offset, sizeof(uint64_t)));
+			}
+
+			//
+			// Discard the copy if the entry was overwritten meanwhile.
+			//
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			if (entry.sequence.load(std::memory_order_relaxed) != before)
+			{
+				continue;
+			}
+
+			dumped = (std::max)(dumped, before / 2);
+			snapshots.push_back(std::move(snapshot));
+		}
+
+		ring->dumped = dumped;
+	}
+
+	//
+	// Entries are visited in slot order, which is not the recording order once a ring
+	// has wrapped. Break timestamp ties on the position so each ring stays in order.
+	//
+	std::sort(snapshots.begin(), snapshots.end(), [](const Snapshot &lhs, const Snapshot &rhs)
+	{
+		if (lhs.timestamp != rhs.timestamp)
+		{
+			return lhs.timestamp < rhs.timestamp;
+		}
+
+		return lhs.position < rhs.position;
+	});
+
+	if (!m_dumpTarget)
+	{
+		return;
+	}
+
+	for (const auto &snapshot : snapshots)
+	{
+		char prefix[64];
+
+		std::snprintf(prefix, sizeof(prefix), "[%lld.%06lld][%lu] ",
+			static_cast<long long>(snapshot.timestamp / 1000000000),
+			static_cast<long long>((snapshot.timestamp / 1000) % 1000000),
+			static_cast<unsigned long>(snapshot.threadId));
+
+		m_dumpTarget(snapshot.level, std::string(prefix).append(snapshot.message).c_str());
+	}
+}
+
+//static
+LONG WINAPI FlightRecorderLogSink::UnhandledExceptionHook(EXCEPTION_POINTERS *exceptionInfo)
+{
+	if (const auto recorder = CrashRecorder.load(); nullptr != recorder)
+	{
+		try
+		{
+			recorder->dump(true);
+		}
+		catch (...)
+		{
+		}
+	}
+
+	return (nullptr != PreviousExceptionFilter
+		? PreviousExceptionFilter(exceptionInfo)
+		: EXCEPTION_CONTINUE_SEARCH);
+}
+
+}
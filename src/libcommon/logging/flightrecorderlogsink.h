@@ -0,0 +1,152 @@
+#pragma once
+
+#include "ilogsink.h"
+#include "logsink.h"
+#include "../clock.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <windows.h>
+
+namespace common::logging
+{
+
+//
+// Log sink that keeps the most recent messages of every thread in memory.
+//
+// Each thread writes into a fixed-size ring of its own, so recording a message is a clock
+// read and a copy, without locks or allocations. Messages longer than a ring entry are
+// truncated. When the ring is full, the oldest messages are overwritten.
+//
+// The rings are dumped to the dump target, merged in timestamp order:
+//
+// - On demand, through `dump()`.
+// - When an error is logged, if enabled.
+// - From the unhandled exception filter, if installed.
+//
+// Each dump only includes messages recorded since the previous dump.
+//
+// Rings belonging to threads that have exited are reused by new threads, so memory use
+// is bounded by the number of threads that log concurrently.
+//
+class FlightRecorderLogSink : public ILogSink
+{
+public:
+
+	struct Options
+	{
+		size_t entriesPerThread = 512;
+
+		// Including the terminating null character.
+		size_t maximumMessageLength = 256;
+
+		bool dumpOnError = true;
+
+		// If not specified, the steady clock is used.
+		std::shared_ptr<IClock> clock;
+	};
+
+	explicit FlightRecorderLogSink(LogTarget dumpTarget);
+	FlightRecorderLogSink(LogTarget dumpTarget, Options options);
+
+	~FlightRecorderLogSink();
+
+	FlightRecorderLogSink(const FlightRecorderLogSink &) = delete;
+	FlightRecorderLogSink &operator=(const FlightRecorderLogSink &) = delete;
+	FlightRecorderLogSink(FlightRecorderLogSink &&) = delete;
+	FlightRecorderLogSink &operator=(FlightRecorderLogSink &&) = delete;
+
+	void error(const char *msg) override;
+	void warning(const char *msg) override;
+	void info(const char *msg) override;
+	void debug(const char *msg) override;
+	void trace(const char *msg) override;
+
+	//
+	// Write messages recorded since the previous dump to the dump target.
+	//
+	void dump();
+
+	//
+	// Dump the rings from the process-wide unhandled exception filter, then pass the
+	// exception on to the previously installed filter.
+	//
+	// Only one recorder can be installed at a time. The filter is removed when the
+	// recorder is destroyed.
+	//
+	// Dumping from a crashed process is best effort.
+	//
+	void dumpOnUnhandledException();
+
+private:
+
+	struct Entry
+	{
+		//
+		// 2 * position + 1 while being written, 2 * position + 2 once written,
+		// where position counts the messages written to the ring.
+		//
+		std::atomic<uint64_t> sequence;
+
+		std::atomic<int64_t> timestamp;
+		std::atomic<DWORD> threadId;
+		std::atomic<LogLevel> level;
+		std::atomic<uint32_t> length;
+	};
+
+	struct Ring
+	{
+		Ring(size_t entryCount, size_t wordsPerEntry);
+
+		std::unique_ptr<Entry[]> entries;
+
+		//
+		// Message text, copied in words so a dump racing a writer reads stale
+		// rather than torn memory. The sequence check discards such copies.
+		//
+		std::unique_ptr<std::atomic<uint64_t>[]> text;
+
+		// Only accessed by the owning thread.
+		uint64_t next;
+
+		// Cleared when the owning thread exits.
+		std::atomic<bool> owned;
+
+		// Position of the next message to dump, guarded by `m_dumpMutex`.
+		uint64_t dumped;
+	};
+
+	struct ThreadRings;
+
+	Ring &threadRing();
+
+	void record(LogLevel level, const char *msg);
+
+	//
+	// When `crashing`, the dump is skipped rather than waiting for a lock.
+	//
+	void dump(bool crashing);
+
+	static LONG WINAPI UnhandledExceptionHook(EXCEPTION_POINTERS *exceptionInfo);
+
+	// Identifies the recorder in per-thread state, never reused.
+	const uint64_t m_id;
+
+	LogTarget m_dumpTarget;
+	size_t m_entriesPerThread;
+	size_t m_maximumMessageLength;
+	size_t m_wordsPerEntry;
+	bool m_dumpOnError;
+
+	std::shared_ptr<IClock> m_clock;
+	IClock::Duration m_epoch;
+
+	std::mutex m_ringsMutex;
+	std::vector<std::shared_ptr<Ring>> m_rings;
+
+	std::mutex m_dumpMutex;
+};
+
+}
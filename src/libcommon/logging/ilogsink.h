@@ -3,12 +3,30 @@
 namespace common::logging
 {
 
+enum class LogLevel
+{
+	Error,
+	Warning,
+	Info,
+	Debug,
+	Trace
+};
+
 struct ILogSink
 {
 	virtual ~ILogSink() = 0
 	{
 	}
 
+	//
+	// Whether messages at the specified level are forwarded.
+	// Callers may use this to skip formatting messages that would be discarded.
+	//
+	virtual bool enabled(LogLevel) const
+	{
+		return true;
+	}
+
 	virtual void error(const char *msg) = 0;
 	virtual void warning(const char *msg) = 0;
 	virtual void info(const char *msg) = 0;
@@ -16,4 +34,19 @@ struct ILogSink
 	virtual void trace(const char *msg) = 0;
 };
 
+//
+// Invoke the method on `sink` that corresponds to `level`.
+//
+inline void Forward(ILogSink &sink, LogLevel level, const char *msg)
+{
+	switch (level)
+	{
+		case LogLevel::Error: sink.error(msg); break;
+		case LogLevel::Warning: sink.warning(msg); break;
+		case LogLevel::Info: sink.info(msg); break;
+		case LogLevel::Debug: sink.debug(msg); break;
+		case LogLevel::Trace: sink.trace(msg); break;
+	}
+}
+
 }
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "ilogsink.h"
+#include <sstream>
+
+//
+// Logging macros that check the level before building the message.
+//
+// `sink` is anything that can be dereferenced with `->` to reach an ILogSink,
+// e.g. a raw or shared pointer. It is evaluated once.
+//
+// `message` is a stream expression:
+//
+// LOG_DEBUG(logSink, "Opened adapter " << common::string::ToAnsi(name) << ", index " << index);
+//
+// If the level is not enabled, the stream expression is never evaluated.
+//
+
+#define LOG_MESSAGE(sink, level, method, message)\
+{\
+	auto &&libcommonLogSink = (sink);\
+	if (libcommonLogSink->enabled(level))\
+	{\
+		std::stringstream libcommonLogStream;\
+		libcommonLogStream << message;\
+		libcommonLogSink->method(libcommonLogStream.str().c_str());\
+	}\
+}\
+
+#define LOG_ERROR(sink, message) LOG_MESSAGE(sink, ::common::logging::LogLevel::Error, error, message)
+#define LOG_WARNING(sink, message) LOG_MESSAGE(sink, ::common::logging::LogLevel::Warning, warning, message)
+#define LOG_INFO(sink, message) LOG_MESSAGE(sink, ::common::logging::LogLevel::Info, info, message)
+#define LOG_DEBUG(sink, message) LOG_MESSAGE(sink, ::common::logging::LogLevel::Debug, debug, message)
+#define LOG_TRACE(sink, message) LOG_MESSAGE(sink, ::common::logging::LogLevel::Trace, trace, message)
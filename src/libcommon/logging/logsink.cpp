@@ -8,6 +8,7 @@ using LockType = std::scoped_lock<std::mutex>;
 
 LogSink::LogSink(LogTarget target)
 	: m_target(target)
+	, m_minimumLevel(LogLevel::Trace)
 {
 }
 
@@ -17,6 +18,16 @@ void LogSink::setTarget(LogTarget target)
 	m_target = target;
 }
 
+void LogSink::setMinimumLevel(LogLevel level)
+{
+	m_minimumLevel.store(level, std::memory_order_relaxed);
+}
+
+bool LogSink::enabled(LogLevel level) const
+{
+	return level <= m_minimumLevel.load(std::memory_order_relaxed);
+}
+
 void LogSink::error(const char *msg)
 {
 	forward(LogLevel::Error, msg);
@@ -44,6 +55,11 @@ void LogSink::trace(const char *msg)
 
 void LogSink::forward(LogLevel level, const char *msg)
 {
+	if (false == enabled(level))
+	{
+		return;
+	}
+
 	LockType lock(m_mutex);
 
 	if (m_target)
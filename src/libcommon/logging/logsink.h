@@ -1,21 +1,13 @@
 #pragma once
 
 #include "ilogsink.h"
+#include <atomic>
 #include <mutex>
 #include <functional>
 
 namespace common::logging
 {
 
-enum class LogLevel
-{
-	Error,
-	Warning,
-	Info,
-	Debug,
-	Trace
-};
-
 using LogTarget = std::function<void(LogLevel, const char *)>;
 
 class LogSink : public ILogSink
@@ -31,6 +23,14 @@ public:
 
 	void setTarget(LogTarget target);
 
+	//
+	// Least severe level that is forwarded to the target.
+	// Defaults to `LogLevel::Trace`, i.e. all messages are forwarded.
+	//
+	void setMinimumLevel(LogLevel level);
+
+	bool enabled(LogLevel level) const override;
+
 	virtual void error(const char *msg) override;
 	virtual void warning(const char *msg) override;
 	virtual void info(const char *msg) override;
@@ -43,6 +43,8 @@ private:
 
 	std::mutex m_mutex;
 	LogTarget m_target;
+
+	std::atomic<LogLevel> m_minimumLevel;
 };
 
 }
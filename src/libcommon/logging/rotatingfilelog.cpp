@@ -0,0 +1,303 @@
+#include "stdafx.h"
+#include "rotatingfilelog.h"
+#include <libcommon/error.h>
+#include <libcommon/fileenumerator.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cwchar>
+#include <filesystem>
+
+namespace common::logging
+{
+
+namespace
+{
+
+const char *LevelName(LogLevel level)
+{
+	switch (level)
+	{
+		case LogLevel::Error: return "Error";
+		case LogLevel::Warning: return "Warning";
+		case LogLevel::Info: return "Info";
+		case LogLevel::Debug: return "Debug";
+		case LogLevel::Trace: return "Trace";
+	}
+
+	return "Unknown";
+}
+
+} // anonymous namespace
+
+RotatingFileLog::RotatingFileLog(Options options)
+	: m_options(std::move(options))
+	, m_segmentSize(m_options.segmentSize)
+	, m_view(nullptr)
+	, m_written(0)
+	, m_flushed(0)
+	, m_segmentCreated(0)
+	, m_scheduler(m_options.scheduler ? m_options.scheduler : std::make_shared<TimerWheel>())
+	, m_flushTimer(*m_scheduler, [this]()
+	{
+		std::scoped_lock<std::mutex> lock(m_mutex);
+		flushView();
+	})
+{
+	if (m_options.baseName.empty() || 0 == m_segmentSize || 0 == m_options.retainedSegments)
+	{
+		THROW_ERROR("Invalid rotating file log options");
+	}
+
+	scanSegments();
+
+	std::scoped_lock<std::mutex> lock(m_mutex);
+	openSegment();
+}
+
+RotatingFileLog::~RotatingFileLog()
+{
+	m_flushTimer.cancel();
+
+	std::scoped_lock<std::mutex> lock(m_mutex);
+
+	try
+	{
+		closeSegment();
+	}
+	catch (...)
+	{
+	}
+}
+
+LogTarget RotatingFileLog::target()
+{
+	return [this](LogLevel level, const char *msg)
+	{
+		write(level, msg);
+	};
+}
+
+void RotatingFileLog::write(LogLevel level, const char *msg)
+{
+	SYSTEMTIME time;
+	GetLocalTime(&time);
+
+	char prefix[64];
+
+	const auto prefixLength = static_cast<size_t>(std::snprintf(prefix, sizeof(prefix),
+		"[%04u-%02u-%02u %02u:%02u:%02u.%03u][%s] ",
+		time.wYear, time.wMonth, time.wDay, time.wHour, time.wMinute, time.wSecond, time.wMilliseconds,
+		LevelName(level)));
+
+	const auto messageLength = strlen(msg);
+	const auto lineLength = prefixLength + messageLength + 2;
+
+	std::scoped_lock<std::mutex> lock(m_mutex);
+
+	const auto aged = (m_options.maximumAge.count() > 0
+		&& m_scheduler->now() - m_segmentCreated >= m_options.maximumAge);
+
+	//
+	// Keep lines within a single segment, unless a line is larger than a segment.
+	// There is no view if opening the next segment failed previously.
+	//
+	if (nullptr == m_view || (0 != m_written && (aged || m_written + lineLength > m_segmentSize)))
+	{
+		//
+		// A log target must not throw. Drop the line and leave the log without a view,
+		// so the next write retries the roll.
+		//
+		try
+		{
+			roll();
+		}
+		catch (...)
+		{
+			return;
+		}
+	}
+
+	append(prefix, prefixLength);
+	append(msg, messageLength);
+	append("\r\n", 2);
+
+	if (m_written - m_flushed >= m_options.flushThreshold)
+	{
+		m_flushTimer.cancel();
+		flushView();
+	}
+	else if (false == m_flushTimer.armed())
+	{
+		m_flushTimer.arm(m_options.flushInterval);
+	}
+}
+
+void RotatingFileLog::flush()
+{
+	std::scoped_lock<std::mutex> lock(m_mutex);
+	flushView();
+}
+
+std::wstring RotatingFileLog::activeSegment() const
+{
+	std::scoped_lock<std::mutex> lock(m_mutex);
+	return segmentPath(m_segments.back());
+}
+
+std::wstring RotatingFileLog::segmentPath(uint64_t sequence) const
+{
+	return std::filesystem::path(m_options.directory)
+		.append(m_options.baseName + L"." + std::to_wstring(sequence) + L".log").wstring();
+}
+
+void RotatingFileLog::scanSegments()
+{
+	common::fs::FileEnumerator files(m_options.directory, m_options.baseName + L".*.log");
+	files.addFilter(std::make_unique<common::fs::FilterFiles>());
+
+	const auto prefixLength = m_options.baseName.size() + 1;
+	constexpr size_t SuffixLength = sizeof(".log") - 1;
+
+	WIN32_FIND_DATAW file;
+
+	while (files.next(file))
+	{
+		const std::wstring name(file.cFileName);
+
+		//
+		// The mask also matches names that have something other than a sequence number
+		// between the base name and the extension.
+		//
+		if (name.size() <= prefixLength + SuffixLength)
+		{
+			continue;
+		}
+
+		const auto sequenceBegin = name.begin() + prefixLength;
+		const auto sequenceEnd = name.end() - SuffixLength;
+
+		if (false == std::all_of(sequenceBegin, sequenceEnd, [](wchar_t c) { return c >= L'0' && c <= L'9'; }))
+		{
+			continue;
+		}
+
+		m_segments.push_back(std::wcstoull(name.c_str() + prefixLength, nullptr, 10));
+	}
+
+	std::sort(m_segments.begin(), m_segments.end());
+}
+
+void RotatingFileLog::openSegment()
+{
+	const auto sequence = (m_segments.empty() ? 1 : m_segments.back() + 1);
+	const auto path = segmentPath(sequence);
+
+	//
+	// Open into locals so a failure leaves no handle behind that would block the next
+	// attempt at creating the same segment.
+	// Allow readers to follow the log while it is being written.
+	//
+	common::memory::UniqueKernelHandle file(CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+		FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr));
+
+	if (false == bool(file))
+	{
+		THROW_WINDOWS_ERROR(GetLastError(), "Create log segment");
+	}
+
+	const auto size = static_cast<uint64_t>(m_segmentSize);
+
+	common::memory::UniqueKernelHandle mapping(CreateFileMappingW(file.get(), nullptr, PAGE_READWRITE,
+		static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), nullptr));
+
+	if (false == bool(mapping))
+	{
+		THROW_WINDOWS_ERROR(GetLastError(), "Create mapping for log segment");
+	}
+
+	const auto view = reinterpret_cast<uint8_t *>(MapViewOfFile(mapping.get(), FILE_MAP_WRITE, 0, 0, m_segmentSize));
+
+	if (nullptr == view)
+	{
+		THROW_WINDOWS_ERROR(GetLastError(), "Map log segment");
+	}
+
+	m_file = std::move(file);
+	m_mapping = std::move(mapping);
+	m_view = view;
+
+	m_written = 0;
+	m_flushed = 0;
+	m_segmentCreated = m_scheduler->now();
+
+	m_segments.push_back(sequence);
+
+	while (m_segments.size() > m_options.retainedSegments)
+	{
+		//
+		// A segment that is open elsewhere is left behind.
+		//
+		DeleteFileW(segmentPath(m_segments.front()).c_str());
+		m_segments.pop_front();
+	}
+}
+
+void RotatingFileLog::closeSegment()
+{
+	if (nullptr == m_view)
+	{
+		return;
+	}
+
+	flushView();
+
+	UnmapViewOfFile(m_view);
+	m_view = nullptr;
+
+	m_mapping.reset();
+
+	LARGE_INTEGER size;
+	size.QuadPart = static_cast<LONGLONG>(m_written);
+
+	if (FALSE == SetFilePointerEx(m_file.get(), size, nullptr, FILE_BEGIN)
+		|| FALSE == SetEndOfFile(m_file.get()))
+	{
+		const auto error = GetLastError();
+
+		m_file.reset();
+
+		THROW_WINDOWS_ERROR(error, "Truncate log segment");
+	}
+
+	m_file.reset();
+}
+
+void RotatingFileLog::roll()
+{
+	closeSegment();
+	openSegment();
+}
+
+void RotatingFileLog::flushView()
+{
+	if (nullptr == m_view || m_written == m_flushed)
+	{
+		return;
+	}
+
+	FlushViewOfFile(m_view + m_flushed, m_written - m_flushed);
+
+	m_flushed = m_written;
+}
+
+void RotatingFileLog::append(const char *data, size_t length)
+{
+	const auto bytes = (std::min)(length, m_segmentSize - m_written);
+
+	memcpy(m_view + m_written, data, bytes);
+
+	m_written += bytes;
+}
+
+}
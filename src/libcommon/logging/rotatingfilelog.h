@@ -0,0 +1,124 @@
+#pragma once
+
+#include "logsink.h"
+#include "../memory.h"
+#include "../timerwheel.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <windows.h>
+
+namespace common::logging
+{
+
+//
+// File backed log target that appends into memory-mapped segments.
+//
+// Segments are named `<baseName>.<sequence>.log` and live in `directory`. A new segment
+// is started when the current one is full or has reached the maximum age. Only the most
+// recent `retainedSegments` segments are kept, older ones are deleted.
+//
+// Writing a line is a copy into the mapped view. Dirty pages are flushed to disk once
+// `flushThreshold` bytes have accumulated, or `flushInterval` after the first unflushed
+// line, whichever comes first. The unused tail of a segment is truncated when the
+// segment is closed.
+//
+// Segment age is checked when writing.
+// Failing to create the first segment throws. Later failures drop the line being written
+// and the next write retries.
+//
+class RotatingFileLog
+{
+public:
+
+	struct Options
+	{
+		std::wstring directory;
+		std::wstring baseName;
+
+		// Mapped size of each segment.
+		size_t segmentSize = 4 * 1024 * 1024;
+
+		// If specified as 0, segments are only rolled by size.
+		std::chrono::milliseconds maximumAge = std::chrono::milliseconds(0);
+
+		// Including the active segment.
+		uint32_t retainedSegments = 5;
+
+		size_t flushThreshold = 64 * 1024;
+		std::chrono::milliseconds flushInterval = std::chrono::milliseconds(1000);
+
+		//
+		// Timer wheel to schedule the flush timer on.
+		// Segment age is measured with the clock of the wheel.
+		// If not specified, a dedicated timer thread is used.
+		//
+		std::shared_ptr<TimerWheel> scheduler;
+	};
+
+	explicit RotatingFileLog(Options options);
+
+	//
+	// Flushes and truncates the active segment.
+	//
+	~RotatingFileLog();
+
+	RotatingFileLog(const RotatingFileLog &) = delete;
+	RotatingFileLog &operator=(const RotatingFileLog &) = delete;
+	RotatingFileLog(RotatingFileLog &&) = delete;
+	RotatingFileLog &operator=(RotatingFileLog &&) = delete;
+
+	//
+	// Returns a target that writes to this log.
+	// The log must outlive the target.
+	//
+	LogTarget target();
+
+	void write(LogLevel level, const char *msg);
+
+	void flush();
+
+	//
+	// Path of the segment currently being written.
+	//
+	std::wstring activeSegment() const;
+
+private:
+
+	std::wstring segmentPath(uint64_t sequence) const;
+
+	// Find segments left behind by earlier instances.
+	void scanSegments();
+
+	// Invoked with `m_mutex` held.
+	void openSegment();
+	void closeSegment();
+	void roll();
+	void flushView();
+	void append(const char *data, size_t length);
+
+	Options m_options;
+	size_t m_segmentSize;
+
+	mutable std::mutex m_mutex;
+
+	// Sequence numbers of segments on disk, oldest first.
+	std::deque<uint64_t> m_segments;
+
+	common::memory::UniqueKernelHandle m_file;
+	common::memory::UniqueKernelHandle m_mapping;
+	uint8_t *m_view;
+
+	size_t m_written;
+	size_t m_flushed;
+
+	IClock::Duration m_segmentCreated;
+
+	std::shared_ptr<TimerWheel> m_scheduler;
+	TimerWheel::Timer m_flushTimer;
+};
+
+}
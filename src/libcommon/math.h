@@ -6,8 +6,8 @@ namespace common::math {
 
 inline size_t RoundPowerTwo(size_t value, size_t r)
 {
-	// power of two
-	assert(r > 1 && (r & (r - 1)) == 0);
+	// power of two, including 1
+	assert(r > 0 && (r & (r - 1)) == 0);
 
 	return ((value + r - 1) & ~(r - 1));
 }
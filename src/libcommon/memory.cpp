@@ -0,0 +1,168 @@
+#include "stdafx.h"
+#include "memory.h"
+#include <cstring>
+
+#if defined(_M_IX86) || defined(_M_X64)
+#include <intrin.h>
+#include <tmmintrin.h>
+#define LIBCOMMON_BYTESWAP_SSSE3
+#elif defined(_M_ARM64)
+#include <arm64_neon.h>
+#define LIBCOMMON_BYTESWAP_NEON
+#endif
+
+namespace
+{
+
+constexpr size_t VectorSize = 16;
+
+//
+// Scalar conversion of the elements that remain after the vector loop.
+// `memcpy` keeps the accesses alignment-safe and compiles into plain loads and stores.
+//
+template<typename T>
+void ByteSwapScalar(const uint8_t *source, uint8_t *destination, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		T value;
+
+		memcpy(&value, source + i * sizeof(T), sizeof(T));
+		value = common::memory::ByteSwap(value);
+		memcpy(destination + i * sizeof(T), &value, sizeof(T));
+	}
+}
+
+#if defined(LIBCOMMON_BYTESWAP_SSSE3)
+
+bool SupportsSsse3()
+{
+	static const bool supported = []()
+	{
+		int info[4];
+		__cpuid(info, 1);
+
+		return 0 != (info[2] & (1 << 9));
+	}();
+
+	return supported;
+}
+
+template<typename T>
+__m128i ShuffleMask()
+{
+	if constexpr (sizeof(T) == sizeof(uint16_t))
+	{
+		return _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+	}
+	else if constexpr (sizeof(T) == sizeof(uint32_t))
+	{
+		return _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	}
+	else
+	{
+		return _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+	}
+}
+
+template<typename T>
+size_t ByteSwapVector(const uint8_t *source, uint8_t *destination, size_t count)
+{
+	if (false == SupportsSsse3())
+	{
+		return 0;
+	}
+
+	const auto mask = ShuffleMask<T>();
+	const auto vectors = (count * sizeof(T)) / VectorSize;
+
+	for (size_t i = 0; i < vectors; ++i)
+	{
+		const auto offset = i * VectorSize;
+		const auto value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + offset));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(destination + offset), _mm_shuffle_epi8(value, mask));
+	}
+
+	return (vectors * VectorSize) / sizeof(T);
+}
+
+#elif defined(LIBCOMMON_BYTESWAP_NEON)
+
+template<typename T>
+uint8x16_t Reverse(uint8x16_t value)
+{
+	if constexpr (sizeof(T) == sizeof(uint16_t))
+	{
+		return vrev16q_u8(value);
+	}
+	else if constexpr (sizeof(T) == sizeof(uint32_t))
+	{
+		return vrev32q_u8(value);
+	}
+	else
+	{
+		return vrev64q_u8(value);
+	}
+}
+
+template<typename T>
+size_t ByteSwapVector(const uint8_t *source, uint8_t *destination, size_t count)
+{
+	const auto vectors = (count * sizeof(T)) / VectorSize;
+
+	//
+	// Byte-sized loads and stores have no alignment requirement.
+	//
+	for (size_t i = 0; i < vectors; ++i)
+	{
+		const auto offset = i * VectorSize;
+
+		vst1q_u8(destination + offset, Reverse<T>(vld1q_u8(source + offset)));
+	}
+
+	return (vectors * VectorSize) / sizeof(T);
+}
+
+#else
+
+template<typename T>
+size_t ByteSwapVector(const uint8_t *, uint8_t *, size_t)
+{
+	return 0;
+}
+
+#endif
+
+template<typename T>
+void ByteSwapBulk(const void *source, void *destination, size_t count)
+{
+	auto from = reinterpret_cast<const uint8_t *>(source);
+	auto to = reinterpret_cast<uint8_t *>(destination);
+
+	const auto converted = ByteSwapVector<T>(from, to, count);
+	const auto offset = converted * sizeof(T);
+
+	ByteSwapScalar<T>(from + offset, to + offset, count - converted);
+}
+
+} // anonymous namespace
+
+namespace common::memory {
+
+void ByteSwap16(const void *source, void *destination, size_t count)
+{
+	ByteSwapBulk<uint16_t>(source, destination, count);
+}
+
+void ByteSwap32(const void *source, void *destination, size_t count)
+{
+	ByteSwapBulk<uint32_t>(source, destination, count);
+}
+
+void ByteSwap64(const void *source, void *destination, size_t count)
+{
+	ByteSwapBulk<uint64_t>(source, destination, count);
+}
+
+}
@@ -2,13 +2,234 @@
 
 #include "math.h"
 #include <windows.h>
+#include <objbase.h>
 #include <algorithm>
+#include <cstdint>
+#include <cstdlib>
 #include <functional>
 #include <memory>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace common::memory {
 
+//
+// Owns an OS resource whose value is stored inline, e.g. a HANDLE or an HKEY.
+//
+// `Traits` must provide:
+//
+// `Type`                 The type of the resource value.
+// `Type Invalid()`       The value held by an empty instance.
+// `bool IsValid(Type)`   Whether a value refers to a live resource.
+// `void Close(Type)`     Release the resource.
+//
+template<typename Traits>
+class UniqueResource
+{
+public:
+
+	using Type = typename Traits::Type;
+
+	UniqueResource()
+		: m_value(Traits::Invalid())
+	{
+	}
+
+	explicit UniqueResource(Type value) noexcept
+		: m_value(value)
+	{
+	}
+
+	~UniqueResource()
+	{
+		reset();
+	}
+
+	UniqueResource(UniqueResource &&rhs) noexcept
+		: m_value(rhs.release())
+	{
+	}
+
+	UniqueResource &operator=(UniqueResource &&rhs) noexcept
+	{
+		if (this != &rhs)
+		{
+			reset(rhs.release());
+		}
+
+		return *this;
+	}
+
+	UniqueResource(const UniqueResource &) = delete;
+	UniqueResource &operator=(const UniqueResource &) = delete;
+
+	Type get() const
+	{
+		return m_value;
+	}
+
+	explicit operator bool() const
+	{
+		return Traits::IsValid(m_value);
+	}
+
+	Type release()
+	{
+		const auto value = m_value;
+		m_value = Traits::Invalid();
+
+		return value;
+	}
+
+	void reset(Type value = Traits::Invalid())
+	{
+		const auto previous = m_value;
+		m_value = value;
+
+		if (Traits::IsValid(previous))
+		{
+			Traits::Close(previous);
+		}
+	}
+
+	//
+	// Release the current resource, if any, and return the address of the storage.
+	// This is used with APIs that return a resource through an out parameter.
+	//
+	Type *receive()
+	{
+		reset();
+		return &m_value;
+	}
+
+private:
+
+	Type m_value;
+};
+
+struct HandleTraits
+{
+	using Type = HANDLE;
+
+	static Type Invalid()
+	{
+		return nullptr;
+	}
+
+	static bool IsValid(Type value)
+	{
+		return nullptr != value && INVALID_HANDLE_VALUE != value;
+	}
+
+	static void Close(Type value)
+	{
+		CloseHandle(value);
+	}
+};
+
+struct FindHandleTraits
+{
+	using Type = HANDLE;
+
+	static Type Invalid()
+	{
+		return INVALID_HANDLE_VALUE;
+	}
+
+	static bool IsValid(Type value)
+	{
+		return INVALID_HANDLE_VALUE != value;
+	}
+
+	static void Close(Type value)
+	{
+		FindClose(value);
+	}
+};
+
+struct RegistryKeyTraits
+{
+	using Type = HKEY;
+
+	static Type Invalid()
+	{
+		return nullptr;
+	}
+
+	static bool IsValid(Type value)
+	{
+		return nullptr != value;
+	}
+
+	static void Close(Type value)
+	{
+		RegCloseKey(value);
+	}
+};
+
+//
+// Memory returned by APIs that document it must be released with `LocalFree`.
+//
+template<typename T>
+struct LocalMemoryTraits
+{
+	using Type = T;
+
+	static Type Invalid()
+	{
+		return nullptr;
+	}
+
+	static bool IsValid(Type value)
+	{
+		return nullptr != value;
+	}
+
+	static void Close(Type value)
+	{
+		LocalFree(reinterpret_cast<HLOCAL>(value));
+	}
+};
+
+//
+// Memory returned by APIs that document it must be released with `CoTaskMemFree`.
+//
+template<typename T>
+struct CoTaskMemoryTraits
+{
+	using Type = T;
+
+	static Type Invalid()
+	{
+		return nullptr;
+	}
+
+	static bool IsValid(Type value)
+	{
+		return nullptr != value;
+	}
+
+	static void Close(Type value)
+	{
+		CoTaskMemFree(value);
+	}
+};
+
+using UniqueKernelHandle = UniqueResource<HandleTraits>;
+using UniqueFindHandle = UniqueResource<FindHandleTraits>;
+using UniqueRegistryKey = UniqueResource<RegistryKeyTraits>;
+
+template<typename T>
+using UniqueLocalMemory = UniqueResource<LocalMemoryTraits<T> >;
+
+template<typename T>
+using UniqueCoTaskMemory = UniqueResource<CoTaskMemoryTraits<T> >;
+
+//
+// Heap allocated handle wrapper, constructed as `UniqueHandle(new HANDLE(...))`.
+// Kept for existing callers, new code should use `UniqueKernelHandle`.
+//
 struct HandleDeleter
 {
 	void operator()(HANDLE *h)
@@ -17,11 +238,55 @@ struct HandleDeleter
 		{
 			CloseHandle(*h);
 		}
+
+		delete h;
 	}
 };
 
 using UniqueHandle = std::unique_ptr<HANDLE, HandleDeleter>;
 
+//
+// Runs an operation when leaving scope, unless dismissed.
+//
+// The operation is stored inline so creating a guard never allocates, and cannot
+// throw unless moving the operation can.
+// Prefer this over `ScopeDestructor` when the set of operations is known up front.
+//
+template<typename Operation>
+class ScopeGuard
+{
+public:
+
+	ScopeGuard(Operation operation) noexcept(std::is_nothrow_move_constructible_v<Operation>)
+		: m_operation(std::move(operation))
+		, m_active(true)
+	{
+	}
+
+	~ScopeGuard()
+	{
+		if (m_active)
+		{
+			m_operation();
+		}
+	}
+
+	ScopeGuard(const ScopeGuard &) = delete;
+	ScopeGuard &operator=(const ScopeGuard &) = delete;
+	ScopeGuard(ScopeGuard &&) = delete;
+	ScopeGuard &operator=(ScopeGuard &&) = delete;
+
+	void dismiss()
+	{
+		m_active = false;
+	}
+
+private:
+
+	Operation m_operation;
+	bool m_active;
+};
+
 class ScopeDestructor
 {
 public:
@@ -32,7 +297,7 @@ public:
 
 	~ScopeDestructor()
 	{
-		std::for_each(m_operations.rbegin(), m_operations.rend(), [](std::function<void()> op)
+		std::for_each(m_operations.rbegin(), m_operations.rend(), [](const std::function<void()> &op)
 		{
 			op();
 		});
@@ -40,7 +305,7 @@ public:
 
 	ScopeDestructor &operator+=(std::function<void()> op)
 	{
-		m_operations.push_back(op);
+		m_operations.push_back(std::move(op));
 		return *this;
 	}
 
@@ -57,9 +322,48 @@ inline size_t AlignNative(size_t value)
 	return ::common::math::RoundPowerTwo(value, sizeof(size_t));
 }
 
-inline uint16_t ByteSwap(uint16_t val)
+constexpr uint16_t ByteSwap(uint16_t val)
+{
+	if (std::is_constant_evaluated())
+	{
+		return static_cast<uint16_t>(((val & 0xFF) << 8) | ((val & 0xFF00) >> 8));
+	}
+
+	return _byteswap_ushort(val);
+}
+
+constexpr uint32_t ByteSwap(uint32_t val)
+{
+	if (std::is_constant_evaluated())
+	{
+		return ((val & 0x000000FF) << 24) | ((val & 0x0000FF00) << 8)
+			| ((val & 0x00FF0000) >> 8) | ((val & 0xFF000000) >> 24);
+	}
+
+	return _byteswap_ulong(val);
+}
+
+constexpr uint64_t ByteSwap(uint64_t val)
 {
-	return ((val & 0xFF) << 8) | ((val & 0xFF00) >> 8);
+	if (std::is_constant_evaluated())
+	{
+		return (uint64_t(ByteSwap(static_cast<uint32_t>(val))) << 32)
+			| ByteSwap(static_cast<uint32_t>(val >> 32));
+	}
+
+	return _byteswap_uint64(val);
 }
 
+//
+// Byte swap `count` consecutive 16, 32 or 64-bit values from `source` into `destination`.
+//
+// Neither buffer needs to be aligned. The buffers must either be identical,
+// for an in-place conversion, or not overlap at all.
+//
+// SIMD is used where the processor supports it.
+//
+void ByteSwap16(const void *source, void *destination, size_t count);
+void ByteSwap32(const void *source, void *destination, size_t count);
+void ByteSwap64(const void *source, void *destination, size_t count);
+
 }
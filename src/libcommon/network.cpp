@@ -1,6 +1,8 @@
 #include "stdafx.h"
 #include "network.h"
+#include "memory.h"
 #include <winsock2.h>
+#include <cstring>
 
 namespace common::network {
 
@@ -16,7 +18,18 @@ uint32_t MaskFromRoutingPrefix(uint8_t prefix)
 
 uint32_t LiteralAddressToNetwork(const uint8_t *address)
 {
-	return htonl(*reinterpret_cast<const uint32_t *>(address));
+	uint32_t value;
+	memcpy(&value, address, sizeof(value));
+
+	return htonl(value);
+}
+
+void LiteralAddressesToNetwork(const uint8_t *addresses, size_t count, uint32_t *destination)
+{
+	//
+	// All supported architectures are little-endian so `htonl` is a byte swap.
+	//
+	::common::memory::ByteSwap32(addresses, destination, count);
 }
 
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 namespace common::network {
@@ -12,4 +13,10 @@ uint32_t MaskFromRoutingPrefix(uint8_t prefix);
 //
 uint32_t LiteralAddressToNetwork(const uint8_t *address);
 
+//
+// Convert `count` consecutive 4-byte addresses in the same manner.
+// `addresses` does not need to be aligned.
+//
+void LiteralAddressesToNetwork(const uint8_t *addresses, size_t count, uint32_t *destination);
+
 }
@@ -19,14 +19,20 @@ const IP_ADAPTER_ADDRESSES *Adapters::next() const
 	return entry;
 }
 
-Adapters::Adapters(DWORD family, DWORD flags)
+Adapters::Adapters(DWORD family, DWORD flags, std::pmr::memory_resource *resource)
+	: m_buffer(resource)
 {
-	std::vector<uint8_t> buffer;
+	std::pmr::vector<BufferElement> buffer(resource);
+
+	const auto elementsFor = [](size_t bytes)
+	{
+		return (bytes + sizeof(BufferElement) - 1) / sizeof(BufferElement);
+	};
 
 	static const size_t MSDN_RECOMMENDED_STARTING_BUFFER_SIZE = 1024 * 15;
-	buffer.resize(MSDN_RECOMMENDED_STARTING_BUFFER_SIZE);
+	buffer.resize(elementsFor(MSDN_RECOMMENDED_STARTING_BUFFER_SIZE));
 
-	ULONG bufferSize = static_cast<ULONG>(buffer.size());
+	ULONG bufferSize = static_cast<ULONG>(buffer.size() * sizeof(BufferElement));
 	auto bufferPointer = reinterpret_cast<IP_ADAPTER_ADDRESSES *>(&buffer[0]);
 
 	//
@@ -55,7 +61,9 @@ Adapters::Adapters(DWORD family, DWORD flags)
 			THROW_WINDOWS_ERROR(status, "Probe required buffer size for GetAdaptersAddresses");
 		}
 
-		buffer.resize(bufferSize);
+		buffer.resize(elementsFor(bufferSize));
+		bufferSize = static_cast<ULONG>(buffer.size() * sizeof(BufferElement));
+
 		bufferPointer = reinterpret_cast<IP_ADAPTER_ADDRESSES *>(&buffer[0]);
 	}
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory_resource>
 #include <vector>
 #include <winsock2.h>
 #include <windows.h>
@@ -15,7 +16,16 @@ namespace common::network
 
 class Adapters
 {
-	std::vector<uint8_t> m_buffer;
+	//
+	// Unit of storage for the adapter data.
+	// Ensures the data is aligned for `IP_ADAPTER_ADDRESSES`, whatever the memory resource.
+	//
+	struct alignas(IP_ADAPTER_ADDRESSES) BufferElement
+	{
+		uint8_t bytes[alignof(IP_ADAPTER_ADDRESSES)];
+	};
+
+	std::pmr::vector<BufferElement> m_buffer;
 	mutable const IP_ADAPTER_ADDRESSES *m_currentEntry;
 
 public:
@@ -29,7 +39,10 @@ public:
 	{
 	}
 
-	Adapters(DWORD family, DWORD flags);
+	//
+	// The adapter data is allocated from `resource`.
+	//
+	Adapters(DWORD family, DWORD flags, std::pmr::memory_resource *resource = std::pmr::get_default_resource());
 
 	const IP_ADAPTER_ADDRESSES *next() const;
 
@@ -7,7 +7,7 @@
 #include <windows.h>
 #include <process.h>
 
-using UniqueHandle = common::memory::UniqueHandle;
+using UniqueKernelHandle = common::memory::UniqueKernelHandle;
 
 namespace common::process
 {
@@ -23,9 +23,9 @@ ApplicationRunner::ApplicationRunner(const std::wstring &path, const std::wstrin
 	STARTUPINFOW si = { 0 };
 
 	si.cb = sizeof(si);
-	si.hStdError = *m_stdOutWrite.get();
-	si.hStdOutput = *m_stdOutWrite.get();
-	si.hStdInput = *m_stdInRead.get();
+	si.hStdError = m_stdOutWrite.get();
+	si.hStdOutput = m_stdOutWrite.get();
+	si.hStdInput = m_stdInRead.get();
 	si.dwFlags = STARTF_USESTDHANDLES;
 
 	auto status = CreateProcessW(nullptr, const_cast<wchar_t *>(cmdline.c_str()),
@@ -39,7 +39,7 @@ ApplicationRunner::ApplicationRunner(const std::wstring &path, const std::wstrin
 	CloseHandle(pi.hThread);
 
 	m_processId = pi.dwProcessId;
-	m_process.reset(new HANDLE(pi.hProcess));
+	m_process.reset(pi.hProcess);
 }
 
 //static
@@ -67,23 +67,21 @@ bool ApplicationRunner::read(std::string &data, size_t maxChars, size_t timeout)
 	// TODO: At least reuse the thread :-(
 	//
 
-	UniqueHandle readCompletedEvent(new HANDLE(
-		CreateEventW(nullptr, TRUE, FALSE, nullptr)
-	));
+	UniqueKernelHandle readCompletedEvent(CreateEventW(nullptr, TRUE, FALSE, nullptr));
 
 	ReadThreadParameters parameters =
 	{
 		data,
 		maxChars,
-		*m_stdOutRead,
-		*readCompletedEvent
+		m_stdOutRead.get(),
+		readCompletedEvent.get()
 	};
 
-	UniqueHandle thread(new HANDLE(
-		(HANDLE)_beginthreadex(nullptr, 0, &ApplicationRunner::ReadThread, &parameters, 0, nullptr)
+	UniqueKernelHandle thread(reinterpret_cast<HANDLE>(
+		_beginthreadex(nullptr, 0, &ApplicationRunner::ReadThread, &parameters, 0, nullptr)
 	));
 
-	if (WAIT_OBJECT_0 != WaitForSingleObject(*thread, static_cast<DWORD>(timeout)))
+	if (WAIT_OBJECT_0 != WaitForSingleObject(thread.get(), static_cast<DWORD>(timeout)))
 	{
 		//
 		// Timeout reached.
@@ -97,16 +95,16 @@ bool ApplicationRunner::read(std::string &data, size_t maxChars, size_t timeout)
 
 		do
 		{
-			CancelSynchronousIo(*thread);
+			CancelSynchronousIo(thread.get());
 		}
-		while (WAIT_OBJECT_0 != WaitForSingleObject(*readCompletedEvent, 50));
+		while (WAIT_OBJECT_0 != WaitForSingleObject(readCompletedEvent.get(), 50));
 
-		WaitForSingleObject(*thread, INFINITE);
+		WaitForSingleObject(thread.get(), INFINITE);
 	}
 
 	DWORD exitCode;
 
-	if (FALSE != GetExitCodeThread(*thread, &exitCode))
+	if (FALSE != GetExitCodeThread(thread.get(), &exitCode))
 	{
 		return static_cast<bool>(exitCode);
 	}
@@ -142,19 +140,19 @@ bool ApplicationRunner::write(const std::string &data)
 {
 	DWORD bytesWritten;
 
-	auto status = WriteFile(*m_stdInWrite, data.c_str(), static_cast<DWORD>(data.size()), &bytesWritten, nullptr);
+	auto status = WriteFile(m_stdInWrite.get(), data.c_str(), static_cast<DWORD>(data.size()), &bytesWritten, nullptr);
 
 	return (FALSE != status && bytesWritten == data.size());
 }
 
 bool ApplicationRunner::join(DWORD &status, size_t timeout)
 {
-	if (WAIT_OBJECT_0 != WaitForSingleObject(*m_process, static_cast<DWORD>(timeout)))
+	if (WAIT_OBJECT_0 != WaitForSingleObject(m_process.get(), static_cast<DWORD>(timeout)))
 	{
 		return false;
 	}
 
-	if (FALSE == GetExitCodeProcess(*m_process, &status))
+	if (FALSE == GetExitCodeProcess(m_process.get(), &status))
 	{
 		THROW_WINDOWS_ERROR(GetLastError(), "Read process exit code");
 	}
@@ -188,19 +186,14 @@ void ApplicationRunner::createPipes()
 	sa.bInheritHandle = TRUE;
 	sa.lpSecurityDescriptor = nullptr;
 
-	m_stdInRead.reset(new HANDLE(INVALID_HANDLE_VALUE));
-	m_stdInWrite.reset(new HANDLE(INVALID_HANDLE_VALUE));
-	m_stdOutRead.reset(new HANDLE(INVALID_HANDLE_VALUE));
-	m_stdOutWrite.reset(new HANDLE(INVALID_HANDLE_VALUE));
-
-	if (FALSE == CreatePipe(m_stdInRead.get(), m_stdInWrite.get(), &sa, 0)
-		|| FALSE == CreatePipe(m_stdOutRead.get(), m_stdOutWrite.get(), &sa, 0))
+	if (FALSE == CreatePipe(m_stdInRead.receive(), m_stdInWrite.receive(), &sa, 0)
+		|| FALSE == CreatePipe(m_stdOutRead.receive(), m_stdOutWrite.receive(), &sa, 0))
 	{
 		THROW_WINDOWS_ERROR(GetLastError(), "Create anonymous pipe");
 	}
 
-	if (FALSE == SetHandleInformation(*m_stdInWrite, HANDLE_FLAG_INHERIT, 0)
-		|| FALSE == SetHandleInformation(*m_stdOutRead, HANDLE_FLAG_INHERIT, 0))
+	if (FALSE == SetHandleInformation(m_stdInWrite.get(), HANDLE_FLAG_INHERIT, 0)
+		|| FALSE == SetHandleInformation(m_stdOutRead.get(), HANDLE_FLAG_INHERIT, 0))
 	{
 		THROW_WINDOWS_ERROR(GetLastError(), "Disallow inheritance of pipe handle");
 	}
@@ -41,12 +41,12 @@ private:
 	static unsigned __stdcall ReadThread(void *p);
 
 	DWORD m_processId;
-	common::memory::UniqueHandle m_process;
+	common::memory::UniqueKernelHandle m_process;
 
-	common::memory::UniqueHandle m_stdInRead;
-	common::memory::UniqueHandle m_stdInWrite;
-	common::memory::UniqueHandle m_stdOutRead;
-	common::memory::UniqueHandle m_stdOutWrite;
+	common::memory::UniqueKernelHandle m_stdInRead;
+	common::memory::UniqueKernelHandle m_stdInWrite;
+	common::memory::UniqueKernelHandle m_stdOutRead;
+	common::memory::UniqueKernelHandle m_stdOutWrite;
 };
 
 }
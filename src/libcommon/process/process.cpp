@@ -1,18 +1,21 @@
 #include "stdafx.h"
 #include "process.h"
 #include "../error.h"
+#include "../expected.h"
 #include <filesystem>
+#include <optional>
 
 #define PSAPI_VERSION 2
 #include <psapi.h>
 
-namespace common::process
+namespace
 {
 
-DWORD GetProcessIdFromName(const std::wstring &processName, std::function<bool(const std::wstring &lhs, const std::wstring &rhs)> comp)
+template<typename PidVector>
+std::optional<common::Error> TryEnumerateProcesses(PidVector &pids)
 {
-	// Allocate heap storage for 512 PIDs.
-	std::vector<DWORD> pids(512);
+	// Allocate storage for 512 PIDs.
+	pids.resize(512);
 
 	const DWORD bytesAvailable = static_cast<DWORD>(pids.size()) * sizeof(DWORD);
 	DWORD bytesWritten;
@@ -21,89 +24,114 @@ DWORD GetProcessIdFromName(const std::wstring &processName, std::function<bool(c
 
 	if (FALSE == enumStatus)
 	{
-		THROW_WINDOWS_ERROR(GetLastError(), "Acquire list of PIDs in the system");
+		return MAKE_WINDOWS_ERROR(GetLastError(), "Acquire list of PIDs in the system");
 	}
 
 	size_t numberProcesses = bytesWritten / sizeof(DWORD);
 	pids.resize(numberProcesses);
 
-	for (auto process : pids)
+	return std::nullopt;
+}
+
+template<typename PidVector>
+void EnumerateProcesses(PidVector &pids)
+{
+	if (const auto error = TryEnumerateProcesses(pids); error.has_value())
 	{
-		auto processHandle = OpenProcess(PROCESS_QUERY_INFORMATION, FALSE, process);
+		common::ThrowError(*error);
+	}
+}
 
-		if (NULL == processHandle)
-		{
-			continue;
-		}
+bool ProcessNameMatches(DWORD process, const std::wstring &processName,
+	const std::function<bool(const std::wstring &lhs, const std::wstring &rhs)> &comp)
+{
+	auto processHandle = OpenProcess(PROCESS_QUERY_INFORMATION, FALSE, process);
 
-		wchar_t foundName[512];
-		DWORD foundNameSize = ARRAYSIZE(foundName);
+	if (NULL == processHandle)
+	{
+		return false;
+	}
 
-		const auto queryStatus = QueryFullProcessImageNameW(processHandle, 0, foundName, &foundNameSize);
+	wchar_t foundName[512];
+	DWORD foundNameSize = ARRAYSIZE(foundName);
 
-		CloseHandle(processHandle);
+	const auto queryStatus = QueryFullProcessImageNameW(processHandle, 0, foundName, &foundNameSize);
 
-		if (0 == queryStatus)
-		{
-			continue;
-		}
+	CloseHandle(processHandle);
 
-		if (comp(processName, foundName))
-		{
-			return process;
-		}
+	if (0 == queryStatus)
+	{
+		return false;
 	}
 
-	THROW_ERROR("Could not find named process");
+	return comp(processName, foundName);
 }
 
-std::unordered_set<DWORD> GetAllProcessIdsFromName(const std::wstring &processName,
-	std::function<bool(const std::wstring &lhs, const std::wstring &rhs)> comp)
+template<typename PidSet, typename PidVector>
+void FindAllProcessIds(const std::wstring &processName,
+	const std::function<bool(const std::wstring &lhs, const std::wstring &rhs)> &comp,
+	PidVector &pids, PidSet &result)
 {
-	std::unordered_set<DWORD> result;
+	EnumerateProcesses(pids);
 
-	// Allocate heap storage for 512 PIDs.
-	std::vector<DWORD> pids(512);
+	for (auto process : pids)
+	{
+		if (ProcessNameMatches(process, processName, comp))
+		{
+			result.insert(process);
+		}
+	}
+}
 
-	const DWORD bytesAvailable = static_cast<DWORD>(pids.size()) * sizeof(DWORD);
-	DWORD bytesWritten;
+} // anonymous namespace
 
-	const auto enumStatus = K32EnumProcesses(&pids[0], bytesAvailable, &bytesWritten);
+namespace common::process
+{
 
-	if (FALSE == enumStatus)
+DWORD GetProcessIdFromName(const std::wstring &processName, std::function<bool(const std::wstring &lhs, const std::wstring &rhs)> comp)
+{
+	return TryGetProcessIdFromName(processName, std::move(comp)).value();
+}
+
+Expected<DWORD> TryGetProcessIdFromName(const std::wstring &processName,
+	std::function<bool(const std::wstring &lhs, const std::wstring &rhs)> comp)
+{
+	std::vector<DWORD> pids;
+
+	if (const auto error = TryEnumerateProcesses(pids); error.has_value())
 	{
-		THROW_WINDOWS_ERROR(GetLastError(), "Acquire list of PIDs in the system");
+		return *error;
 	}
 
-	size_t numberProcesses = bytesWritten / sizeof(DWORD);
-	pids.resize(numberProcesses);
-
 	for (auto process : pids)
 	{
-		auto processHandle = OpenProcess(PROCESS_QUERY_INFORMATION, FALSE, process);
-
-		if (NULL == processHandle)
+		if (ProcessNameMatches(process, processName, comp))
 		{
-			continue;
+			return process;
 		}
+	}
 
-		wchar_t foundName[512];
-		DWORD foundNameSize = ARRAYSIZE(foundName);
+	return MAKE_ERROR("Could not find named process");
+}
 
-		const auto queryStatus = QueryFullProcessImageNameW(processHandle, 0, foundName, &foundNameSize);
+std::unordered_set<DWORD> GetAllProcessIdsFromName(const std::wstring &processName,
+	std::function<bool(const std::wstring &lhs, const std::wstring &rhs)> comp)
+{
+	std::unordered_set<DWORD> result;
+	std::vector<DWORD> pids;
 
-		CloseHandle(processHandle);
+	FindAllProcessIds(processName, comp, pids, result);
 
-		if (0 == queryStatus)
-		{
-			continue;
-		}
+	return result;
+}
 
-		if (comp(processName, foundName))
-		{
-			result.insert(process);
-		}
-	}
+std::pmr::unordered_set<DWORD> GetAllProcessIdsFromName(const std::wstring &processName,
+	std::pmr::memory_resource *resource, std::function<bool(const std::wstring &lhs, const std::wstring &rhs)> comp)
+{
+	std::pmr::unordered_set<DWORD> result(resource);
+	std::pmr::vector<DWORD> pids(resource);
+
+	FindAllProcessIds(processName, comp, pids, result);
 
 	return result;
 }
@@ -1,7 +1,9 @@
 #pragma once
 
+#include "../expected.h"
 #include <string>
 #include <functional>
+#include <memory_resource>
 #include <unordered_set>
 #include <wchar.h>
 #include <windows.h>
@@ -24,12 +26,24 @@ struct DefaultProcessNameComparator
 DWORD GetProcessIdFromName(const std::wstring &processName,
 	std::function<bool(const std::wstring &lhs, const std::wstring &rhs)> comp = DefaultProcessNameComparator());
 
+//
+// Non-throwing variant of `GetProcessIdFromName`, for processes that may well not be running.
+//
+Expected<DWORD> TryGetProcessIdFromName(const std::wstring &processName,
+	std::function<bool(const std::wstring &lhs, const std::wstring &rhs)> comp = DefaultProcessNameComparator());
+
 //
 // N.B this can return an empty set.
 //
 std::unordered_set<DWORD> GetAllProcessIdsFromName(const std::wstring &processName,
 	std::function<bool(const std::wstring &lhs, const std::wstring &rhs)> comp = DefaultProcessNameComparator());
 
+//
+// Allocate the result and all temporaries from `resource`.
+//
+std::pmr::unordered_set<DWORD> GetAllProcessIdsFromName(const std::wstring &processName, std::pmr::memory_resource *resource,
+	std::function<bool(const std::wstring &lhs, const std::wstring &rhs)> comp = DefaultProcessNameComparator());
+
 void Run(const std::wstring &path);
 
 void RunInContext(HANDLE securityContext, const std::wstring &path);
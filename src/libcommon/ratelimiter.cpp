@@ -0,0 +1,76 @@
+#include "stdafx.h"
+#include "ratelimiter.h"
+#include "error.h"
+#include <algorithm>
+#include <limits>
+
+namespace common
+{
+
+RateLimiter::RateLimiter(Duration interval, uint32_t burst, std::shared_ptr<IClock> clock)
+	: m_clock(std::move(clock))
+	, m_interval(interval.count())
+	, m_tolerance(interval.count() * burst)
+	, m_arrival((std::numeric_limits<int64_t>::min)())
+{
+	if (m_interval <= 0 || 0 == burst)
+	{
+		THROW_ERROR("Invalid rate limiter configuration");
+	}
+}
+
+bool RateLimiter::tryAcquire(uint32_t permits)
+{
+	const auto now = m_clock->now().count();
+	const auto increment = m_interval * permits;
+
+	auto arrival = m_arrival.load(std::memory_order_relaxed);
+
+	for (;;)
+	{
+		const auto next = (std::max)(arrival, now) + increment;
+
+		if (next - now > m_tolerance)
+		{
+			return false;
+		}
+
+		if (m_arrival.compare_exchange_weak(arrival, next, std::memory_order_acq_rel, std::memory_order_relaxed))
+		{
+			return true;
+		}
+	}
+}
+
+void RateLimiter::acquire(uint32_t permits)
+{
+	const auto increment = m_interval * permits;
+
+	if (increment > m_tolerance)
+	{
+		THROW_ERROR("Requested permits exceed burst capacity");
+	}
+
+	const auto now = m_clock->now().count();
+
+	auto arrival = m_arrival.load(std::memory_order_relaxed);
+	int64_t next;
+
+	do
+	{
+		next = (std::max)(arrival, now) + increment;
+	}
+	while (false == m_arrival.compare_exchange_weak(arrival, next, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+	//
+	// The permits are now reserved and become valid once the deadline is within tolerance.
+	//
+	const auto deadline = next - m_tolerance;
+
+	if (deadline > now)
+	{
+		m_clock->sleepUntil(Duration(deadline));
+	}
+}
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "clock.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace common
+{
+
+//
+// Lock-free rate limiter implementing the generic cell rate algorithm (GCRA),
+// which is equivalent to a token bucket.
+//
+// One permit becomes available every `interval`, and up to `burst` permits can be
+// held in reserve. The state is a single atomic timestamp, so acquiring a permit
+// is a compare-and-swap on the uncontended path.
+//
+class RateLimiter
+{
+public:
+
+	using Duration = IClock::Duration;
+
+	RateLimiter(Duration interval, uint32_t burst,
+		std::shared_ptr<IClock> clock = std::make_shared<SteadyClock>());
+
+	RateLimiter(const RateLimiter &) = delete;
+	RateLimiter &operator=(const RateLimiter &) = delete;
+	RateLimiter(RateLimiter &&) = delete;
+	RateLimiter &operator=(RateLimiter &&) = delete;
+
+	//
+	// Take `permits` permits if they are available now.
+	// Requests exceeding the burst capacity always fail.
+	//
+	bool tryAcquire(uint32_t permits = 1);
+
+	//
+	// Take `permits` permits, waiting for them to become available.
+	// Permits are reserved up front, so waiting callers are served in order.
+	//
+	void acquire(uint32_t permits = 1);
+
+	const std::shared_ptr<IClock> &clock() const
+	{
+		return m_clock;
+	}
+
+private:
+
+	std::shared_ptr<IClock> m_clock;
+
+	int64_t m_interval;
+	int64_t m_tolerance;
+
+	// Theoretical arrival time of the next permit, in clock nanoseconds.
+	std::atomic<int64_t> m_arrival;
+};
+
+}
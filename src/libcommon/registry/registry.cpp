@@ -2,6 +2,7 @@
 #include "registry.h"
 #include "registrypath.h"
 #include <libcommon/error.h>
+#include <libcommon/memory.h>
 
 namespace
 {
@@ -31,18 +32,18 @@ REGSAM CreateAccessFlags(bool writeAccess, common::registry::RegistryView view)
 
 void DefaultMoveKey(const common::registry::RegistryPath &source, const common::registry::RegistryPath &destination)
 {
-	HKEY destHandle;
+	common::memory::UniqueRegistryKey destHandle;
 
-	auto status = RegCreateKeyExW(destination.key(), destination.subkey().c_str(), 0, nullptr, 0, KEY_ALL_ACCESS, nullptr, &destHandle, nullptr);
+	auto status = RegCreateKeyExW(destination.key(), destination.subkey().c_str(), 0, nullptr, 0, KEY_ALL_ACCESS, nullptr, destHandle.receive(), nullptr);
 
 	if (ERROR_SUCCESS != status)
 	{
 		THROW_WINDOWS_ERROR(status, "Create destination key");
 	}
 
-	status = RegCopyTreeW(source.key(), source.subkey().c_str(), destHandle);
+	status = RegCopyTreeW(source.key(), source.subkey().c_str(), destHandle.get());
 
-	RegCloseKey(destHandle);
+	destHandle.reset();
 
 	if (ERROR_SUCCESS != status)
 	{
@@ -88,6 +89,12 @@ std::unique_ptr<RegistryKey> Registry::CreateKey(HKEY key, const std::wstring &s
 
 //static
 std::unique_ptr<RegistryKey> Registry::OpenKey(HKEY key, const std::wstring &subkey, bool writeAccess, RegistryView view)
+{
+	return TryOpenKey(key, subkey, writeAccess, view).value();
+}
+
+//static
+Expected<std::unique_ptr<RegistryKey>> Registry::TryOpenKey(HKEY key, const std::wstring &subkey, bool writeAccess, RegistryView view)
 {
 	const auto accessFlags = CreateAccessFlags(writeAccess, view);
 
@@ -97,7 +104,7 @@ std::unique_ptr<RegistryKey> Registry::OpenKey(HKEY key, const std::wstring &sub
 
 	if (ERROR_SUCCESS != status)
 	{
-		THROW_WINDOWS_ERROR(status, "Open registry key");
+		return MAKE_WINDOWS_ERROR(status, "Open registry key");
 	}
 
 	return std::make_unique<RegistryKey>(subkeyHandle);
@@ -147,21 +154,9 @@ void Registry::MoveKey
 
 	const REGSAM viewFlag = (RegistryView::Force32 == view ? KEY_WOW64_32KEY : KEY_WOW64_64KEY);
 
-	auto releaseHkey = [](HKEY *key)
-	{
-		if (nullptr != *key)
-		{
-			RegCloseKey(*key);
-		}
-
-		delete key;
-	};
-
-	std::unique_ptr<HKEY, decltype(releaseHkey)>
-		sourceHandle(new HKEY(nullptr), releaseHkey),
-		destinationHandle(new HKEY(nullptr), releaseHkey);
+	common::memory::UniqueRegistryKey sourceHandle, destinationHandle;
 
- 	auto status = RegOpenKeyExW(source.key(), source.subkey().c_str(), 0, KEY_ALL_ACCESS | viewFlag, sourceHandle.get());
+	auto status = RegOpenKeyExW(source.key(), source.subkey().c_str(), 0, KEY_ALL_ACCESS | viewFlag, sourceHandle.receive());
 
 	if (ERROR_SUCCESS != status)
 	{
@@ -169,21 +164,21 @@ void Registry::MoveKey
 	}
 
 	status = RegCreateKeyExW(destination.key(), destination.subkey().c_str(), 0, nullptr, 0, \
-		KEY_ALL_ACCESS | viewFlag, nullptr, destinationHandle.get(), nullptr);
+		KEY_ALL_ACCESS | viewFlag, nullptr, destinationHandle.receive(), nullptr);
 
 	if (ERROR_SUCCESS != status)
 	{
 		THROW_WINDOWS_ERROR(status, "Create destination key");
 	}
 
-	status = RegCopyTreeW(*sourceHandle, nullptr, *destinationHandle);
+	status = RegCopyTreeW(sourceHandle.get(), nullptr, destinationHandle.get());
 
 	if (ERROR_SUCCESS != status)
 	{
 		THROW_WINDOWS_ERROR(status, "Copy registry key");
 	}
 
-	status = RegDeleteTreeW(*sourceHandle, nullptr);
+	status = RegDeleteTreeW(sourceHandle.get(), nullptr);
 
 	if (ERROR_SUCCESS != status)
 	{
@@ -37,6 +37,17 @@ public:
 		RegistryView view = RegistryView::Default
 	);
 
+	//
+	// Non-throwing variant of `OpenKey`, for keys that may well be missing.
+	//
+	static Expected<std::unique_ptr<RegistryKey>> TryOpenKey
+	(
+		HKEY key,
+		const std::wstring &subkey,
+		bool writeAccess = false,
+		RegistryView view = RegistryView::Default
+	);
+
 	static void DeleteKey
 	(
 		HKEY key,
@@ -1,23 +1,66 @@
 #include "stdafx.h"
 #include "registrykey.h"
+#include <libcommon/binaryreader.h>
 #include <libcommon/error.h>
 
-namespace common::registry
+namespace
 {
 
-RegistryKey::RegistryKey(HKEY key)
-	: m_key(key)
+template<typename Buffer, typename Result>
+void ParseMultiString(const Buffer &buffer, Result &result)
 {
+	static_assert(sizeof(wchar_t) == sizeof(typename Buffer::value_type), "Buffer elements must be wide characters");
+
+	if (buffer.empty())
+	{
+		return;
+	}
+
+	auto end = reinterpret_cast<const wchar_t *>(&buffer[0]) + buffer.size();
+
+	auto valueStart = reinterpret_cast<const wchar_t *>(&buffer[0]);
+
+	for (;;)
+	{
+		if (valueStart == end)
+		{
+			break;
+		}
+
+		auto valueEnd = valueStart;
+
+		while (valueEnd != end && L'\x0' != *valueEnd)
+		{
+			++valueEnd;
+		}
+
+		if (valueEnd - valueStart > 0)
+		{
+			result.emplace_back(valueStart, valueEnd);
+		}
+
+		valueStart = valueEnd;
+
+		while (valueStart != end && L'\x0' == *valueStart)
+		{
+			++valueStart;
+		}
+	}
 }
 
-RegistryKey::~RegistryKey()
+} // anonymous namespace
+
+namespace common::registry
+{
+
+RegistryKey::RegistryKey(HKEY key)
+	: m_key(key)
 {
-	RegCloseKey(m_key);
 }
 
 void RegistryKey::flush()
 {
-	const auto status = RegFlushKey(m_key);
+	const auto status = RegFlushKey(m_key.get());
 
 	if (ERROR_SUCCESS != status)
 	{
@@ -29,7 +72,7 @@ void RegistryKey::writeValue(const std::wstring &valueName, const std::wstring &
 {
 	auto dataLength = static_cast<DWORD>((valueData.size() + 1) * sizeof(wchar_t));
 
-	const auto status = RegSetValueExW(m_key, valueName.c_str(), 0, static_cast<DWORD>(type),
+	const auto status = RegSetValueExW(m_key.get(), valueName.c_str(), 0, static_cast<DWORD>(type),
 		reinterpret_cast<const BYTE *>(valueData.c_str()), dataLength);
 
 	if (ERROR_SUCCESS != status)
@@ -40,7 +83,7 @@ void RegistryKey::writeValue(const std::wstring &valueName, const std::wstring &
 
 void RegistryKey::writeValue(const std::wstring &valueName, uint32_t valueData)
 {
-	const auto status = RegSetValueExW(m_key, valueName.c_str(), 0, REG_DWORD,
+	const auto status = RegSetValueExW(m_key.get(), valueName.c_str(), 0, REG_DWORD,
 		reinterpret_cast<const BYTE *>(&valueData), sizeof(uint32_t));
 
 	if (ERROR_SUCCESS != status)
@@ -51,7 +94,7 @@ void RegistryKey::writeValue(const std::wstring &valueName, uint32_t valueData)
 
 void RegistryKey::writeValue(const std::wstring &valueName, uint64_t valueData)
 {
-	const auto status = RegSetValueExW(m_key, valueName.c_str(), 0, REG_QWORD,
+	const auto status = RegSetValueExW(m_key.get(), valueName.c_str(), 0, REG_QWORD,
 		reinterpret_cast<const BYTE *>(&valueData), sizeof(uint64_t));
 
 	if (ERROR_SUCCESS != status)
@@ -64,7 +107,7 @@ void RegistryKey::writeValue(const std::wstring &valueName, const std::vector<ui
 {
 	auto dataLength = static_cast<DWORD>(valueData.size());
 
-	const auto status = RegSetValueExW(m_key, valueName.c_str(), 0, REG_BINARY,
+	const auto status = RegSetValueExW(m_key.get(), valueName.c_str(), 0, REG_BINARY,
 		&valueData[0], dataLength);
 
 	if (ERROR_SUCCESS != status)
@@ -104,7 +147,7 @@ void RegistryKey::writeValue(const std::wstring &valueName, const std::vector<st
 
 	auto dataLength = static_cast<DWORD>(buffer.size() * sizeof(wchar_t));
 
-	const auto status = RegSetValueExW(m_key, valueName.c_str(), 0, REG_MULTI_SZ,
+	const auto status = RegSetValueExW(m_key.get(), valueName.c_str(), 0, REG_MULTI_SZ,
 		reinterpret_cast<const BYTE *>(&buffer[0]), dataLength);
 
 	if (ERROR_SUCCESS != status)
@@ -115,7 +158,7 @@ void RegistryKey::writeValue(const std::wstring &valueName, const std::vector<st
 
 void RegistryKey::deleteValue(const std::wstring &valueName)
 {
-	const auto status = RegDeleteValueW(m_key, valueName.c_str());
+	const auto status = RegDeleteValueW(m_key.get(), valueName.c_str());
 
 	if (ERROR_SUCCESS != status)
 	{
@@ -125,14 +168,55 @@ void RegistryKey::deleteValue(const std::wstring &valueName)
 
 std::wstring RegistryKey::readString(const std::wstring &valueName, ValueStringType type) const
 {
-	auto buffer = readRaw(valueName, static_cast<DWORD>(type));
+	return tryReadString(valueName, type).value();
+}
+
+uint32_t RegistryKey::readUint32(const std::wstring &valueName) const
+{
+	return tryReadUint32(valueName).value();
+}
+
+uint64_t RegistryKey::readUint64(const std::wstring &valueName) const
+{
+	return tryReadUint64(valueName).value();
+}
+
+std::vector<uint8_t> RegistryKey::readBinaryBlob(const std::wstring &valueName) const
+{
+	return tryReadBinaryBlob(valueName).value();
+}
+
+std::vector<std::wstring> RegistryKey::readStringArray(const std::wstring &valueName) const
+{
+	return tryReadStringArray(valueName).value();
+}
+
+std::pmr::vector<std::pmr::wstring> RegistryKey::readStringArray(const std::wstring &valueName, std::pmr::memory_resource *resource) const
+{
+	std::pmr::vector<std::pmr::wstring> result(resource);
 
-	if (buffer.size() <= 1)
+	ParseMultiString(tryReadRaw(valueName, REG_MULTI_SZ, std::pmr::vector<wchar_t>(resource)).value(), result);
+
+	return result;
+}
+
+Expected<std::wstring> RegistryKey::tryReadString(const std::wstring &valueName, ValueStringType type) const
+{
+	const auto buffer = tryReadRaw(valueName, static_cast<DWORD>(type), std::vector<uint8_t>());
+
+	if (false == buffer.hasValue())
+	{
+		return buffer.error();
+	}
+
+	const auto &data = buffer.value();
+
+	if (data.size() <= 1)
 	{
 		return std::wstring();
 	}
 
-	auto begin = reinterpret_cast<const wchar_t *>(&buffer[0]);
+	auto begin = reinterpret_cast<const wchar_t *>(&data[0]);
 
 	//
 	// There could be zero, one or more null bytes at the end.
@@ -141,7 +225,7 @@ std::wstring RegistryKey::readString(const std::wstring &valueName, ValueStringT
 	// Dividing by sizeof(wchar_t) discards any odd byte at the end.
 	//
 
-	auto lastChar = begin + (buffer.size() / sizeof(wchar_t)) - 1;
+	auto lastChar = begin + (data.size() / sizeof(wchar_t)) - 1;
 
 	while (lastChar >= begin && L'\x0' == *lastChar)
 	{
@@ -156,67 +240,33 @@ std::wstring RegistryKey::readString(const std::wstring &valueName, ValueStringT
 	return std::wstring(begin, lastChar + 1);
 }
 
-uint32_t RegistryKey::readUint32(const std::wstring &valueName) const
+Expected<uint32_t> RegistryKey::tryReadUint32(const std::wstring &valueName) const
 {
-	auto buffer = readRaw(valueName, REG_DWORD);
-
-	return *reinterpret_cast<const uint32_t *>(&buffer[0]);
+	return tryReadInteger<uint32_t>(valueName, REG_DWORD);
 }
 
-uint64_t RegistryKey::readUint64(const std::wstring &valueName) const
+Expected<uint64_t> RegistryKey::tryReadUint64(const std::wstring &valueName) const
 {
-	auto buffer = readRaw(valueName, REG_QWORD);
-
-	return *reinterpret_cast<const uint64_t *>(&buffer[0]);
+	return tryReadInteger<uint64_t>(valueName, REG_QWORD);
 }
 
-std::vector<uint8_t> RegistryKey::readBinaryBlob(const std::wstring &valueName) const
+Expected<std::vector<uint8_t>> RegistryKey::tryReadBinaryBlob(const std::wstring &valueName) const
 {
-	return readRaw(valueName, REG_BINARY);
+	return tryReadRaw(valueName, REG_BINARY, std::vector<uint8_t>());
 }
 
-std::vector<std::wstring> RegistryKey::readStringArray(const std::wstring &valueName) const
+Expected<std::vector<std::wstring>> RegistryKey::tryReadStringArray(const std::wstring &valueName) const
 {
-	auto buffer = readRaw(valueName, REG_MULTI_SZ);
+	const auto buffer = tryReadRaw(valueName, REG_MULTI_SZ, std::vector<wchar_t>());
 
-	if (buffer.size() <= 1)
+	if (false == buffer.hasValue())
 	{
-		return std::vector<std::wstring>();
+		return buffer.error();
 	}
 
 	std::vector<std::wstring> result;
 
-	// Dividing by sizeof(wchar_t) discards any odd byte at the end.
-	auto end = reinterpret_cast<const wchar_t *>(&buffer[0]) + (buffer.size() / sizeof(wchar_t));
-
-	auto valueStart = reinterpret_cast<const wchar_t *>(&buffer[0]);
-
-	for (;;)
-	{
-		if (valueStart == end)
-		{
-			break;
-		}
-
-		auto valueEnd = valueStart;
-
-		while (valueEnd != end && L'\x0' != *valueEnd)
-		{
-			++valueEnd;
-		}
-
-		if (valueEnd - valueStart > 0)
-		{
-			result.emplace_back(std::wstring(valueStart, valueEnd));
-		}
-
-		valueStart = valueEnd;
-
-		while (valueStart != end && L'\x0' == *valueStart)
-		{
-			++valueStart;
-		}
-	}
+	ParseMultiString(buffer.value(), result);
 
 	return result;
 }
@@ -225,7 +275,7 @@ void RegistryKey::enumerateSubKeys(std::function<bool(const std::wstring &)> cal
 {
 	DWORD longestSubKeyName = 0;
 
-	const auto queryStatus = RegQueryInfoKeyW(m_key, nullptr, nullptr, nullptr, nullptr,
+	const auto queryStatus = RegQueryInfoKeyW(m_key.get(), nullptr, nullptr, nullptr, nullptr,
 		&longestSubKeyName, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr);
 
 	if (ERROR_SUCCESS != queryStatus)
@@ -239,7 +289,7 @@ void RegistryKey::enumerateSubKeys(std::function<bool(const std::wstring &)> cal
 	{
 		DWORD subKeyNameLength = static_cast<DWORD>(buffer.size());
 
-		const auto enumStatus = RegEnumKeyExW(m_key, subKeyIndex, &buffer[0], &subKeyNameLength, nullptr, nullptr, nullptr, nullptr);
+		const auto enumStatus = RegEnumKeyExW(m_key.get(), subKeyIndex, &buffer[0], &subKeyNameLength, nullptr, nullptr, nullptr, nullptr);
 
 		if (ERROR_NO_MORE_ITEMS == enumStatus)
 		{
@@ -274,7 +324,7 @@ void RegistryKey::enumerateValues(std::function<bool(const std::wstring &, uint3
 {
 	DWORD longestValueName = 0;
 
-	const auto queryStatus = RegQueryInfoKeyW(m_key, nullptr, nullptr, nullptr, nullptr,
+	const auto queryStatus = RegQueryInfoKeyW(m_key.get(), nullptr, nullptr, nullptr, nullptr,
 		nullptr, nullptr, nullptr, &longestValueName, nullptr, nullptr, nullptr);
 
 	if (ERROR_SUCCESS != queryStatus)
@@ -289,7 +339,7 @@ void RegistryKey::enumerateValues(std::function<bool(const std::wstring &, uint3
 		DWORD valueNameLength = static_cast<DWORD>(buffer.size());
 		DWORD valueType;
 
-		const auto enumStatus = RegEnumValueW(m_key, valueIndex, &buffer[0], &valueNameLength, nullptr, &valueType, nullptr, nullptr);
+		const auto enumStatus = RegEnumValueW(m_key.get(), valueIndex, &buffer[0], &valueNameLength, nullptr, &valueType, nullptr, nullptr);
 
 		if (ERROR_NO_MORE_ITEMS == enumStatus)
 		{
@@ -320,38 +370,69 @@ void RegistryKey::enumerateValues(std::function<bool(const std::wstring &, uint3
 	}
 }
 
-std::vector<uint8_t> RegistryKey::readRaw(const std::wstring &valueName, DWORD dataType) const
+template<typename Buffer>
+Expected<Buffer> RegistryKey::tryReadRaw(const std::wstring &valueName, DWORD dataType, Buffer buffer) const
 {
 	DWORD actualDataType;
 	DWORD dataSize = 0;
 
-	auto status = RegQueryValueExW(m_key, valueName.c_str(), nullptr, &actualDataType, nullptr, &dataSize);
+	auto status = RegQueryValueExW(m_key.get(), valueName.c_str(), nullptr, &actualDataType, nullptr, &dataSize);
 
 	if (ERROR_SUCCESS != status)
 	{
-		THROW_WINDOWS_ERROR(status, "Query for registry value data type and data length");
+		return MAKE_WINDOWS_ERROR(status, "Query for registry value data type and data length");
 	}
 
 	if (actualDataType != dataType)
 	{
-		THROW_ERROR("Unexpected registry value data type");
+		return MAKE_ERROR("Unexpected registry value data type");
 	}
 
 	if (0 == dataSize)
 	{
-		return std::vector<uint8_t>();
+		buffer.clear();
+		return buffer;
 	}
 
-	std::vector<uint8_t> buffer(dataSize);
+	//
+	// The buffer is sized in elements rather than bytes, so string data can be read into
+	// storage that is aligned for `wchar_t`.
+	//
+	using Element = typename Buffer::value_type;
 
-	status = RegQueryValueExW(m_key, valueName.c_str(), nullptr, nullptr, &buffer[0], &dataSize);
+	buffer.resize((dataSize + sizeof(Element) - 1) / sizeof(Element));
+
+	status = RegQueryValueExW(m_key.get(), valueName.c_str(), nullptr, nullptr, reinterpret_cast<BYTE *>(&buffer[0]), &dataSize);
 
 	if (ERROR_SUCCESS != status)
 	{
-		THROW_WINDOWS_ERROR(status, "Read registry value");
+		return MAKE_WINDOWS_ERROR(status, "Read registry value");
 	}
 
+	// Any trailing partial element is discarded.
+	buffer.resize(dataSize / sizeof(Element));
+
 	return buffer;
 }
 
+template<typename T>
+Expected<T> RegistryKey::tryReadInteger(const std::wstring &valueName, DWORD dataType) const
+{
+	const auto buffer = tryReadRaw(valueName, dataType, std::vector<uint8_t>());
+
+	if (false == buffer.hasValue())
+	{
+		return buffer.error();
+	}
+
+	const auto &data = buffer.value();
+
+	if (data.size() < sizeof(T))
+	{
+		return MAKE_ERROR("Registry value is too short");
+	}
+
+	return BinaryReader(ConstBufferView(data.data(), data.size())).read<T>();
+}
+
 }
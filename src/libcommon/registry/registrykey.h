@@ -1,9 +1,12 @@
 #pragma once
 
+#include "../expected.h"
+#include "../memory.h"
 #include <cstdint>
 #include <string>
 #include <vector>
 #include <functional>
+#include <memory_resource>
 #include <windows.h>
 
 namespace common::registry
@@ -14,7 +17,6 @@ class RegistryKey
 public:
 
 	RegistryKey(HKEY key);
-	~RegistryKey();
 
 	RegistryKey(const RegistryKey &rhs) = delete;
 	RegistryKey &operator=(const RegistryKey &rhs) = delete;
@@ -41,14 +43,30 @@ public:
 	std::vector<uint8_t> readBinaryBlob(const std::wstring &valueName) const;
 	std::vector<std::wstring> readStringArray(const std::wstring &valueName) const;
 
+	// Allocate the result and all temporaries from `resource`.
+	std::pmr::vector<std::pmr::wstring> readStringArray(const std::wstring &valueName, std::pmr::memory_resource *resource) const;
+
+	//
+	// Non-throwing variants of the above, for values that may well be missing.
+	//
+	Expected<std::wstring> tryReadString(const std::wstring &valueName, ValueStringType type = ValueStringType::RegularString) const;
+	Expected<uint32_t> tryReadUint32(const std::wstring &valueName) const;
+	Expected<uint64_t> tryReadUint64(const std::wstring &valueName) const;
+	Expected<std::vector<uint8_t>> tryReadBinaryBlob(const std::wstring &valueName) const;
+	Expected<std::vector<std::wstring>> tryReadStringArray(const std::wstring &valueName) const;
+
 	void enumerateSubKeys(std::function<bool(const std::wstring &keyName)> callback);
 	void enumerateValues(std::function<bool(const std::wstring &valueName, uint32_t valueType)> callback);
 
 private:
 
-	HKEY m_key;
+	common::memory::UniqueRegistryKey m_key;
+
+	template<typename Buffer>
+	Expected<Buffer> tryReadRaw(const std::wstring &valueName, DWORD dataType, Buffer buffer) const;
 
-	std::vector<uint8_t> readRaw(const std::wstring &valueName, DWORD dataType) const;
+	template<typename T>
+	Expected<T> tryReadInteger(const std::wstring &valueName, DWORD dataType) const;
 };
 
 }
@@ -0,0 +1,271 @@
+#include "stdafx.h"
+#include "ringbuffer.h"
+#include "error.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+
+//
+// The placeholder APIs are not available on all supported versions of Windows,
+// so they are resolved at runtime.
+//
+
+constexpr ULONG ReservePlaceholder = 0x00040000;	// MEM_RESERVE_PLACEHOLDER
+constexpr ULONG ReplacePlaceholder = 0x00004000;	// MEM_REPLACE_PLACEHOLDER
+constexpr ULONG PreservePlaceholder = 0x00000002;	// MEM_PRESERVE_PLACEHOLDER
+
+using VirtualAlloc2Func = PVOID (WINAPI *)(HANDLE, PVOID, SIZE_T, ULONG, ULONG, void *, ULONG);
+using MapViewOfFile3Func = PVOID (WINAPI *)(HANDLE, HANDLE, PVOID, ULONG64, SIZE_T, ULONG, ULONG, void *, ULONG);
+
+size_t RoundUpPowerTwo(size_t value)
+{
+	size_t result = 1;
+
+	while (result < value)
+	{
+		result <<= 1;
+	}
+
+	return result;
+}
+
+} // anonymous namespace
+
+namespace common
+{
+
+ByteRingBuffer::ByteRingBuffer(size_t capacity, bool mirrored)
+	: m_head(0)
+	, m_cachedTail(0)
+	, m_tail(0)
+	, m_cachedHead(0)
+	, m_data(nullptr)
+	, m_capacity(RoundUpPowerTwo(capacity))
+	, m_section(nullptr)
+{
+	if (0 == capacity)
+	{
+		THROW_ERROR("Invalid ring buffer capacity");
+	}
+
+	if (mirrored)
+	{
+		allocateMirrored();
+	}
+	else
+	{
+		allocateLinear();
+	}
+
+	m_mask = m_capacity - 1;
+}
+
+ByteRingBuffer::~ByteRingBuffer()
+{
+	if (nullptr == m_section)
+	{
+		delete[] m_data;
+		return;
+	}
+
+	UnmapViewOfFile(m_data);
+	UnmapViewOfFile(m_data + m_capacity);
+
+	CloseHandle(m_section);
+}
+
+std::span<uint8_t> ByteRingBuffer::reserve(size_t maximum)
+{
+	const auto head = m_head.load(std::memory_order_relaxed);
+
+	auto available = m_capacity - (head - m_cachedTail);
+
+	if (available < maximum)
+	{
+		m_cachedTail = m_tail.load(std::memory_order_acquire);
+		available = m_capacity - (head - m_cachedTail);
+	}
+
+	const auto offset = head & m_mask;
+
+	if (nullptr == m_section)
+	{
+		available = (std::min)(available, m_capacity - offset);
+	}
+
+	return std::span<uint8_t>(m_data + offset, (std::min)(available, maximum));
+}
+
+void ByteRingBuffer::commit(size_t bytes)
+{
+	m_head.store(m_head.load(std::memory_order_relaxed) + bytes, std::memory_order_release);
+}
+
+size_t ByteRingBuffer::write(const void *data, size_t size)
+{
+	auto source = reinterpret_cast<const uint8_t *>(data);
+	size_t written = 0;
+
+	//
+	// At most two rounds are needed when the data straddles the wrap point.
+	//
+	while (written < size)
+	{
+		const auto region = reserve(size - written);
+
+		if (region.empty())
+		{
+			break;
+		}
+
+		memcpy(region.data(), source + written, region.size());
+		commit(region.size());
+
+		written += region.size();
+	}
+
+	return written;
+}
+
+std::span<const uint8_t> ByteRingBuffer::peek()
+{
+	const auto tail = m_tail.load(std::memory_order_relaxed);
+
+	auto available = m_cachedHead - tail;
+
+	if (0 == available)
+	{
+		m_cachedHead = m_head.load(std::memory_order_acquire);
+		available = m_cachedHead - tail;
+	}
+
+	const auto offset = tail & m_mask;
+
+	if (nullptr == m_section)
+	{
+		available = (std::min)(available, m_capacity - offset);
+	}
+
+	return std::span<const uint8_t>(m_data + offset, available);
+}
+
+void ByteRingBuffer::consume(size_t bytes)
+{
+	m_tail.store(m_tail.load(std::memory_order_relaxed) + bytes, std::memory_order_release);
+}
+
+size_t ByteRingBuffer::read(void *data, size_t size)
+{
+	auto destination = reinterpret_cast<uint8_t *>(data);
+	size_t bytesRead = 0;
+
+	while (bytesRead < size)
+	{
+		const auto region = peek();
+
+		if (region.empty())
+		{
+			break;
+		}
+
+		const auto chunk = (std::min)(region.size(), size - bytesRead);
+
+		memcpy(destination + bytesRead, region.data(), chunk);
+		consume(chunk);
+
+		bytesRead += chunk;
+	}
+
+	return bytesRead;
+}
+
+void ByteRingBuffer::allocateLinear()
+{
+	m_data = new uint8_t[m_capacity];
+}
+
+void ByteRingBuffer::allocateMirrored()
+{
+	const auto kernelBase = GetModuleHandleW(L"kernelbase.dll");
+
+	const auto virtualAlloc2 = (nullptr == kernelBase ? nullptr
+		: reinterpret_cast<VirtualAlloc2Func>(GetProcAddress(kernelBase, "VirtualAlloc2")));
+
+	const auto mapViewOfFile3 = (nullptr == kernelBase ? nullptr
+		: reinterpret_cast<MapViewOfFile3Func>(GetProcAddress(kernelBase, "MapViewOfFile3")));
+
+	if (nullptr == virtualAlloc2 || nullptr == mapViewOfFile3)
+	{
+		THROW_ERROR("Mirrored ring buffer is not supported on this version of Windows");
+	}
+
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+
+	m_capacity = RoundUpPowerTwo((std::max)(m_capacity, static_cast<size_t>(systemInfo.dwAllocationGranularity)));
+
+	//
+	// Reserve twice the capacity and split the reservation into two placeholders.
+	//
+
+	auto placeholder = reinterpret_cast<uint8_t *>(virtualAlloc2(nullptr, nullptr, 2 * m_capacity,
+		MEM_RESERVE | ReservePlaceholder, PAGE_NOACCESS, nullptr, 0));
+
+	if (nullptr == placeholder)
+	{
+		THROW_WINDOWS_ERROR(GetLastError(), "Reserve address space for ring buffer");
+	}
+
+	if (FALSE == VirtualFree(placeholder, m_capacity, MEM_RELEASE | PreservePlaceholder))
+	{
+		const auto error = GetLastError();
+		VirtualFree(placeholder, 0, MEM_RELEASE);
+
+		THROW_WINDOWS_ERROR(error, "Split ring buffer address space");
+	}
+
+	const auto section = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+		static_cast<DWORD>(static_cast<uint64_t>(m_capacity) >> 32), static_cast<DWORD>(m_capacity), nullptr);
+
+	if (nullptr == section)
+	{
+		const auto error = GetLastError();
+
+		VirtualFree(placeholder, 0, MEM_RELEASE);
+		VirtualFree(placeholder + m_capacity, 0, MEM_RELEASE);
+
+		THROW_WINDOWS_ERROR(error, "Create ring buffer section");
+	}
+
+	auto lower = mapViewOfFile3(section, nullptr, placeholder, 0, m_capacity,
+		ReplacePlaceholder, PAGE_READWRITE, nullptr, 0);
+
+	auto upper = (nullptr == lower ? nullptr : mapViewOfFile3(section, nullptr, placeholder + m_capacity, 0,
+		m_capacity, ReplacePlaceholder, PAGE_READWRITE, nullptr, 0));
+
+	if (nullptr == upper)
+	{
+		const auto error = GetLastError();
+
+		if (nullptr != lower)
+		{
+			UnmapViewOfFile(lower);
+		}
+		else
+		{
+			VirtualFree(placeholder, 0, MEM_RELEASE);
+		}
+
+		VirtualFree(placeholder + m_capacity, 0, MEM_RELEASE);
+		CloseHandle(section);
+
+		THROW_WINDOWS_ERROR(error, "Map ring buffer views");
+	}
+
+	m_data = placeholder;
+	m_section = section;
+}
+
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+namespace common
+{
+
+//
+// C4324: Structure was padded due to alignment specifier. This is intended.
+//
+#pragma warning(push)
+#pragma warning(disable: 4324)
+
+//
+// Lock-free single-producer/single-consumer byte ring.
+//
+// The producer obtains contiguous free space with `reserve()`, fills it and publishes
+// it with `commit()`. The consumer obtains contiguous data with `peek()` and releases
+// it with `consume()`. `write()` and `read()` wrap these for callers that copy.
+//
+// Exactly one thread may act as producer and one thread as consumer at any time.
+//
+// The capacity is rounded up to a power of two.
+//
+// With a mirrored mapping, the storage is mapped twice back to back in virtual memory
+// so every reserved or peeked region is contiguous, even across the wrap point. The
+// capacity is then also rounded up to the system allocation granularity. This requires
+// Windows 10 version 1803 or later.
+//
+class ByteRingBuffer
+{
+public:
+
+	static constexpr size_t CacheLineSize = 64;
+
+	ByteRingBuffer(size_t capacity, bool mirrored = false);
+	~ByteRingBuffer();
+
+	ByteRingBuffer(const ByteRingBuffer &) = delete;
+	ByteRingBuffer &operator=(const ByteRingBuffer &) = delete;
+	ByteRingBuffer(ByteRingBuffer &&) = delete;
+	ByteRingBuffer &operator=(ByteRingBuffer &&) = delete;
+
+	size_t capacity() const
+	{
+		return m_capacity;
+	}
+
+	bool mirrored() const
+	{
+		return nullptr != m_section;
+	}
+
+	//
+	// Producer interface.
+	//
+
+	// Returns contiguous free space of at most `maximum` bytes, possibly empty.
+	std::span<uint8_t> reserve(size_t maximum = std::numeric_limits<size_t>::max());
+
+	// Publish `bytes` bytes of the region returned by the preceding `reserve()`.
+	void commit(size_t bytes);
+
+	// Copy as much as fits, returns the number of bytes written.
+	size_t write(const void *data, size_t size);
+
+	//
+	// Consumer interface.
+	//
+
+	// Returns contiguous readable data, possibly empty.
+	std::span<const uint8_t> peek();
+
+	// Release `bytes` bytes of the region returned by the preceding `peek()`.
+	void consume(size_t bytes);
+
+	// Copy out as much as is available up to `size` bytes, returns the number of bytes read.
+	size_t read(void *data, size_t size);
+
+	//
+	// Whether a region returned by `reserve()` or `peek()` ends at the wrap point,
+	// so the ring continues at the start of the storage. Never the case for mirrored
+	// mappings.
+	//
+	bool endsAtWrapPoint(std::span<const uint8_t> region) const
+	{
+		return nullptr == m_section && region.data() + region.size() == m_data + m_capacity;
+	}
+
+private:
+
+	void allocateLinear();
+	void allocateMirrored();
+
+	//
+	// Positions increase monotonically and are reduced modulo the capacity on access.
+	// Each side keeps a cached copy of the other side's position so the shared cache
+	// line is only touched when the cached value runs out.
+	//
+
+	alignas(CacheLineSize) std::atomic<size_t> m_head;
+	size_t m_cachedTail;
+
+	alignas(CacheLineSize) std::atomic<size_t> m_tail;
+	size_t m_cachedHead;
+
+	alignas(CacheLineSize) uint8_t *m_data;
+	size_t m_capacity;
+	size_t m_mask;
+
+	// Only used for mirrored mappings.
+	void *m_section;
+};
+
+#pragma warning(pop)
+
+}
@@ -5,6 +5,7 @@
 #include <vector>
 
 using UniqueHandle = common::memory::UniqueHandle;
+using UniqueKernelHandle = common::memory::UniqueKernelHandle;
 
 namespace common::security
 {
@@ -40,35 +41,23 @@ void AdjustTokenPrivilege(HANDLE token, const std::wstring &privilege, bool enab
 
 void AdjustCurrentProcessTokenPrivilege(const std::wstring &privilege, bool enable)
 {
-	auto processHandle = OpenProcess(PROCESS_QUERY_INFORMATION, FALSE, GetCurrentProcessId());
+	UniqueKernelHandle processHandle(OpenProcess(PROCESS_QUERY_INFORMATION, FALSE, GetCurrentProcessId()));
 
-	if (nullptr == processHandle)
+	if (!processHandle)
 	{
 		THROW_WINDOWS_ERROR(GetLastError(), "Open handle to own process");
 	}
 
-	common::memory::ScopeDestructor sd;
+	UniqueKernelHandle processToken;
 
-	sd += [&processHandle]()
-	{
-		CloseHandle(processHandle);
-	};
-
-	HANDLE processToken;
-
-	const auto status = OpenProcessToken(processHandle, TOKEN_ADJUST_PRIVILEGES, &processToken);
+	const auto status = OpenProcessToken(processHandle.get(), TOKEN_ADJUST_PRIVILEGES, processToken.receive());
 
 	if (FALSE == status)
 	{
 		THROW_WINDOWS_ERROR(GetLastError(), "Acquire access token for own process");
 	}
 
-	sd += [&processToken]()
-	{
-		CloseHandle(processToken);
-	};
-
-	AdjustTokenPrivilege(processToken, privilege, enable);
+	AdjustTokenPrivilege(processToken.get(), privilege, enable);
 }
 
 void AddAdminToObjectDacl(const std::wstring &objectName, SE_OBJECT_TYPE objectType)
@@ -86,7 +75,7 @@ void AddAdminToObjectDacl(const std::wstring &objectName, SE_OBJECT_TYPE objectT
 	}
 
 	PACL currentAcl;
-	PSECURITY_DESCRIPTOR securityDescriptor;
+	common::memory::UniqueLocalMemory<PSECURITY_DESCRIPTOR> securityDescriptor;
 
 	const auto getSecurityStatus = GetNamedSecurityInfoW
 	(
@@ -97,7 +86,7 @@ void AddAdminToObjectDacl(const std::wstring &objectName, SE_OBJECT_TYPE objectT
 		nullptr,
 		&currentAcl,
 		nullptr,
-		&securityDescriptor
+		securityDescriptor.receive()
 	);
 
 	if (ERROR_SUCCESS != getSecurityStatus)
@@ -105,13 +94,6 @@ void AddAdminToObjectDacl(const std::wstring &objectName, SE_OBJECT_TYPE objectT
 		THROW_WINDOWS_ERROR(getSecurityStatus, "Retrieve DACL for object");
 	}
 
-	common::memory::ScopeDestructor sd;
-
-	sd += [&securityDescriptor]()
-	{
-		LocalFree(reinterpret_cast<HLOCAL>(securityDescriptor));
-	};
-
 	EXPLICIT_ACCESSW ea = { 0 };
 
 	ea.grfAccessPermissions = GENERIC_ALL;
@@ -121,20 +103,15 @@ void AddAdminToObjectDacl(const std::wstring &objectName, SE_OBJECT_TYPE objectT
 	ea.Trustee.TrusteeType = TRUSTEE_IS_WELL_KNOWN_GROUP;
 	ea.Trustee.ptstrName = reinterpret_cast<LPWSTR>(adminSid);
 
-	PACL updatedAcl;
+	common::memory::UniqueLocalMemory<PACL> updatedAcl;
 
-	const auto setEntriesStatus = SetEntriesInAclW(1, &ea, currentAcl, &updatedAcl);
+	const auto setEntriesStatus = SetEntriesInAclW(1, &ea, currentAcl, updatedAcl.receive());
 
 	if (ERROR_SUCCESS != setEntriesStatus)
 	{
 		THROW_WINDOWS_ERROR(setEntriesStatus, "Create updated DACL");
 	}
 
-	sd += [&updatedAcl]()
-	{
-		LocalFree(reinterpret_cast<HLOCAL>(updatedAcl));
-	};
-
 	const auto setSecurityStatus = SetNamedSecurityInfoW
 	(
 		const_cast<LPWSTR>(objectName.c_str()),
@@ -142,7 +119,7 @@ void AddAdminToObjectDacl(const std::wstring &objectName, SE_OBJECT_TYPE objectT
 		DACL_SECURITY_INFORMATION,
 		nullptr,
 		nullptr,
-		updatedAcl,
+		updatedAcl.get(),
 		nullptr
 	);
 
@@ -154,32 +131,32 @@ void AddAdminToObjectDacl(const std::wstring &objectName, SE_OBJECT_TYPE objectT
 
 UniqueHandle DuplicateSecurityContext(DWORD processId)
 {
-	auto processHandle = OpenProcess(PROCESS_QUERY_INFORMATION, FALSE, processId);
+	UniqueKernelHandle processHandle(OpenProcess(PROCESS_QUERY_INFORMATION, FALSE, processId));
 
-	if (nullptr == processHandle)
+	if (!processHandle)
 	{
 		THROW_WINDOWS_ERROR(GetLastError(), "Open process");
 	}
 
-	HANDLE processToken;
+	UniqueKernelHandle processToken;
 
-	auto status = OpenProcessToken(processHandle, TOKEN_READ | TOKEN_DUPLICATE, &processToken);
+	auto status = OpenProcessToken(processHandle.get(), TOKEN_READ | TOKEN_DUPLICATE, processToken.receive());
 
 	if (0 == status)
 	{
 		THROW_WINDOWS_ERROR(GetLastError(), "Open process token");
 	}
 
-	HANDLE duplicatedToken;
+	UniqueKernelHandle duplicatedToken;
 
-	status = DuplicateTokenEx(processToken, MAXIMUM_ALLOWED, nullptr, SecurityImpersonation, TokenPrimary, &duplicatedToken);
+	status = DuplicateTokenEx(processToken.get(), MAXIMUM_ALLOWED, nullptr, SecurityImpersonation, TokenPrimary, duplicatedToken.receive());
 
 	if (FALSE == status)
 	{
 		THROW_WINDOWS_ERROR(GetLastError(), "Duplicate token");
 	}
 
-	return UniqueHandle(new HANDLE(duplicatedToken));
+	return UniqueHandle(new HANDLE(duplicatedToken.release()));
 }
 
 }
@@ -0,0 +1,127 @@
+#include "stdafx.h"
+#include "stacktrace.h"
+#include "error.h"
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <dbghelp.h>
+
+namespace
+{
+
+//
+// DbgHelp is single threaded, all calls have to be serialized.
+//
+std::mutex DbgHelpMutex;
+
+//
+// Must be called with `DbgHelpMutex` held.
+//
+bool InitializeSymbols()
+{
+	static bool attempted = false;
+	static bool initialized = false;
+
+	if (false == attempted)
+	{
+		attempted = true;
+
+		SymSetOptions(SymGetOptions() | SYMOPT_UNDNAME | SYMOPT_DEFERRED_LOADS | SYMOPT_LOAD_LINES);
+
+		initialized = (FALSE != SymInitialize(GetCurrentProcess(), nullptr, TRUE));
+	}
+
+	return initialized;
+}
+
+std::string FormatAddress(const void *address)
+{
+	char formatted[32];
+
+	std::snprintf(formatted, sizeof(formatted), "0x%p", address);
+
+	return formatted;
+}
+
+std::string SymbolizeFrame(HANDLE process, const void *address)
+{
+	const auto address64 = reinterpret_cast<DWORD64>(address);
+
+	alignas(SYMBOL_INFO) char symbolBuffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME];
+
+	auto symbol = reinterpret_cast<SYMBOL_INFO *>(symbolBuffer);
+
+	memset(symbol, 0, sizeof(SYMBOL_INFO));
+
+	symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+	symbol->MaxNameLen = MAX_SYM_NAME;
+
+	DWORD64 symbolDisplacement = 0;
+
+	if (FALSE == SymFromAddr(process, address64, &symbolDisplacement, symbol))
+	{
+		return FormatAddress(address);
+	}
+
+	std::stringstream ss;
+
+	ss << symbol->Name << "+0x" << std::hex << symbolDisplacement << std::dec;
+
+	IMAGEHLP_LINE64 line = { sizeof(IMAGEHLP_LINE64) };
+	DWORD lineDisplacement = 0;
+
+	if (FALSE != SymGetLineFromAddr64(process, address64, &lineDisplacement, &line))
+	{
+		ss << " (" << common::error::IsolateFilename(line.FileName) << ": " << line.LineNumber << ")";
+	}
+
+	return ss.str();
+}
+
+} // anonymous namespace
+
+namespace common
+{
+
+StackTrace::StackTrace()
+	: m_frames{}
+	, m_size(0)
+{
+}
+
+//static
+StackTrace StackTrace::Capture(size_t skipFrames)
+{
+	StackTrace trace;
+
+	//
+	// Skip this function in addition to the frames requested by the caller.
+	//
+	trace.m_size = CaptureStackBackTrace(static_cast<DWORD>(skipFrames + 1),
+		static_cast<DWORD>(MaximumFrames), trace.m_frames.data(), nullptr);
+
+	return trace;
+}
+
+std::vector<std::string> StackTrace::symbolize() const
+{
+	std::vector<std::string> frames;
+
+	frames.reserve(m_size);
+
+	std::scoped_lock<std::mutex> lock(DbgHelpMutex);
+
+	const auto process = GetCurrentProcess();
+	const auto initialized = InitializeSymbols();
+
+	for (size_t index = 0; index < m_size; ++index)
+	{
+		frames.push_back(initialized
+			? SymbolizeFrame(process, m_frames[index])
+			: FormatAddress(m_frames[index]));
+	}
+
+	return frames;
+}
+
+}
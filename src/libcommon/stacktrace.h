@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace common
+{
+
+//
+// Return addresses of a call stack.
+//
+// Capturing only walks the stack into a fixed array, so it's cheap enough to do
+// on every throw. Resolving addresses to symbols is expensive and is deferred
+// until the trace is formatted.
+//
+class StackTrace
+{
+public:
+
+	static constexpr size_t MaximumFrames = 32;
+
+	//
+	// Capture the calling thread's stack, starting with the caller of `Capture`,
+	// after skipping another `skipFrames` frames.
+	//
+	static StackTrace Capture(size_t skipFrames = 0);
+
+	size_t size() const
+	{
+		return m_size;
+	}
+
+	const void *frame(size_t index) const
+	{
+		return m_frames[index];
+	}
+
+	//
+	// Resolve each frame to "symbol+offset (file: line)", as far as debug information allows.
+	//
+	std::vector<std::string> symbolize() const;
+
+private:
+
+	StackTrace();
+
+	std::array<void *, MaximumFrames> m_frames;
+	size_t m_size;
+};
+
+}
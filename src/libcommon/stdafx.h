@@ -18,5 +18,6 @@
 #include <string>
 #include <vector>
 
+#pragma comment(lib, "dbghelp.lib")
 #pragma comment(lib, "rpcrt4.lib")
 #pragma comment(lib, "ws2_32.lib")
@@ -11,6 +11,7 @@
 #include <memory>
 #include <sddl.h>
 #include <sstream>
+#include <string_view>
 #include <wchar.h>
 
 namespace {
@@ -68,44 +69,84 @@ std::vector<uint8_t> ToMultiByte(const std::wstring &str, UINT codePage, bool th
 	return buffer;
 }
 
+template<typename Allocator>
+auto TokenizeImpl(const std::wstring &str, const std::wstring &delimiters, const Allocator &allocator)
+{
+	using StringAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<wchar_t>;
+	using String = std::basic_string<wchar_t, std::char_traits<wchar_t>, StringAllocator>;
+	using VectorAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<String>;
+
+	//
+	// Tokenization is destructive so operate on a copy.
+	//
+	String buffer(str.begin(), str.end(), StringAllocator(allocator));
+
+	std::vector<String, VectorAllocator> tokens(VectorAllocator{ allocator });
+
+	wchar_t *context = nullptr;
+
+	auto token = wcstok_s(&buffer[0], delimiters.c_str(), &context);
+
+	while (token != nullptr)
+	{
+		tokens.emplace_back(token);
+		token = wcstok_s(nullptr, delimiters.c_str(), &context);
+	}
+
+	return tokens;
+}
+
+template<typename Input, typename Output>
+void SplitKeyValuePairsImpl(const Input &serializedPairs, Output &result)
+{
+	for (const auto &pair : serializedPairs)
+	{
+		const std::wstring_view view(pair);
+
+		auto index = view.find(L'=');
+
+		if (index == std::wstring_view::npos)
+		{
+			// Insert key with empty value.
+			result.emplace(view, std::wstring_view());
+		}
+		else
+		{
+			result.emplace(view.substr(0, index), view.substr(index + 1));
+		}
+	}
+}
+
 } // anonymous namespace
 
 namespace common::string {
 
 std::wstring FormatGuid(const GUID &guid)
 {
-	LPOLESTR buffer;
+	common::memory::UniqueCoTaskMemory<LPOLESTR> buffer;
 
-	auto status = StringFromCLSID(guid, &buffer);
+	auto status = StringFromCLSID(guid, buffer.receive());
 
 	if (status != S_OK)
 	{
 		THROW_ERROR("Failed to format GUID");
 	}
 
-	std::wstring formatted(buffer);
-
-	CoTaskMemFree(buffer);
-
-	return formatted;
+	return std::wstring(buffer.get());
 }
 
 std::wstring FormatSid(const SID &sid)
 {
-	LPWSTR buffer;
+	common::memory::UniqueLocalMemory<LPWSTR> buffer;
 
-	auto status = ConvertSidToStringSidW(const_cast<SID *>(&sid), &buffer);
+	auto status = ConvertSidToStringSidW(const_cast<SID *>(&sid), buffer.receive());
 
 	if (0 == status)
 	{
 		THROW_ERROR("Failed to format SID");
 	}
 
-	std::wstring formatted(buffer);
-
-	LocalFree((HLOCAL)buffer);
-
-	return formatted;
+	return std::wstring(buffer.get());
 }
 
 std::wstring Join(const std::vector<std::wstring> &parts, const std::wstring &delimiter)
@@ -229,24 +270,13 @@ std::wstring Lower(const std::wstring &str)
 
 std::vector<std::wstring> Tokenize(const std::wstring &str, const std::wstring &delimiters)
 {
-	auto bufferSize = str.size() + 1;
-
-	auto buffer = std::make_unique<wchar_t[]>(bufferSize);
-	wcscpy_s(buffer.get(), bufferSize, str.c_str());
-
-	wchar_t *context = nullptr;
-
-	auto token = wcstok_s(buffer.get(), delimiters.c_str(), &context);
-
-	std::vector<std::wstring> tokens;
-
-	while (token != nullptr)
-	{
-		tokens.push_back(token);
-		token = wcstok_s(nullptr, delimiters.c_str(), &context);
-	}
+	return TokenizeImpl(str, delimiters, std::allocator<wchar_t>());
+}
 
-	return tokens;
+std::pmr::vector<std::pmr::wstring> Tokenize(const std::wstring &str, const std::wstring &delimiters,
+	std::pmr::memory_resource *resource)
+{
+	return TokenizeImpl(str, delimiters, std::pmr::polymorphic_allocator<wchar_t>(resource));
 }
 
 std::vector<uint8_t> ToUtf8(const std::wstring &str, bool throwOnError)
@@ -331,23 +361,17 @@ KeyValuePairs SplitKeyValuePairs(const std::vector<std::wstring> &serializedPair
 {
 	KeyValuePairs result;
 
-	for (const auto &pair : serializedPairs)
-	{
-		auto index = pair.find(L'=');
+	SplitKeyValuePairsImpl(serializedPairs, result);
 
-		if (index == std::wstring::npos)
-		{
-			// Insert key with empty value.
-			result.insert(std::make_pair(pair, L""));
-		}
-		else
-		{
-			result.insert(std::make_pair(
-				pair.substr(0, index),
-				pair.substr(index + 1)
-			));
-		}
-	}
+	return result;
+}
+
+PmrKeyValuePairs SplitKeyValuePairs(const std::pmr::vector<std::pmr::wstring> &serializedPairs,
+	std::pmr::memory_resource *resource)
+{
+	PmrKeyValuePairs result(resource);
+
+	SplitKeyValuePairsImpl(serializedPairs, result);
 
 	return result;
 }
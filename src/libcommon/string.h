@@ -3,6 +3,7 @@
 #include <objbase.h>
 #include <windows.h>
 #include <algorithm>
+#include <memory_resource>
 #include <sstream>
 #include <string>
 #include <unordered_map>
@@ -79,6 +80,11 @@ bool BeginsWith(const std::basic_string<T> &hay, const std::basic_string<T> &nee
 
 std::wstring Lower(const std::wstring &str);
 std::vector<std::wstring> Tokenize(const std::wstring &str, const std::wstring &delimiters);
+
+// Allocate the tokens and all temporaries from `resource`.
+std::pmr::vector<std::pmr::wstring> Tokenize(const std::wstring &str, const std::wstring &delimiters,
+	std::pmr::memory_resource *resource);
+
 std::vector<uint8_t> ToUtf8(const std::wstring &str, bool throwOnError = false);
 std::string ToAnsi(const std::wstring &str, bool throwOnError = false);
 std::wstring ToWide(const std::string &str, bool throwOnError = false);
@@ -89,6 +95,11 @@ typedef std::unordered_map<std::wstring, std::wstring> KeyValuePairs;
 
 KeyValuePairs SplitKeyValuePairs(const std::vector<std::wstring> &serializedPairs);
 
+typedef std::pmr::unordered_map<std::pmr::wstring, std::pmr::wstring> PmrKeyValuePairs;
+
+PmrKeyValuePairs SplitKeyValuePairs(const std::pmr::vector<std::pmr::wstring> &serializedPairs,
+	std::pmr::memory_resource *resource);
+
 extern const char *TrimChars;
 extern const wchar_t *WideTrimChars;
 
@@ -0,0 +1,352 @@
+#include "stdafx.h"
+#include "timerwheel.h"
+#include <limits>
+
+namespace common
+{
+
+TimerWheel::TimerWheel(Duration resolution)
+	: TimerWheel(std::make_shared<SteadyClock>(), Drive::Thread, resolution)
+{
+}
+
+TimerWheel::TimerWheel(std::shared_ptr<IClock> clock, Drive drive, Duration resolution)
+	: m_clock(std::move(clock))
+	, m_resolution(resolution)
+	, m_epoch(m_clock->now())
+	, m_armed(0)
+	, m_currentTick(0)
+	, m_wakeTick(std::numeric_limits<uint64_t>::max())
+	, m_running(nullptr)
+	, m_exiting(false)
+{
+	if (m_resolution.count() <= 0)
+	{
+		m_resolution = Duration(1);
+	}
+
+	for (auto &level : m_slots)
+	{
+		for (auto &slot : level)
+		{
+			slot.prev = slot.next = &slot;
+		}
+	}
+
+	m_expired.prev = m_expired.next = &m_expired;
+
+	if (Drive::Thread == drive)
+	{
+		m_thread = std::thread(&TimerWheel::thread, this);
+	}
+}
+
+TimerWheel::~TimerWheel()
+{
+	{
+		std::scoped_lock<std::mutex> lock(m_mutex);
+
+		m_exiting = true;
+		m_wake.notify_one();
+	}
+
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+}
+
+TimerWheel::Timer::Timer(TimerWheel &wheel, Callback callback)
+	: m_wheel(wheel)
+	, m_callback(std::move(callback))
+	, m_expiry(0)
+	, m_linked(false)
+{
+	prev = next = this;
+}
+
+TimerWheel::Timer::~Timer()
+{
+	std::unique_lock<std::mutex> lock(m_wheel.m_mutex);
+
+	if (m_linked)
+	{
+		m_wheel.remove(this);
+	}
+
+	if (this != m_wheel.m_running
+		|| std::this_thread::get_id() == m_wheel.m_runningThread)
+	{
+		return;
+	}
+
+	m_wheel.m_idle.wait(lock, [this]()
+	{
+		return this != m_wheel.m_running;
+	});
+}
+
+void TimerWheel::Timer::arm(Duration delay)
+{
+	std::scoped_lock<std::mutex> lock(m_wheel.m_mutex);
+
+	if (m_linked)
+	{
+		m_wheel.remove(this);
+	}
+
+	//
+	// Expire on the first tick boundary at or after the deadline.
+	// The deadline is relative to the current time rather than the last processed tick,
+	// as the wheel may be lagging behind while dispatching callbacks.
+	//
+	const auto deadline = m_wheel.m_clock->now() - m_wheel.m_epoch + (std::max)(delay, Duration(0));
+	const IClock::Duration resolution = m_wheel.m_resolution;
+
+	m_expiry = static_cast<uint64_t>((deadline + resolution - IClock::Duration(1)) / resolution);
+
+	m_wheel.insert(this);
+
+	if (m_expiry < m_wheel.m_wakeTick)
+	{
+		m_wheel.m_wake.notify_one();
+	}
+}
+
+bool TimerWheel::Timer::cancel()
+{
+	std::scoped_lock<std::mutex> lock(m_wheel.m_mutex);
+
+	if (false == m_linked)
+	{
+		return false;
+	}
+
+	m_wheel.remove(this);
+
+	return true;
+}
+
+bool TimerWheel::Timer::armed() const
+{
+	std::scoped_lock<std::mutex> lock(m_wheel.m_mutex);
+
+	return m_linked;
+}
+
+//static
+void TimerWheel::Unlink(Link *link)
+{
+	link->prev->next = link->next;
+	link->next->prev = link->prev;
+
+	link->prev = link->next = link;
+}
+
+//static
+void TimerWheel::Append(Link *list, Link *link)
+{
+	link->prev = list->prev;
+	link->next = list;
+
+	list->prev->next = link;
+	list->prev = link;
+}
+
+void TimerWheel::poll()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	advance(elapsedTicks());
+	dispatchExpired(lock);
+}
+
+std::optional<IClock::Duration> TimerWheel::nextExpiry()
+{
+	std::scoped_lock<std::mutex> lock(m_mutex);
+
+	const auto tick = nextWakeTick();
+
+	if (std::numeric_limits<uint64_t>::max() == tick)
+	{
+		return std::nullopt;
+	}
+
+	return m_epoch + m_resolution * static_cast<Duration::rep>(tick);
+}
+
+uint64_t TimerWheel::elapsedTicks() const
+{
+	return static_cast<uint64_t>((m_clock->now() - m_epoch) / m_resolution);
+}
+
+void TimerWheel::insert(Timer *timer)
+{
+	//
+	// Select the innermost level that can represent the distance to the expiry.
+	// Expired timers are placed in the slot of the current tick.
+	//
+
+	auto expiry = (std::max)(timer->m_expiry, m_currentTick);
+	const auto delta = (std::min)(expiry - m_currentTick, MaximumDelta);
+
+	expiry = m_currentTick + delta;
+
+	size_t level = 0;
+
+	while (level < Levels - 1 && delta >= (uint64_t(1) << (LevelBits * (level + 1))))
+	{
+		++level;
+	}
+
+	const auto slot = (expiry >> (LevelBits * level)) & SlotMask;
+
+	Append(&m_slots[level][slot], timer);
+
+	timer->m_linked = true;
+	++m_armed;
+}
+
+void TimerWheel::remove(Timer *timer)
+{
+	Unlink(timer);
+
+	timer->m_linked = false;
+	--m_armed;
+}
+
+void TimerWheel::cascade(size_t level)
+{
+	//
+	// Redistribute the slot that has come into range onto the inner levels.
+	//
+
+	const auto slot = (m_currentTick >> (LevelBits * level)) & SlotMask;
+	auto &list = m_slots[level][slot];
+
+	while (list.next != &list)
+	{
+		auto timer = static_cast<Timer *>(list.next);
+
+		remove(timer);
+		insert(timer);
+	}
+}
+
+void TimerWheel::advance(uint64_t target)
+{
+	if (0 == m_armed)
+	{
+		m_currentTick = (std::max)(m_currentTick, target + 1);
+		return;
+	}
+
+	for (; m_currentTick <= target; ++m_currentTick)
+	{
+		for (size_t level = 1; level < Levels; ++level)
+		{
+			if (0 != ((m_currentTick >> (LevelBits * (level - 1))) & SlotMask))
+			{
+				break;
+			}
+
+			cascade(level);
+		}
+
+		auto &list = m_slots[0][m_currentTick & SlotMask];
+
+		while (list.next != &list)
+		{
+			auto timer = static_cast<Timer *>(list.next);
+
+			Unlink(timer);
+			Append(&m_expired, timer);
+		}
+	}
+}
+
+uint64_t TimerWheel::nextWakeTick() const
+{
+	if (0 == m_armed)
+	{
+		return std::numeric_limits<uint64_t>::max();
+	}
+
+	//
+	// Scan the innermost level for the next expiry.
+	// Otherwise wake up when the next outer slot must be cascaded.
+	//
+
+	auto tick = m_currentTick;
+
+	do
+	{
+		const auto &list = m_slots[0][tick & SlotMask];
+
+		if (list.next != &list)
+		{
+			return tick;
+		}
+	}
+	while (0 != (++tick & SlotMask));
+
+	return tick;
+}
+
+void TimerWheel::dispatchExpired(std::unique_lock<std::mutex> &lock)
+{
+	while (m_expired.next != &m_expired)
+	{
+		auto timer = static_cast<Timer *>(m_expired.next);
+
+		remove(timer);
+
+		m_running = timer;
+		m_runningThread = std::this_thread::get_id();
+
+		lock.unlock();
+		timer->m_callback();
+		lock.lock();
+
+		m_running = nullptr;
+		m_runningThread = std::thread::id();
+
+		m_idle.notify_all();
+	}
+}
+
+void TimerWheel::thread()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (false == m_exiting)
+	{
+		advance(elapsedTicks());
+		dispatchExpired(lock);
+
+		//
+		// Callbacks may have taken a while, catch up before sleeping.
+		//
+		if (elapsedTicks() >= m_currentTick)
+		{
+			continue;
+		}
+
+		m_wakeTick = nextWakeTick();
+
+		if (std::numeric_limits<uint64_t>::max() == m_wakeTick)
+		{
+			m_wake.wait(lock);
+		}
+		else
+		{
+			const auto deadline = m_epoch + m_resolution * static_cast<Duration::rep>(m_wakeTick);
+
+			m_wake.wait_for(lock, deadline - m_clock->now());
+		}
+
+		m_wakeTick = std::numeric_limits<uint64_t>::max();
+	}
+}
+
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+#include "clock.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace common
+{
+
+//
+// Hierarchical timer wheel driven by a single thread.
+//
+// Any number of timers can share one wheel, which keeps the cost of idle timers
+// to a few pointers each rather than a thread each. Arming and cancelling a timer
+// is O(1) regardless of how many timers are registered.
+//
+// Timer callbacks run on the wheel thread, one at a time, without any wheel lock held.
+// A slow callback therefore delays other timers on the same wheel.
+//
+// A wheel can instead be driven manually by calling `poll()`, in which case callbacks
+// run on the polling thread. Combined with a virtual clock this makes timing
+// behaviour testable without waiting in real time.
+//
+// Only standard library primitives are used.
+//
+class TimerWheel
+{
+	struct Link
+	{
+		Link *prev;
+		Link *next;
+	};
+
+public:
+
+	using Duration = std::chrono::milliseconds;
+	using Callback = std::function<void()>;
+
+	enum class Drive
+	{
+		// A thread owned by the wheel waits for and dispatches expiries.
+		// Waits are performed in real time, so the clock should advance in real time.
+		Thread,
+
+		// Expiries are dispatched by `poll()`.
+		Manual,
+	};
+
+	//
+	// `resolution` is the duration of a single tick.
+	// Expiry times are rounded up to whole ticks.
+	//
+	explicit TimerWheel(Duration resolution = Duration(1));
+	TimerWheel(std::shared_ptr<IClock> clock, Drive drive, Duration resolution = Duration(1));
+	~TimerWheel();
+
+	TimerWheel(const TimerWheel &) = delete;
+	TimerWheel &operator=(const TimerWheel &) = delete;
+	TimerWheel(TimerWheel &&) = delete;
+	TimerWheel &operator=(TimerWheel &&) = delete;
+
+	//
+	// A timer registered with a wheel.
+	//
+	// The wheel must outlive all of its timers.
+	//
+	class Timer : private Link
+	{
+	public:
+
+		Timer(TimerWheel &wheel, Callback callback);
+
+		//
+		// Cancels the timer and waits for a running callback to complete,
+		// unless invoked from the callback itself.
+		//
+		~Timer();
+
+		Timer(const Timer &) = delete;
+		Timer &operator=(const Timer &) = delete;
+		Timer(Timer &&) = delete;
+		Timer &operator=(Timer &&) = delete;
+
+		//
+		// Schedule the callback to run once `delay` has elapsed.
+		// Re-arming an armed timer replaces the previous expiry.
+		//
+		void arm(Duration delay);
+
+		//
+		// Returns whether the timer was armed.
+		// A callback that is already running is not interrupted.
+		//
+		bool cancel();
+
+		bool armed() const;
+
+	private:
+
+		friend class TimerWheel;
+
+		TimerWheel &m_wheel;
+		Callback m_callback;
+
+		uint64_t m_expiry;
+		bool m_linked;
+	};
+
+	const std::shared_ptr<IClock> &clock() const
+	{
+		return m_clock;
+	}
+
+	IClock::Duration now() const
+	{
+		return m_clock->now();
+	}
+
+	//
+	// Dispatch all timers that have expired.
+	// Only valid for manually driven wheels.
+	//
+	void poll();
+
+	//
+	// Returns the time at which the wheel next needs to be polled,
+	// or nothing if no timers are armed.
+	//
+	std::optional<IClock::Duration> nextExpiry();
+
+private:
+
+	static constexpr size_t LevelBits = 6;
+	static constexpr size_t SlotsPerLevel = size_t(1) << LevelBits;
+	static constexpr size_t SlotMask = SlotsPerLevel - 1;
+	static constexpr size_t Levels = 4;
+
+	// Timers further out are parked in the outermost level and cascaded again.
+	static constexpr uint64_t MaximumDelta = (uint64_t(1) << (LevelBits * Levels)) - 1;
+
+	static void Unlink(Link *link);
+	static void Append(Link *list, Link *link);
+
+	uint64_t elapsedTicks() const;
+
+	void insert(Timer *timer);
+	void remove(Timer *timer);
+
+	void cascade(size_t level);
+	void advance(uint64_t target);
+
+	uint64_t nextWakeTick() const;
+
+	// Invoked with the lock held. The lock is released while running callbacks.
+	void dispatchExpired(std::unique_lock<std::mutex> &lock);
+
+	void thread();
+
+	std::shared_ptr<IClock> m_clock;
+	Duration m_resolution;
+	IClock::Duration m_epoch;
+
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_idle;
+
+	Link m_slots[Levels][SlotsPerLevel];
+
+	// Timers that have expired and are awaiting dispatch.
+	Link m_expired;
+
+	size_t m_armed;
+
+	// The next tick to be processed.
+	uint64_t m_currentTick;
+	uint64_t m_wakeTick;
+
+	Timer *m_running;
+	std::thread::id m_runningThread;
+
+	bool m_exiting;
+
+	std::thread m_thread;
+};
+
+}
@@ -0,0 +1,66 @@
+#include "stdafx.h"
+#include "virtualtime.h"
+
+namespace common
+{
+
+void VirtualClock::set(Duration time)
+{
+	auto current = m_now.load();
+
+	while (current < time.count()
+		&& false == m_now.compare_exchange_weak(current, time.count()))
+	{
+	}
+
+	std::scoped_lock<std::mutex> lock(m_mutex);
+
+	m_advanced.notify_all();
+}
+
+void VirtualClock::sleepUntil(Duration deadline) const
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	m_advanced.wait(lock, [this, deadline]()
+	{
+		return now() >= deadline;
+	});
+}
+
+VirtualTimeDriver::VirtualTimeDriver(TimerWheel::Duration resolution)
+	: m_clock(std::make_shared<VirtualClock>())
+	, m_scheduler(std::make_shared<TimerWheel>(m_clock, TimerWheel::Drive::Manual, resolution))
+{
+}
+
+void VirtualTimeDriver::advance(Duration duration)
+{
+	advanceTo(now() + duration);
+}
+
+void VirtualTimeDriver::advanceTo(Duration time)
+{
+	m_scheduler->poll();
+
+	for (;;)
+	{
+		//
+		// Callbacks may arm further timers, so query the next expiry after every step.
+		//
+		const auto next = m_scheduler->nextExpiry();
+
+		if (false == next.has_value() || next.value() > time)
+		{
+			break;
+		}
+
+		m_clock->set(next.value());
+		m_scheduler->poll();
+	}
+
+	m_clock->set(time);
+	m_scheduler->poll();
+}
+
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "clock.h"
+#include "timerwheel.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace common
+{
+
+//
+// Clock that only moves when told to.
+//
+class VirtualClock : public IClock
+{
+public:
+
+	VirtualClock()
+		: m_now(0)
+	{
+	}
+
+	Duration now() const override
+	{
+		return Duration(m_now.load());
+	}
+
+	//
+	// Blocks until another thread moves the clock past `deadline`.
+	//
+	void sleepUntil(Duration deadline) const override;
+
+	//
+	// Moving the clock backwards is ignored.
+	//
+	void set(Duration time);
+
+	void advance(Duration duration)
+	{
+		set(now() + duration);
+	}
+
+private:
+
+	std::atomic<int64_t> m_now;
+
+	mutable std::mutex m_mutex;
+	mutable std::condition_variable m_advanced;
+};
+
+//
+// Runs timers in virtual time.
+//
+// Timers are registered with `scheduler()` as usual. Advancing the driver steps the
+// clock from one expiry to the next and runs the callbacks on the calling thread,
+// so hours of timer activity can be simulated in a fraction of a second.
+//
+class VirtualTimeDriver
+{
+public:
+
+	using Duration = IClock::Duration;
+
+	explicit VirtualTimeDriver(TimerWheel::Duration resolution = TimerWheel::Duration(1));
+
+	const std::shared_ptr<VirtualClock> &clock() const
+	{
+		return m_clock;
+	}
+
+	const std::shared_ptr<TimerWheel> &scheduler() const
+	{
+		return m_scheduler;
+	}
+
+	Duration now() const
+	{
+		return m_clock->now();
+	}
+
+	//
+	// Move time forward, running every timer that expires on the way.
+	//
+	void advance(Duration duration);
+	void advanceTo(Duration time);
+
+private:
+
+	std::shared_ptr<VirtualClock> m_clock;
+	std::shared_ptr<TimerWheel> m_scheduler;
+};
+
+}
@@ -0,0 +1,73 @@
+#include "pch.h"
+#include "libcommon/arena.h"
+#include "CppUnitTest.h"
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace testlibcommon
+{
+
+TEST_CLASS(TestLibCommonArena)
+{
+public:
+
+	TEST_METHOD(AllocationsAreAligned)
+	{
+		common::memory::Arena arena;
+
+		arena.allocate(1, 1);
+
+		const auto p = arena.allocate(8, 64);
+
+		Assert::AreEqual(uintptr_t(0), reinterpret_cast<uintptr_t>(p) % 64);
+	}
+
+	TEST_METHOD(OversizedAllocationSucceeds)
+	{
+		common::memory::Arena arena(128);
+
+		Assert::IsNotNull(arena.allocate(4096));
+		Assert::IsTrue(arena.reserved() >= 4096);
+	}
+
+	TEST_METHOD(ResetKeepsLargestChunk)
+	{
+		common::memory::Arena arena(128);
+
+		arena.allocate(100);
+		arena.allocate(100);
+		arena.allocate(4096);
+
+		arena.reset();
+
+		Assert::AreEqual(size_t(0), arena.allocated());
+		Assert::IsTrue(arena.reserved() >= 4096 && arena.reserved() < 4096 + 256);
+	}
+
+	TEST_METHOD(BacksPmrContainers)
+	{
+		common::memory::Arena arena;
+		common::memory::ArenaResource resource(arena);
+
+		{
+			std::pmr::vector<std::pmr::wstring> strings(&resource);
+
+			for (size_t i = 0; i < 100; ++i)
+			{
+				strings.emplace_back(L"a string that is too long for the small string optimization");
+			}
+		}
+
+		Assert::IsTrue(arena.allocated() > 100 * 50 * sizeof(wchar_t));
+
+		arena.reset();
+
+		Assert::AreEqual(size_t(0), arena.allocated());
+	}
+};
+
+}
@@ -0,0 +1,209 @@
+#include "pch.h"
+#include "libcommon/logging/asynclogsink.h"
+#include "logrecorder.h"
+#include "CppUnitTest.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std::chrono_literals;
+using common::logging::AsyncLogSink;
+using common::logging::LogLevel;
+
+namespace testlibcommon
+{
+
+TEST_CLASS(TestLibCommonAsyncLogSink)
+{
+public:
+
+	TEST_METHOD(MessagesAreDeliveredInOrder)
+	{
+		LogRecorder recorder;
+		AsyncLogSink sink(recorder.target());
+
+		sink.error("one");
+		sink.info("two");
+		sink.trace("three");
+
+		sink.flush();
+
+		const auto records = recorder.records();
+
+		Assert::AreEqual(size_t(3), records.size());
+
+		Assert::IsTrue(LogLevel::Error == records[0].level);
+		Assert::AreEqual(std::string("one"), records[0].message);
+
+		Assert::IsTrue(LogLevel::Info == records[1].level);
+		Assert::AreEqual(std::string("two"), records[1].message);
+
+		Assert::IsTrue(LogLevel::Trace == records[2].level);
+		Assert::AreEqual(std::string("three"), records[2].message);
+	}
+
+	TEST_METHOD(DestructorDeliversQueuedMessages)
+	{
+		LogRecorder recorder;
+
+		{
+			AsyncLogSink sink(recorder.target());
+
+			for (int i = 0; i < 100; ++i)
+			{
+				sink.debug("message");
+			}
+		}
+
+		Assert::AreEqual(size_t(100), recorder.records().size());
+	}
+
+	TEST_METHOD(LongMessageIsTruncated)
+	{
+		LogRecorder recorder;
+
+		AsyncLogSink::Options options;
+		options.maximumMessageLength = 8;
+
+		AsyncLogSink sink(recorder.target(), options);
+
+		sink.warning("0123456789");
+		sink.flush();
+
+		const auto records = recorder.records();
+
+		Assert::AreEqual(size_t(1), records.size());
+		Assert::AreEqual(std::string("0123456"), records[0].message);
+	}
+
+	TEST_METHOD(DropPolicyCountsDiscardedMessages)
+	{
+		std::atomic<bool> release = false;
+		std::atomic<size_t> received = 0;
+
+		AsyncLogSink::Options options;
+		options.capacity = 4;
+		options.overflowPolicy = AsyncLogSink::OverflowPolicy::Drop;
+
+		AsyncLogSink sink([&](LogLevel, const char *)
+		{
+			while (false == release)
+			{
+				std::this_thread::sleep_for(1ms);
+			}
+
+			++received;
+		}, options);
+
+		for (int i = 0; i < 100; ++i)
+		{
+			sink.info("message");
+		}
+
+		release = true;
+		sink.flush();
+
+		Assert::IsTrue(sink.dropped() > 0);
+		Assert::AreEqual(uint64_t(100), received + sink.dropped());
+	}
+
+	TEST_METHOD(OverwritePolicyKeepsNewestMessages)
+	{
+		std::atomic<bool> delivering = false;
+		std::atomic<bool> release = false;
+		LogRecorder recorder;
+		auto record = recorder.target();
+
+		AsyncLogSink::Options options;
+		options.capacity = 4;
+		options.overflowPolicy = AsyncLogSink::OverflowPolicy::OverwriteOldest;
+
+		AsyncLogSink sink([&](LogLevel level, const char *msg)
+		{
+			delivering = true;
+
+			while (false == release)
+			{
+				std::this_thread::sleep_for(1ms);
+			}
+
+			record(level, msg);
+		}, options);
+
+		//
+		// Overwriting must make progress while the writer is stuck delivering a message.
+		//
+		sink.info("first");
+
+		while (false == delivering)
+		{
+			std::this_thread::sleep_for(1ms);
+		}
+
+		for (int i = 0; i < 100; ++i)
+		{
+			sink.info(std::to_string(i).c_str());
+		}
+
+		release = true;
+		sink.flush();
+
+		const auto records = recorder.records();
+
+		Assert::AreEqual(uint64_t(101), records.size() + sink.dropped());
+		Assert::AreEqual(std::string("first"), records.front().message);
+		Assert::AreEqual(std::string("99"), records.back().message);
+	}
+
+	TEST_METHOD(BlockPolicyDeliversEverything)
+	{
+		std::atomic<size_t> received = 0;
+
+		AsyncLogSink::Options options;
+		options.capacity = 4;
+		options.overflowPolicy = AsyncLogSink::OverflowPolicy::Block;
+
+		AsyncLogSink sink([&](LogLevel, const char *)
+		{
+			++received;
+		}, options);
+
+		std::vector<std::thread> threads;
+
+		for (int i = 0; i < 4; ++i)
+		{
+			threads.emplace_back([&sink]()
+			{
+				for (int j = 0; j < 10000; ++j)
+				{
+					sink.info("message");
+				}
+			});
+		}
+
+		for (auto &thread : threads)
+		{
+			thread.join();
+		}
+
+		sink.flush();
+
+		Assert::AreEqual(size_t(40000), received.load());
+		Assert::AreEqual(uint64_t(0), sink.dropped());
+	}
+
+	TEST_METHOD(FlushWithoutMessagesReturns)
+	{
+		AsyncLogSink sink([](LogLevel, const char *)
+		{
+		});
+
+		sink.flush();
+		sink.flush();
+	}
+};
+
+}
@@ -0,0 +1,125 @@
+#include "pch.h"
+#include "libcommon/binaryreader.h"
+#include "libcommon/binarycomposer.h"
+#include "CppUnitTest.h"
+#include <cstdint>
+#include <stdexcept>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace testlibcommon
+{
+
+TEST_CLASS(TestLibCommonBinaryReader)
+{
+public:
+
+	TEST_METHOD(ReadNativeValues)
+	{
+		const uint8_t data[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 };
+
+		common::BinaryReader reader(common::ConstBufferView(data, sizeof(data)));
+
+		Assert::AreEqual(uint8_t(0x01), reader.read<uint8_t>());
+		Assert::AreEqual(uint16_t(0x0302), reader.read<uint16_t>());
+		Assert::AreEqual(uint32_t(0x07060504), reader.read<uint32_t>());
+		Assert::IsTrue(reader.exhausted());
+	}
+
+	TEST_METHOD(ReadBigEndianValues)
+	{
+		const uint8_t data[] = { 0x7F, 0x00, 0x00, 0x01, 0x01, 0xBB };
+
+		common::BinaryReader reader(common::ConstBufferView(data, sizeof(data)));
+
+		Assert::AreEqual(uint32_t(0x7F000001), reader.read<uint32_t, common::ByteOrder::BigEndian>());
+		Assert::AreEqual(uint16_t(443), reader.read<uint16_t, common::ByteOrder::BigEndian>());
+	}
+
+	TEST_METHOD(ReadBeyondEndThrows)
+	{
+		const uint8_t data[] = { 0x01, 0x02, 0x03 };
+
+		common::BinaryReader reader(common::ConstBufferView(data, sizeof(data)));
+
+		Assert::ExpectException<std::runtime_error>([&reader]()
+		{
+			reader.read<uint32_t>();
+		});
+
+		//
+		// A failed read must not advance the reader.
+		//
+		Assert::AreEqual(size_t(0), reader.offset());
+	}
+
+	TEST_METHOD(SliceReferencesSourceBuffer)
+	{
+		const uint8_t data[] = { 0x01, 0x02, 0x03, 0x04 };
+
+		common::BinaryReader reader(common::ConstBufferView(data, sizeof(data)));
+
+		reader.skip(1);
+
+		const auto slice = reader.slice(2);
+
+		Assert::IsTrue(slice.data() == &data[1]);
+		Assert::AreEqual(size_t(2), slice.size());
+		Assert::AreEqual(size_t(1), reader.remaining());
+	}
+
+	TEST_METHOD(AlignAdvancesToMultiple)
+	{
+		const uint8_t data[16] = { 0 };
+
+		common::BinaryReader reader(common::ConstBufferView(data, sizeof(data)));
+
+		reader.align(8);
+		Assert::AreEqual(size_t(0), reader.offset());
+
+		reader.skip(3);
+		reader.align(8);
+		Assert::AreEqual(size_t(8), reader.offset());
+	}
+
+	TEST_METHOD(AlignToOneDoesNotMove)
+	{
+		const uint8_t data[4] = { 0 };
+
+		common::BinaryReader reader(common::ConstBufferView(data, sizeof(data)));
+
+		reader.skip(3);
+		reader.align(1);
+		Assert::AreEqual(size_t(3), reader.offset());
+	}
+
+	TEST_METHOD(ReadComposedParts)
+	{
+		const uint32_t first = 0xDEADBEEF;
+		const uint8_t second[] = { 0xAA, 0xBB, 0xCC };
+		const uint64_t third = 0x0102030405060708;
+
+		common::BinaryComposer composer
+		{
+			common::ConstBufferView(&first, sizeof(first)),
+			common::ConstBufferView(second, sizeof(second)),
+			common::ConstBufferView(&third, sizeof(third))
+		};
+
+		common::BinaryReader reader(common::ConstBufferView(composer.buffer(), composer.size()));
+
+		Assert::AreEqual(first, reader.read<uint32_t>());
+		reader.alignNative();
+
+		const auto view = reader.slice(sizeof(second));
+		Assert::AreEqual(0, memcmp(view.data(), second, sizeof(second)));
+		reader.alignNative();
+
+		Assert::AreEqual(third, reader.read<uint64_t>());
+		reader.alignNative();
+
+		Assert::IsTrue(reader.exhausted());
+	}
+};
+
+}
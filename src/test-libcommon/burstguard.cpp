@@ -0,0 +1,616 @@
+#include "pch.h"
+#include "libcommon/burstguard.h"
+#include "libcommon/aggregatingburstguard.h"
+#include "libcommon/virtualtime.h"
+#include "CppUnitTest.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std::chrono_literals;
+
+namespace testlibcommon
+{
+
+namespace
+{
+
+//
+// Virtual clock that can hold up a single reading until released.
+// Lets a test interleave two triggers at a precise point.
+//
+class GatedClock : public common::IClock
+{
+public:
+
+	explicit GatedClock(std::shared_ptr<common::VirtualClock> clock)
+		: m_clock(std::move(clock))
+		, m_armed(false)
+	{
+	}
+
+	Duration now() const override
+	{
+		const auto time = m_clock->now();
+
+		if (m_armed.exchange(false))
+		{
+			m_reached.set_value();
+			m_release.get_future().wait();
+		}
+
+		return time;
+	}
+
+	void sleepUntil(Duration deadline) const override
+	{
+		m_clock->sleepUntil(deadline);
+	}
+
+	//
+	// Block the next reading, returns a future that is ready once it's blocked.
+	//
+	std::future<void> arm()
+	{
+		m_armed = true;
+		return m_reached.get_future();
+	}
+
+	void release()
+	{
+		m_release.set_value();
+	}
+
+private:
+
+	std::shared_ptr<common::VirtualClock> m_clock;
+
+	mutable std::atomic<bool> m_armed;
+	mutable std::promise<void> m_reached;
+	mutable std::promise<void> m_release;
+};
+
+} // anonymous namespace
+
+TEST_CLASS(TestLibCommonBurstGuard)
+{
+public:
+
+	TEST_METHOD(ConcurrentTriggersCoalesce)
+	{
+		std::atomic<int> fired = 0;
+		common::BurstGuard guard([&fired]() { ++fired; }, 50);
+
+		std::atomic<bool> stop = false;
+		std::vector<std::thread> producers;
+
+		for (int i = 0; i < 4; ++i)
+		{
+			producers.emplace_back([&guard, &stop]()
+			{
+				while (false == stop)
+				{
+					guard.trigger();
+				}
+			});
+		}
+
+		std::this_thread::sleep_for(200ms);
+		stop = true;
+
+		for (auto &producer : producers)
+		{
+			producer.join();
+		}
+
+		std::this_thread::sleep_for(150ms);
+
+		Assert::AreEqual(1, fired.load());
+	}
+
+	TEST_METHOD(TriggerAfterBurstStartsNewBurst)
+	{
+		std::atomic<int> fired = 0;
+		common::BurstGuard guard([&fired]() { ++fired; }, 20);
+
+		guard.trigger();
+		std::this_thread::sleep_for(100ms);
+
+		Assert::AreEqual(1, fired.load());
+
+		guard.trigger();
+		std::this_thread::sleep_for(100ms);
+
+		Assert::AreEqual(2, fired.load());
+	}
+
+	TEST_METHOD(InterferenceFiresDuringLongBurst)
+	{
+		std::atomic<int> fired = 0;
+		common::BurstGuard guard([&fired]() { ++fired; }, 50, 100);
+
+		const auto end = std::chrono::steady_clock::now() + 500ms;
+
+		while (std::chrono::steady_clock::now() < end)
+		{
+			guard.trigger();
+			std::this_thread::sleep_for(5ms);
+		}
+
+		Assert::IsTrue(fired.load() >= 2);
+	}
+
+	TEST_METHOD(TriggerRacingBurstStartIsNotInterference)
+	{
+		auto virtualClock = std::make_shared<common::VirtualClock>();
+		auto clock = std::make_shared<GatedClock>(virtualClock);
+
+		std::atomic<int> fired = 0;
+
+		common::BurstGuard::Options options;
+
+		options.burstDuration = 50;
+		options.interferenceInterval = 100;
+		options.scheduler = std::make_shared<common::TimerWheel>(clock, common::TimerWheel::Drive::Manual);
+
+		common::BurstGuard guard([&fired]() { ++fired; }, options);
+
+		virtualClock->set(1000ms);
+
+		//
+		// The racing trigger reads its timestamp, then another trigger opens the burst
+		// with a later timestamp before the racing trigger inspects the burst.
+		//
+		auto blocked = clock->arm();
+
+		std::thread racing([&guard]()
+		{
+			guard.trigger();
+		});
+
+		blocked.wait();
+
+		virtualClock->set(1200ms);
+		guard.trigger();
+
+		clock->release();
+		racing.join();
+
+		Assert::AreEqual(0, fired.load());
+		Assert::AreEqual(uint64_t(0), guard.statistics().interferences);
+	}
+
+	TEST_METHOD(ExecutorQueuesOneOverlappingBurst)
+	{
+		std::atomic<int> fired = 0;
+		std::atomic<int> concurrent = 0;
+		std::atomic<int> maximumConcurrent = 0;
+
+		common::BurstGuard::Options options;
+
+		options.burstDuration = 5;
+		options.executor = common::BurstGuard::DedicatedWorker();
+		options.overlapPolicy = common::BurstGuard::OverlapPolicy::QueueOne;
+
+		common::BurstGuard guard([&]()
+		{
+			const auto current = ++concurrent;
+			maximumConcurrent = (std::max)(maximumConcurrent.load(), current);
+
+			std::this_thread::sleep_for(100ms);
+
+			--concurrent;
+			++fired;
+		}, options);
+
+		for (int i = 0; i < 5; ++i)
+		{
+			const auto start = std::chrono::steady_clock::now();
+
+			guard.trigger();
+
+			//
+			// The producer must not wait for the running callback.
+			//
+			Assert::IsTrue(std::chrono::steady_clock::now() - start < 50ms);
+
+			std::this_thread::sleep_for(20ms);
+		}
+
+		std::this_thread::sleep_for(400ms);
+
+		Assert::AreEqual(2, fired.load());
+		Assert::AreEqual(1, maximumConcurrent.load());
+	}
+
+	TEST_METHOD(ExecutorSkipsOverlappingBurst)
+	{
+		std::atomic<int> fired = 0;
+
+		common::BurstGuard::Options options;
+
+		options.burstDuration = 5;
+		options.executor = common::BurstGuard::DedicatedWorker();
+		options.overlapPolicy = common::BurstGuard::OverlapPolicy::Skip;
+
+		common::BurstGuard guard([&fired]()
+		{
+			std::this_thread::sleep_for(100ms);
+			++fired;
+		}, options);
+
+		for (int i = 0; i < 3; ++i)
+		{
+			guard.trigger();
+			std::this_thread::sleep_for(20ms);
+		}
+
+		std::this_thread::sleep_for(300ms);
+
+		Assert::AreEqual(1, fired.load());
+	}
+
+	TEST_METHOD(DestructorWaitsForDispatchedCallback)
+	{
+		std::atomic<bool> completed = false;
+
+		{
+			common::BurstGuard::Options options;
+
+			options.burstDuration = 1;
+			options.executor = common::BurstGuard::DedicatedWorker();
+
+			common::BurstGuard guard([&completed]()
+			{
+				std::this_thread::sleep_for(100ms);
+				completed = true;
+			}, options);
+
+			guard.trigger();
+			std::this_thread::sleep_for(30ms);
+		}
+
+		Assert::IsTrue(completed.load());
+	}
+
+	TEST_METHOD(WorkerJobMayReleaseLastReference)
+	{
+		auto executor = std::make_shared<common::BurstGuard::Executor>(common::BurstGuard::DedicatedWorker());
+
+		std::promise<void> posted;
+		std::promise<void> released;
+
+		(*executor)([executor, posted = posted.get_future().share(), &released]() mutable
+		{
+			posted.wait();
+
+			//
+			// Destroys the worker on its own thread.
+			//
+			executor.reset();
+
+			released.set_value();
+		});
+
+		executor.reset();
+		posted.set_value();
+
+		released.get_future().wait();
+
+		//
+		// Give the detached thread time to run into freed memory, should it refer to the worker.
+		//
+		std::this_thread::sleep_for(50ms);
+	}
+
+	TEST_METHOD(RejectedDispatchDoesNotBlockDestruction)
+	{
+		auto clock = std::make_shared<common::VirtualClock>();
+
+		common::BurstGuard::Options options;
+
+		options.burstDuration = 50;
+		options.interferenceInterval = 100;
+		options.scheduler = std::make_shared<common::TimerWheel>(clock, common::TimerWheel::Drive::Manual);
+		options.executor = [](common::BurstGuard::Callback)
+		{
+			throw std::runtime_error("Rejected");
+		};
+
+		{
+			common::BurstGuard guard([]() {}, options);
+
+			clock->set(1000ms);
+			guard.trigger();
+
+			clock->set(1150ms);
+
+			Assert::ExpectException<std::runtime_error>([&guard]()
+			{
+				guard.trigger();
+			});
+		}
+	}
+
+	TEST_METHOD(AggregatingGuardDeliversDistinctPayloads)
+	{
+		std::set<uint64_t> delivered;
+		std::atomic<int> fired = 0;
+
+		common::BurstGuard::Options options;
+		options.burstDuration = 20;
+
+		common::AggregatingBurstGuard<uint64_t> guard([&](std::set<uint64_t> &&aggregate)
+		{
+			delivered = std::move(aggregate);
+			++fired;
+		}, options);
+
+		for (uint64_t i = 0; i < 100; ++i)
+		{
+			guard.trigger(i % 7);
+		}
+
+		std::this_thread::sleep_for(100ms);
+
+		Assert::AreEqual(1, fired.load());
+		Assert::AreEqual(size_t(7), delivered.size());
+	}
+
+	TEST_METHOD(AggregatingGuardUsesReducer)
+	{
+		std::atomic<uint32_t> delivered = 0;
+
+		common::BurstGuard::Options options;
+		options.burstDuration = 20;
+
+		common::AggregatingBurstGuard<uint32_t, uint32_t> guard([&delivered](uint32_t &&mask)
+		{
+			delivered = mask;
+		}, options, [](uint32_t &mask, uint32_t flag)
+		{
+			mask |= flag;
+		});
+
+		guard.trigger(0x1);
+		guard.trigger(0x4);
+		guard.trigger(0x1);
+
+		std::this_thread::sleep_for(100ms);
+
+		Assert::AreEqual(uint32_t(0x5), delivered.load());
+	}
+
+	TEST_METHOD(SimulateHourOfTrafficInVirtualTime)
+	{
+		common::VirtualTimeDriver driver;
+
+		int fired = 0;
+
+		common::BurstGuard::Options options;
+
+		options.burstDuration = 50;
+		options.interferenceInterval = 1000;
+		options.scheduler = driver.scheduler();
+
+		common::BurstGuard guard([&fired]() { ++fired; }, options);
+
+		//
+		// Continuous storm, one trigger every 10 ms.
+		// Each interference ends the burst and the next trigger starts a new one.
+		//
+		for (int i = 0; i < 360000; ++i)
+		{
+			guard.trigger();
+			driver.advance(10ms);
+		}
+
+		Assert::AreEqual(3600 * 1000 / 1010, fired);
+
+		driver.advance(1s);
+		Assert::AreEqual(3600 * 1000 / 1010 + 1, fired);
+
+		//
+		// Sparse triggers each end up in a burst of their own.
+		//
+		fired = 0;
+
+		for (int i = 0; i < 1800; ++i)
+		{
+			guard.trigger();
+			driver.advance(2s);
+		}
+
+		Assert::AreEqual(1800, fired);
+	}
+
+	TEST_METHOD(BurstEndsAfterQuietPeriodInVirtualTime)
+	{
+		common::VirtualTimeDriver driver;
+
+		int fired = 0;
+
+		common::BurstGuard::Options options;
+
+		options.burstDuration = 100;
+		options.scheduler = driver.scheduler();
+
+		common::BurstGuard guard([&fired]() { ++fired; }, options);
+
+		guard.trigger();
+		driver.advance(60ms);
+
+		guard.trigger();
+		driver.advance(99ms);
+
+		Assert::AreEqual(0, fired);
+
+		driver.advance(1ms);
+		Assert::AreEqual(1, fired);
+	}
+
+	TEST_METHOD(AdaptiveWindowShrinksUnderLightLoad)
+	{
+		common::VirtualTimeDriver driver;
+
+		int fired = 0;
+
+		common::BurstGuard::Options options;
+
+		options.burstDuration = 50;
+		options.scheduler = driver.scheduler();
+		options.adaptivePolicy = common::BurstGuard::AdaptivePolicy
+		{
+			.minimumQuietWindow = 10,
+			.maximumQuietWindow = 200,
+			.maximumDelay = 1000
+		};
+
+		common::BurstGuard guard([&fired]() { ++fired; }, options);
+
+		for (int i = 0; i < 20; ++i)
+		{
+			guard.trigger();
+			driver.advance(5s);
+		}
+
+		const auto counters = guard.adaptiveCounters();
+
+		Assert::AreEqual(20, fired);
+		Assert::AreEqual(uint32_t(10), counters.quietWindow);
+		Assert::IsTrue(counters.windowDecreases > 0);
+	}
+
+	TEST_METHOD(AdaptiveWindowGrowsWithGaps)
+	{
+		common::VirtualTimeDriver driver;
+
+		int fired = 0;
+
+		common::BurstGuard::Options options;
+
+		options.burstDuration = 10;
+		options.scheduler = driver.scheduler();
+		options.adaptivePolicy = common::BurstGuard::AdaptivePolicy
+		{
+			.minimumQuietWindow = 10,
+			.maximumQuietWindow = 200
+		};
+
+		common::BurstGuard guard([&fired]() { ++fired; }, options);
+
+		//
+		// Triggers 40 ms apart initially each form a burst of their own.
+		//
+		for (int i = 0; i < 250; ++i)
+		{
+			guard.trigger();
+			driver.advance(40ms);
+		}
+
+		const auto counters = guard.adaptiveCounters();
+
+		Assert::AreEqual(uint32_t(40), counters.averageGap);
+		Assert::AreEqual(uint32_t(80), counters.quietWindow);
+		Assert::IsTrue(fired < 50);
+	}
+
+	TEST_METHOD(AdaptiveMaximumDelayIsHonoured)
+	{
+		common::VirtualTimeDriver driver;
+
+		std::vector<int64_t> fired;
+
+		common::BurstGuard::Options options;
+
+		options.burstDuration = 50;
+		options.scheduler = driver.scheduler();
+		options.adaptivePolicy = common::BurstGuard::AdaptivePolicy
+		{
+			.minimumQuietWindow = 10,
+			.maximumQuietWindow = 200,
+			.maximumDelay = 1000
+		};
+
+		common::BurstGuard guard([&]()
+		{
+			fired.push_back(std::chrono::duration_cast<std::chrono::milliseconds>(driver.now()).count());
+		}, options);
+
+		for (int i = 0; i < 2000; ++i)
+		{
+			guard.trigger();
+			driver.advance(5ms);
+		}
+
+		Assert::AreEqual(size_t(10), fired.size());
+		Assert::AreEqual(uint64_t(10), guard.adaptiveCounters().maximumDelayFires);
+
+		for (size_t i = 1; i < fired.size(); ++i)
+		{
+			Assert::IsTrue(fired[i] - fired[i - 1] <= 1000 + 5);
+		}
+	}
+
+	TEST_METHOD(StatisticsDescribeBursts)
+	{
+		common::VirtualTimeDriver driver;
+
+		common::BurstGuard::Options options;
+
+		options.burstDuration = 50;
+		options.interferenceInterval = 1000;
+		options.scheduler = driver.scheduler();
+
+		common::BurstGuard guard([&driver]()
+		{
+			driver.clock()->advance(3ms);
+		}, options);
+
+		for (int i = 0; i < 5; ++i)
+		{
+			guard.trigger();
+			driver.advance(10ms);
+		}
+
+		driver.advance(100ms);
+
+		//
+		// Long enough for one interference.
+		//
+		for (int i = 0; i < 200; ++i)
+		{
+			guard.trigger();
+			driver.advance(10ms);
+		}
+
+		driver.advance(100ms);
+
+		const auto statistics = guard.statistics();
+
+		Assert::AreEqual(uint64_t(205), statistics.triggers);
+		Assert::AreEqual(uint64_t(2), statistics.bursts);
+		Assert::AreEqual(uint64_t(1), statistics.interferences);
+		Assert::AreEqual(uint64_t(0), statistics.callbacksSkipped);
+
+		//
+		// One burst of 5 triggers and two of 64 to 127 triggers.
+		//
+		Assert::AreEqual(uint64_t(1), statistics.triggersPerBurst[3]);
+		Assert::AreEqual(uint64_t(2), statistics.triggersPerBurst[7]);
+
+		//
+		// Three callbacks taking 3 ms each.
+		//
+		Assert::AreEqual(uint64_t(3), statistics.callbackDuration[12]);
+	}
+};
+
+}
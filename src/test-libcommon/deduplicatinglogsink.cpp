@@ -0,0 +1,261 @@
+#include "pch.h"
+#include "libcommon/logging/deduplicatinglogsink.h"
+#include "libcommon/logging/logsink.h"
+#include "libcommon/virtualtime.h"
+#include "logrecorder.h"
+#include "CppUnitTest.h"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std::chrono_literals;
+using common::logging::DeduplicatingLogSink;
+using common::logging::LogLevel;
+using common::logging::LogSink;
+
+namespace testlibcommon
+{
+
+namespace
+{
+
+DeduplicatingLogSink::Options CreateOptions(const common::VirtualTimeDriver &driver)
+{
+	DeduplicatingLogSink::Options options;
+	options.scheduler = driver.scheduler();
+
+	return options;
+}
+
+} // anonymous namespace
+
+TEST_CLASS(TestLibCommonDeduplicatingLogSink)
+{
+public:
+
+	TEST_METHOD(RepeatsWithinWindowAreSummarized)
+	{
+		LogRecorder recorder;
+		common::VirtualTimeDriver driver;
+
+		auto options = CreateOptions(driver);
+		options.window = 1000ms;
+
+		{
+			DeduplicatingLogSink sink(recorder.sink(), options);
+
+			for (int i = 0; i < 1000; ++i)
+			{
+				sink.error("Adapter is gone");
+			}
+
+			Assert::AreEqual(size_t(1), recorder.messages().size());
+			Assert::AreEqual(uint64_t(999), sink.duplicatesSuppressed());
+
+			driver.advance(1000ms);
+
+			sink.error("Adapter is gone");
+
+			Assert::AreEqual(size_t(3), recorder.messages().size());
+			Assert::AreEqual(std::string("Message repeated 999 time(s): Adapter is gone"), recorder.messages()[1]);
+			Assert::AreEqual(std::string("Adapter is gone"), recorder.messages()[2]);
+
+			sink.error("Adapter is gone");
+		}
+
+		//
+		// Outstanding counts are reported on destruction.
+		//
+		Assert::AreEqual(size_t(4), recorder.messages().size());
+		Assert::AreEqual(std::string("Message repeated 1 time(s): Adapter is gone"), recorder.messages()[3]);
+	}
+
+	TEST_METHOD(SummaryIsReportedWhenWindowPasses)
+	{
+		LogRecorder recorder;
+		common::VirtualTimeDriver driver;
+
+		auto options = CreateOptions(driver);
+		options.window = 1000ms;
+
+		DeduplicatingLogSink sink(recorder.sink(), options);
+
+		sink.info("message");
+		driver.advance(500ms);
+		sink.info("message");
+		sink.info("message");
+
+		driver.advance(499ms);
+
+		Assert::AreEqual(size_t(1), recorder.messages().size());
+
+		//
+		// The summary is not held back until the message appears again.
+		//
+		driver.advance(1ms);
+
+		Assert::AreEqual(size_t(2), recorder.messages().size());
+		Assert::AreEqual(std::string("Message repeated 2 time(s): message"), recorder.messages()[1]);
+
+		sink.info("message");
+
+		Assert::AreEqual(size_t(3), recorder.messages().size());
+		Assert::AreEqual(std::string("message"), recorder.messages()[2]);
+	}
+
+	TEST_METHOD(DistinctMessagesAndLevelsAreForwarded)
+	{
+		LogRecorder recorder;
+		common::VirtualTimeDriver driver;
+		DeduplicatingLogSink sink(recorder.sink(), CreateOptions(driver));
+
+		sink.error("first");
+		sink.error("second");
+		sink.warning("first");
+
+		Assert::AreEqual(size_t(3), recorder.messages().size());
+	}
+
+	TEST_METHOD(FlushReportsAndKeepsWindow)
+	{
+		LogRecorder recorder;
+		common::VirtualTimeDriver driver;
+		DeduplicatingLogSink sink(recorder.sink(), CreateOptions(driver));
+
+		sink.info("message");
+		sink.info("message");
+		sink.flush();
+
+		Assert::AreEqual(size_t(2), recorder.messages().size());
+		Assert::AreEqual(std::string("Message repeated 1 time(s): message"), recorder.messages()[1]);
+
+		sink.info("message");
+		sink.flush();
+
+		Assert::AreEqual(size_t(3), recorder.messages().size());
+
+		sink.flush();
+
+		Assert::AreEqual(size_t(3), recorder.messages().size());
+	}
+
+	TEST_METHOD(TableIsBounded)
+	{
+		LogRecorder recorder;
+		common::VirtualTimeDriver driver;
+
+		auto options = CreateOptions(driver);
+		options.tableSize = 1;
+
+		DeduplicatingLogSink sink(recorder.sink(), options);
+
+		sink.info("first");
+		sink.info("first");
+
+		//
+		// The only entry is taken over, which reports the pending count.
+		//
+		sink.info("second");
+
+		Assert::AreEqual(size_t(3), recorder.messages().size());
+		Assert::AreEqual(std::string("Message repeated 1 time(s): first"), recorder.messages()[1]);
+		Assert::AreEqual(std::string("second"), recorder.messages()[2]);
+	}
+
+	TEST_METHOD(RateCapLimitsLevel)
+	{
+		LogRecorder recorder;
+		common::VirtualTimeDriver driver;
+
+		auto options = CreateOptions(driver);
+		options.rateCaps[static_cast<size_t>(LogLevel::Warning)] = DeduplicatingLogSink::RateCap{ 100ms, 2 };
+
+		DeduplicatingLogSink sink(recorder.sink(), options);
+
+		for (int i = 0; i < 10; ++i)
+		{
+			sink.warning(std::to_string(i).c_str());
+			sink.info(std::to_string(i).c_str());
+		}
+
+		Assert::AreEqual(size_t(12), recorder.messages().size());
+		Assert::AreEqual(uint64_t(8), sink.rateLimited());
+
+		driver.advance(100ms);
+
+		sink.warning("admitted");
+
+		Assert::AreEqual(std::string("8 message(s) discarded due to rate limit"), recorder.messages()[12]);
+		Assert::AreEqual(std::string("admitted"), recorder.messages()[13]);
+	}
+
+	TEST_METHOD(RateLimitedMessagesAreNotTracked)
+	{
+		LogRecorder recorder;
+		common::VirtualTimeDriver driver;
+
+		auto options = CreateOptions(driver);
+		options.rateCaps[static_cast<size_t>(LogLevel::Warning)] = DeduplicatingLogSink::RateCap{ 100ms, 1 };
+
+		DeduplicatingLogSink sink(recorder.sink(), options);
+
+		sink.warning("first");
+
+		for (int i = 0; i < 5; ++i)
+		{
+			sink.warning("second");
+		}
+
+		Assert::AreEqual(uint64_t(5), sink.rateLimited());
+		Assert::AreEqual(uint64_t(0), sink.duplicatesSuppressed());
+
+		driver.advance(100ms);
+		sink.flush();
+
+		Assert::AreEqual(size_t(1), recorder.messages().size());
+
+		sink.warning("second");
+		sink.flush();
+
+		Assert::AreEqual(size_t(3), recorder.messages().size());
+		Assert::AreEqual(std::string("5 message(s) discarded due to rate limit"), recorder.messages()[1]);
+		Assert::AreEqual(std::string("second"), recorder.messages()[2]);
+	}
+
+	TEST_METHOD(ConcurrentRepeatsAreCounted)
+	{
+		auto target = std::make_shared<LogSink>([](LogLevel, const char *) {});
+
+		DeduplicatingLogSink::Options options;
+		options.window = 1h;
+
+		DeduplicatingLogSink sink(target, options);
+
+		std::vector<std::thread> threads;
+
+		for (int i = 0; i < 4; ++i)
+		{
+			threads.emplace_back([&sink, i]()
+			{
+				const auto message = "message " + std::to_string(i % 2);
+
+				for (int j = 0; j < 10000; ++j)
+				{
+					sink.debug(message.c_str());
+				}
+			});
+		}
+
+		for (auto &thread : threads)
+		{
+			thread.join();
+		}
+
+		Assert::AreEqual(uint64_t(40000 - 2), sink.duplicatesSuppressed());
+	}
+};
+
+}
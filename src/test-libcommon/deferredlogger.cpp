@@ -0,0 +1,349 @@
+#include "pch.h"
+#include "libcommon/logging/deferredlogger.h"
+#include "CppUnitTest.h"
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace common::logging;
+
+namespace testlibcommon
+{
+
+namespace
+{
+
+class RecordingSink : public ILogSink
+{
+public:
+
+	void error(const char *msg) override
+	{
+		record(LogLevel::Error, msg);
+	}
+
+	void warning(const char *msg) override
+	{
+		record(LogLevel::Warning, msg);
+	}
+
+	void info(const char *msg) override
+	{
+		record(LogLevel::Info, msg);
+	}
+
+	void debug(const char *msg) override
+	{
+		record(LogLevel::Debug, msg);
+	}
+
+	void trace(const char *msg) override
+	{
+		record(LogLevel::Trace, msg);
+	}
+
+	bool enabled(LogLevel level) const override
+	{
+		return level <= LogLevel::Debug;
+	}
+
+	std::vector<DecodedRecord> records()
+	{
+		std::scoped_lock<std::mutex> lock(m_mutex);
+		return m_records;
+	}
+
+	//
+	// Block delivery once `count` records have been delivered.
+	//
+	void allow(size_t count)
+	{
+		std::scoped_lock<std::mutex> lock(m_mutex);
+
+		m_allowed = count;
+		m_changed.notify_all();
+	}
+
+	//
+	// Wait until delivery of the `count`th record has started.
+	//
+	void waitForRecords(size_t count)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		m_changed.wait(lock, [this, count]()
+		{
+			return m_records.size() >= count;
+		});
+	}
+
+private:
+
+	void record(LogLevel level, const char *msg)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		m_records.push_back(DecodedRecord{ level, msg });
+		m_changed.notify_all();
+
+		m_changed.wait(lock, [this]()
+		{
+			return m_records.size() <= m_allowed;
+		});
+	}
+
+	std::mutex m_mutex;
+	std::condition_variable m_changed;
+	std::vector<DecodedRecord> m_records;
+	size_t m_allowed = SIZE_MAX;
+};
+
+constexpr LogFormat IntegerFormat{ LogLevel::Info, "signed {}, unsigned {}, bool {}" };
+constexpr LogFormat StringFormat{ LogLevel::Warning, "narrow '{}', wide '{}'" };
+
+} // anonymous namespace
+
+TEST_CLASS(TestLibCommonDeferredLogger)
+{
+public:
+
+	TEST_METHOD(DecodeIntegers)
+	{
+		const auto record = EncodeRecord(&IntegerFormat, int8_t(-5), uint64_t(18446744073709551615ull), true);
+		const auto decoded = DecodeRecord(common::ConstBufferView(record.data(), record.size()));
+
+		Assert::IsTrue(LogLevel::Info == decoded.level);
+		Assert::AreEqual(std::string("signed -5, unsigned 18446744073709551615, bool true"), decoded.message);
+	}
+
+	TEST_METHOD(DecodeStrings)
+	{
+		std::string narrow("adapter");
+
+		const auto record = EncodeRecord(&StringFormat, narrow, L"wide");
+
+		//
+		// The argument is copied into the record.
+		//
+		narrow = "changed";
+
+		const auto decoded = DecodeRecord(common::ConstBufferView(record.data(), record.size()));
+
+		Assert::AreEqual(std::string("narrow 'adapter', wide 'wide'"), decoded.message);
+	}
+
+	TEST_METHOD(DecodeEscapesAndMissingArguments)
+	{
+		static constexpr LogFormat format{ LogLevel::Error, "{{literal}} {} {}" };
+
+		const auto record = EncodeRecord(&format, 1);
+		const auto decoded = DecodeRecord(common::ConstBufferView(record.data(), record.size()));
+
+		Assert::AreEqual(std::string("{literal} 1 {?}"), decoded.message);
+	}
+
+	TEST_METHOD(DecodeWithResolver)
+	{
+		const auto record = EncodeRecord(&IntegerFormat, 1, 2u, false);
+
+		const auto decoded = DecodeRecord(common::ConstBufferView(record.data(), record.size()),
+			[](uint64_t id) -> const LogFormat *
+		{
+			return (reinterpret_cast<uintptr_t>(&IntegerFormat) == id ? &IntegerFormat : nullptr);
+		});
+
+		Assert::AreEqual(std::string("signed 1, unsigned 2, bool false"), decoded.message);
+
+		Assert::ExpectException<std::runtime_error>([&]()
+		{
+			DecodeRecord(common::ConstBufferView(record.data(), record.size()),
+				[](uint64_t) -> const LogFormat * { return nullptr; });
+		});
+	}
+
+	TEST_METHOD(TruncatedRecordThrows)
+	{
+		const auto record = EncodeRecord(&StringFormat, "narrow", L"wide");
+
+		Assert::ExpectException<std::runtime_error>([&]()
+		{
+			DecodeRecord(common::ConstBufferView(record.data(), record.size() - 1));
+		});
+	}
+
+	TEST_METHOD(LoggerForwardsInOrder)
+	{
+		auto sink = std::make_shared<RecordingSink>();
+		DeferredLogger logger(sink);
+
+		for (int i = 0; i < 1000; ++i)
+		{
+			LOG_DEFERRED(&logger, LogLevel::Debug, "record {}", i);
+		}
+
+		logger.flush();
+
+		const auto records = sink->records();
+
+		Assert::AreEqual(size_t(1000), records.size());
+
+		for (int i = 0; i < 1000; ++i)
+		{
+			Assert::IsTrue(LogLevel::Debug == records[i].level);
+			Assert::AreEqual("record " + std::to_string(i), records[i].message);
+		}
+	}
+
+	TEST_METHOD(DisabledLevelSkipsArguments)
+	{
+		auto sink = std::make_shared<RecordingSink>();
+		DeferredLogger logger(sink);
+
+		int evaluations = 0;
+
+		const auto expensive = [&evaluations]()
+		{
+			++evaluations;
+			return 1;
+		};
+
+		LOG_DEFERRED(&logger, LogLevel::Trace, "value {}", expensive());
+		LOG_DEFERRED(&logger, LogLevel::Error, "no arguments");
+
+		logger.flush();
+
+		Assert::AreEqual(0, evaluations);
+		Assert::AreEqual(size_t(1), sink->records().size());
+	}
+
+	TEST_METHOD(NearlyFullRingIsNotPadded)
+	{
+		auto sink = std::make_shared<RecordingSink>();
+
+		DeferredLogger logger(sink, 64);
+
+		//
+		// Frames are 16 bytes for "short" and 24 bytes for "long".
+		//
+		LOG_DEFERRED(&logger, LogLevel::Info, "long {}", true);
+		LOG_DEFERRED(&logger, LogLevel::Info, "long {}", true);
+		logger.flush();
+
+		//
+		// Hold the consumer at the frame in [48, 64).
+		//
+		sink->allow(2);
+		LOG_DEFERRED(&logger, LogLevel::Info, "short");
+		sink->waitForRecords(3);
+
+		//
+		// Fill [0, 40), which leaves 8 bytes of free space short of the wrap point.
+		//
+		LOG_DEFERRED(&logger, LogLevel::Info, "long {}", true);
+		LOG_DEFERRED(&logger, LogLevel::Info, "short");
+		LOG_DEFERRED(&logger, LogLevel::Info, "long {}", true);
+
+		Assert::AreEqual(uint64_t(1), logger.dropped());
+
+		//
+		// Once [48, 64) is consumed, [40, 64) is free.
+		//
+		sink->allow(3);
+		sink->waitForRecords(4);
+
+		LOG_DEFERRED(&logger, LogLevel::Info, "long {}", true);
+
+		Assert::AreEqual(uint64_t(1), logger.dropped());
+
+		sink->allow(SIZE_MAX);
+		logger.flush();
+
+		Assert::AreEqual(size_t(6), sink->records().size());
+	}
+
+	TEST_METHOD(ThreadsKeepTheirOrder)
+	{
+		auto sink = std::make_shared<RecordingSink>();
+		DeferredLogger logger(sink);
+
+		std::vector<std::thread> threads;
+
+		for (int i = 0; i < 4; ++i)
+		{
+			threads.emplace_back([&logger, i]()
+			{
+				for (int j = 0; j < 1000; ++j)
+				{
+					LOG_DEFERRED(&logger, LogLevel::Info, "{} {}", i, j);
+				}
+			});
+		}
+
+		for (auto &thread : threads)
+		{
+			thread.join();
+		}
+
+		logger.flush();
+
+		Assert::AreEqual(uint64_t(0), logger.dropped());
+
+		int next[4] = { 0 };
+
+		for (const auto &record : sink->records())
+		{
+			const auto thread = std::stoi(record.message);
+			const auto sequence = std::stoi(record.message.substr(record.message.find(' ') + 1));
+
+			Assert::AreEqual(next[thread]++, sequence);
+		}
+
+		for (int i = 0; i < 4; ++i)
+		{
+			Assert::AreEqual(1000, next[i]);
+		}
+	}
+
+	TEST_METHOD(RecordsWrapAroundRing)
+	{
+		auto sink = std::make_shared<RecordingSink>();
+
+		size_t logged = 0;
+
+		{
+			DeferredLogger logger(sink, 256);
+
+			std::vector<std::thread> threads;
+
+			for (int i = 0; i < 4; ++i)
+			{
+				threads.emplace_back([&logger]()
+				{
+					for (int j = 0; j < 10000; ++j)
+					{
+						LOG_DEFERRED(&logger, LogLevel::Info, "{} {}", j, "padding to vary the frame size" + std::string(j % 13, 'x'));
+					}
+				});
+			}
+
+			for (auto &thread : threads)
+			{
+				thread.join();
+			}
+
+			logged = 40000 - static_cast<size_t>(logger.dropped());
+		}
+
+		//
+		// The destructor delivers whatever is still queued.
+		//
+		Assert::AreEqual(logged, sink->records().size());
+	}
+};
+
+}
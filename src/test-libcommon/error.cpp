@@ -0,0 +1,106 @@
+#include "pch.h"
+#include "libcommon/error.h"
+#include "CppUnitTest.h"
+#include <stdexcept>
+#include <string>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using common::error::WindowsException;
+
+namespace testlibcommon
+{
+
+namespace
+{
+
+bool StartsWith(const std::string &text, const std::string &prefix)
+{
+	return 0 == text.compare(0, prefix.size(), prefix);
+}
+
+bool EndsWith(const std::string &text, const std::string &suffix)
+{
+	return text.size() >= suffix.size()
+		&& 0 == text.compare(text.size() - suffix.size(), suffix.size(), suffix);
+}
+
+} // anonymous namespace
+
+TEST_CLASS(TestLibCommonError)
+{
+public:
+
+	TEST_METHOD(WindowsErrorMessageIsFormattedOnDemand)
+	{
+		const WindowsException err("Read registry value", ERROR_FILE_NOT_FOUND, "c:\\src\\registrykey.cpp", 42);
+
+		Assert::AreEqual(DWORD(ERROR_FILE_NOT_FOUND), err.errorCode());
+
+		const std::string message(err.what());
+
+		Assert::IsTrue(StartsWith(message, "Read registry value: 0x00000002: "));
+		Assert::IsTrue(EndsWith(message, " (registrykey.cpp: 42)"));
+	}
+
+	TEST_METHOD(WindowsErrorMessageIsSharedBetweenCopies)
+	{
+		const WindowsException err("Open registry key", ERROR_ACCESS_DENIED, __FILE__, __LINE__);
+		const auto copy = err;
+
+		const auto message = copy.what();
+
+		Assert::IsTrue(message == err.what());
+		Assert::IsTrue(message == copy.what());
+	}
+
+	TEST_METHOD(ThrowWindowsErrorNestsCurrentException)
+	{
+		bool nestedCaught = false;
+
+		try
+		{
+			try
+			{
+				THROW_ERROR("Outer failure");
+			}
+			catch (...)
+			{
+				THROW_WINDOWS_ERROR(ERROR_INVALID_PARAMETER, "Inner operation");
+			}
+		}
+		catch (const WindowsException &err)
+		{
+			Assert::AreEqual(DWORD(ERROR_INVALID_PARAMETER), err.errorCode());
+			Assert::IsTrue(StartsWith(err.what(), "Inner operation: 0x00000057: "));
+
+			try
+			{
+				std::rethrow_if_nested(err);
+			}
+			catch (const std::runtime_error &nested)
+			{
+				Assert::IsTrue(StartsWith(nested.what(), "Outer failure (error.cpp: "));
+				nestedCaught = true;
+			}
+		}
+
+		Assert::IsTrue(nestedCaught);
+	}
+
+	TEST_METHOD(ThrowErrorAppendsLocation)
+	{
+		try
+		{
+			THROW_ERROR("Something failed");
+		}
+		catch (const std::runtime_error &err)
+		{
+			const std::string message(err.what());
+
+			Assert::IsTrue(StartsWith(message, "Something failed (error.cpp: "));
+			Assert::IsTrue(EndsWith(message, ")"));
+		}
+	}
+};
+
+}
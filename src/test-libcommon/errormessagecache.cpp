@@ -0,0 +1,107 @@
+#include "pch.h"
+#include "libcommon/errormessagecache.h"
+#include "CppUnitTest.h"
+#include <atomic>
+#include <cerrno>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using common::error::ErrorMessageCache;
+
+namespace testlibcommon
+{
+
+TEST_CLASS(TestLibCommonErrorMessageCache)
+{
+public:
+
+	TEST_METHOD(MessageIsFormattedOnce)
+	{
+		size_t calls = 0;
+
+		ErrorMessageCache cache([&calls](uint32_t code)
+		{
+			++calls;
+			return "Error " + std::to_string(code);
+		});
+
+		Assert::AreEqual(std::string("Error 5"), cache.message(5));
+		Assert::AreEqual(std::string("Error 5"), cache.message(5));
+		Assert::AreEqual(std::string("Error 6"), cache.message(6));
+
+		Assert::AreEqual(size_t(2), calls);
+		Assert::AreEqual(size_t(2), cache.size());
+	}
+
+	TEST_METHOD(CacheIsBounded)
+	{
+		size_t calls = 0;
+
+		ErrorMessageCache cache([&calls](uint32_t code)
+		{
+			++calls;
+			return std::to_string(code);
+		}, 2);
+
+		cache.message(1);
+		cache.message(2);
+
+		Assert::AreEqual(std::string("3"), cache.message(3));
+		Assert::AreEqual(std::string("3"), cache.message(3));
+		Assert::AreEqual(std::string("1"), cache.message(1));
+
+		Assert::AreEqual(size_t(4), calls);
+		Assert::AreEqual(size_t(2), cache.size());
+	}
+
+	TEST_METHOD(StandardErrorBackend)
+	{
+		ErrorMessageCache cache(common::error::FormatStandardError);
+
+		const auto message = cache.message(ENOENT);
+
+		Assert::IsFalse(message.empty());
+		Assert::AreEqual(message, common::error::FormatStandardError(ENOENT));
+	}
+
+	TEST_METHOD(ConcurrentLookups)
+	{
+		std::atomic<size_t> calls = 0;
+
+		ErrorMessageCache cache([&calls](uint32_t code)
+		{
+			++calls;
+			return std::to_string(code);
+		});
+
+		std::vector<std::thread> threads;
+
+		for (int i = 0; i < 4; ++i)
+		{
+			threads.emplace_back([&cache]()
+			{
+				for (uint32_t j = 0; j < 10000; ++j)
+				{
+					const auto code = j % 32;
+					Assert::AreEqual(std::to_string(code), cache.message(code));
+				}
+			});
+		}
+
+		for (auto &thread : threads)
+		{
+			thread.join();
+		}
+
+		Assert::AreEqual(size_t(32), cache.size());
+
+		//
+		// Racing threads may format the same code, but never more than once each.
+		//
+		Assert::IsTrue(calls <= 32 * 4);
+	}
+};
+
+}
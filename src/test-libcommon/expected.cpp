@@ -0,0 +1,108 @@
+#include "pch.h"
+#include "libcommon/expected.h"
+#include "CppUnitTest.h"
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using common::Expected;
+
+namespace testlibcommon
+{
+
+namespace
+{
+
+Expected<int> Parse(const std::string &text)
+{
+	if (text.empty())
+	{
+		return MAKE_ERROR("Empty input");
+	}
+
+	if (text == "denied")
+	{
+		return MAKE_WINDOWS_ERROR(ERROR_ACCESS_DENIED, "Read input");
+	}
+
+	return std::stoi(text);
+}
+
+} // anonymous namespace
+
+TEST_CLASS(TestLibCommonExpected)
+{
+public:
+
+	TEST_METHOD(HoldsValue)
+	{
+		const auto result = Parse("42");
+
+		Assert::IsTrue(result.hasValue());
+		Assert::IsTrue(static_cast<bool>(result));
+		Assert::AreEqual(42, result.value());
+	}
+
+	TEST_METHOD(HoldsError)
+	{
+		const auto result = Parse("");
+
+		Assert::IsFalse(result.hasValue());
+		Assert::AreEqual(std::string("Empty input"), std::string(result.error().operation));
+		Assert::IsFalse(result.error().system);
+		Assert::AreEqual(DWORD(0), result.error().code);
+	}
+
+	TEST_METHOD(SystemErrorWithoutCodeThrowsWindowsException)
+	{
+		//
+		// E.g. an API that failed without setting the last error.
+		//
+		Expected<int> result = MAKE_WINDOWS_ERROR(0, "Read input");
+
+		Assert::IsTrue(result.error().system);
+
+		Assert::ExpectException<common::error::WindowsException>([&result]()
+		{
+			result.value();
+		});
+	}
+
+	TEST_METHOD(ValueThrowsError)
+	{
+		Assert::ExpectException<std::runtime_error>([]()
+		{
+			Parse("").value();
+		});
+
+		bool caught = false;
+
+		try
+		{
+			Parse("denied").value();
+		}
+		catch (const common::error::WindowsException &err)
+		{
+			const std::string prefix("Read input: 0x00000005: ");
+
+			Assert::AreEqual(DWORD(ERROR_ACCESS_DENIED), err.errorCode());
+			Assert::AreEqual(prefix, std::string(err.what()).substr(0, prefix.size()));
+
+			caught = true;
+		}
+
+		Assert::IsTrue(caught);
+	}
+
+	TEST_METHOD(MoveOnlyValue)
+	{
+		Expected<std::unique_ptr<int>> result(std::make_unique<int>(7));
+
+		const auto value = std::move(result).value();
+
+		Assert::AreEqual(7, *value);
+	}
+};
+
+}
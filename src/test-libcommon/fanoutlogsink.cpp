@@ -0,0 +1,147 @@
+#include "pch.h"
+#include "libcommon/logging/fanoutlogsink.h"
+#include "CppUnitTest.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std::chrono_literals;
+using common::logging::FanOutLogSink;
+using common::logging::LogLevel;
+
+namespace testlibcommon
+{
+
+TEST_CLASS(TestLibCommonFanOutLogSink)
+{
+public:
+
+	TEST_METHOD(NoTargetsDisablesAllLevels)
+	{
+		FanOutLogSink sink;
+
+		Assert::IsFalse(sink.enabled(LogLevel::Error));
+
+		sink.error("discarded");
+	}
+
+	TEST_METHOD(EachTargetHasItsOwnLevel)
+	{
+		FanOutLogSink sink;
+
+		std::vector<std::string> verbose;
+		std::vector<std::string> quiet;
+
+		sink.addTarget([&verbose](LogLevel, const char *msg) { verbose.push_back(msg); });
+		sink.addTarget([&quiet](LogLevel, const char *msg) { quiet.push_back(msg); }, LogLevel::Warning);
+
+		sink.error("error");
+		sink.info("info");
+		sink.trace("trace");
+
+		Assert::AreEqual(size_t(3), verbose.size());
+		Assert::AreEqual(size_t(1), quiet.size());
+		Assert::AreEqual(std::string("error"), quiet[0]);
+	}
+
+	TEST_METHOD(EnabledFollowsMostVerboseTarget)
+	{
+		FanOutLogSink sink;
+
+		const auto first = sink.addTarget([](LogLevel, const char *) {}, LogLevel::Warning);
+
+		Assert::IsTrue(sink.enabled(LogLevel::Warning));
+		Assert::IsFalse(sink.enabled(LogLevel::Info));
+
+		const auto second = sink.addTarget([](LogLevel, const char *) {}, LogLevel::Info);
+
+		Assert::IsTrue(sink.enabled(LogLevel::Info));
+		Assert::IsFalse(sink.enabled(LogLevel::Debug));
+
+		Assert::IsTrue(sink.setTargetLevel(first, LogLevel::Trace));
+		Assert::IsTrue(sink.enabled(LogLevel::Trace));
+
+		Assert::IsTrue(sink.removeTarget(first));
+		Assert::IsFalse(sink.enabled(LogLevel::Debug));
+
+		Assert::IsTrue(sink.removeTarget(second));
+		Assert::IsFalse(sink.removeTarget(second));
+		Assert::IsFalse(sink.setTargetLevel(second, LogLevel::Error));
+		Assert::IsFalse(sink.enabled(LogLevel::Error));
+	}
+
+	TEST_METHOD(TargetRemovedWhileLoggingIsDestroyedAfterwards)
+	{
+		FanOutLogSink sink;
+
+		auto alive = std::make_shared<int>(0);
+		std::weak_ptr<int> observer = alive;
+
+		FanOutLogSink::TargetId id = 0;
+		bool aliveWhenRemoved = false;
+
+		id = sink.addTarget([&, alive](LogLevel, const char *)
+		{
+			sink.removeTarget(id);
+			aliveWhenRemoved = (false == observer.expired());
+		});
+
+		alive.reset();
+
+		sink.info("message");
+
+		Assert::IsTrue(aliveWhenRemoved);
+		Assert::IsTrue(observer.expired());
+	}
+
+	TEST_METHOD(TargetsChangeWhileLogging)
+	{
+		FanOutLogSink sink;
+
+		std::atomic<size_t> permanentCount = 0;
+		std::atomic<size_t> transientCount = 0;
+
+		sink.addTarget([&permanentCount](LogLevel, const char *) { ++permanentCount; });
+
+		std::atomic<bool> stop = false;
+		std::vector<std::thread> loggers;
+
+		for (int i = 0; i < 4; ++i)
+		{
+			loggers.emplace_back([&]()
+			{
+				for (int j = 0; j < 20000; ++j)
+				{
+					sink.info("message");
+				}
+			});
+		}
+
+		std::thread updater([&]()
+		{
+			while (false == stop)
+			{
+				const auto id = sink.addTarget([&transientCount](LogLevel, const char *) { ++transientCount; });
+				std::this_thread::yield();
+				sink.removeTarget(id);
+			}
+		});
+
+		for (auto &logger : loggers)
+		{
+			logger.join();
+		}
+
+		stop = true;
+		updater.join();
+
+		Assert::AreEqual(size_t(80000), permanentCount.load());
+		Assert::IsTrue(transientCount.load() <= 80000);
+	}
+};
+
+}
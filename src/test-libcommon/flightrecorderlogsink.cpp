@@ -0,0 +1,276 @@
+#include "pch.h"
+#include "libcommon/logging/flightrecorderlogsink.h"
+#include "logrecorder.h"
+#include "CppUnitTest.h"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std::chrono_literals;
+using common::logging::FlightRecorderLogSink;
+using common::logging::LogLevel;
+
+namespace testlibcommon
+{
+
+namespace
+{
+
+//
+// Message text without the timestamp and thread prefix.
+//
+std::string MessageText(const std::string &message)
+{
+	return message.substr(message.find("] ") + 2);
+}
+
+} // anonymous namespace
+
+TEST_CLASS(TestLibCommonFlightRecorderLogSink)
+{
+public:
+
+	TEST_METHOD(MessagesAreOnlyWrittenOnDump)
+	{
+		ClockedLogRecorder recorder;
+		FlightRecorderLogSink sink(recorder.target(), recorder.options<FlightRecorderLogSink::Options>());
+
+		sink.info("first");
+		recorder.clock->advance(1500ms);
+		sink.warning("second");
+
+		Assert::IsTrue(recorder.messages().empty());
+
+		sink.dump();
+
+		const auto records = recorder.records();
+
+		Assert::AreEqual(size_t(2), records.size());
+		Assert::AreEqual(std::string("first"), MessageText(records[0].message));
+		Assert::AreEqual(std::string("second"), MessageText(records[1].message));
+		Assert::IsTrue(LogLevel::Warning == records[1].level);
+		Assert::AreEqual(size_t(0), records[1].message.find("[1.500000]"));
+	}
+
+	TEST_METHOD(DumpOnlyIncludesNewMessages)
+	{
+		ClockedLogRecorder recorder;
+		FlightRecorderLogSink sink(recorder.target(), recorder.options<FlightRecorderLogSink::Options>());
+
+		sink.debug("first");
+		sink.dump();
+		sink.dump();
+
+		Assert::AreEqual(size_t(1), recorder.messages().size());
+
+		sink.debug("second");
+		sink.dump();
+
+		Assert::AreEqual(size_t(2), recorder.messages().size());
+		Assert::AreEqual(std::string("second"), MessageText(recorder.messages()[1]));
+	}
+
+	TEST_METHOD(ErrorTriggersDump)
+	{
+		ClockedLogRecorder recorder;
+
+		{
+			FlightRecorderLogSink sink(recorder.target(), recorder.options<FlightRecorderLogSink::Options>());
+
+			sink.trace("context");
+			sink.error("failure");
+
+			Assert::AreEqual(size_t(2), recorder.messages().size());
+			Assert::AreEqual(std::string("failure"), MessageText(recorder.messages()[1]));
+		}
+
+		recorder.clear();
+
+		auto options = recorder.options<FlightRecorderLogSink::Options>();
+		options.dumpOnError = false;
+
+		FlightRecorderLogSink sink(recorder.target(), options);
+
+		sink.error("failure");
+
+		Assert::IsTrue(recorder.messages().empty());
+	}
+
+	TEST_METHOD(RingKeepsNewestMessages)
+	{
+		ClockedLogRecorder recorder;
+
+		auto options = recorder.options<FlightRecorderLogSink::Options>();
+		options.entriesPerThread = 4;
+
+		FlightRecorderLogSink sink(recorder.target(), options);
+
+		for (int i = 0; i < 10; ++i)
+		{
+			recorder.clock->advance(1ms);
+			sink.info(std::to_string(i).c_str());
+		}
+
+		sink.dump();
+
+		const auto messages = recorder.messages();
+
+		Assert::AreEqual(size_t(4), messages.size());
+		Assert::AreEqual(std::string("6"), MessageText(messages[0]));
+		Assert::AreEqual(std::string("9"), MessageText(messages[3]));
+	}
+
+	TEST_METHOD(LongMessagesAreTruncated)
+	{
+		ClockedLogRecorder recorder;
+
+		auto options = recorder.options<FlightRecorderLogSink::Options>();
+		options.maximumMessageLength = 8;
+
+		FlightRecorderLogSink sink(recorder.target(), options);
+
+		sink.info("0123456789");
+		sink.dump();
+
+		Assert::AreEqual(std::string("0123456"), MessageText(recorder.messages()[0]));
+	}
+
+	TEST_METHOD(ThreadsAreMergedInTimestampOrder)
+	{
+		ClockedLogRecorder recorder;
+		FlightRecorderLogSink sink(recorder.target(), recorder.options<FlightRecorderLogSink::Options>());
+
+		sink.info("main 1");
+		recorder.clock->advance(1ms);
+
+		std::thread([&]()
+		{
+			sink.info("worker 1");
+			recorder.clock->advance(1ms);
+		}).join();
+
+		sink.info("main 2");
+		recorder.clock->advance(1ms);
+
+		std::thread([&]()
+		{
+			sink.info("worker 2");
+		}).join();
+
+		sink.dump();
+
+		const auto messages = recorder.messages();
+
+		Assert::AreEqual(size_t(4), messages.size());
+		Assert::AreEqual(std::string("main 1"), MessageText(messages[0]));
+		Assert::AreEqual(std::string("worker 1"), MessageText(messages[1]));
+		Assert::AreEqual(std::string("main 2"), MessageText(messages[2]));
+		Assert::AreEqual(std::string("worker 2"), MessageText(messages[3]));
+	}
+
+	TEST_METHOD(ReusedRingKeepsThreadOfEachMessage)
+	{
+		ClockedLogRecorder recorder;
+		FlightRecorderLogSink sink(recorder.target(), recorder.options<FlightRecorderLogSink::Options>());
+
+		DWORD firstThread = 0;
+		DWORD secondThread = 0;
+
+		//
+		// The second thread takes over the ring of the first one
+		// before its message has been dumped.
+		//
+		std::thread([&]()
+		{
+			firstThread = GetCurrentThreadId();
+			sink.info("first");
+			recorder.clock->advance(1ms);
+		}).join();
+
+		std::thread([&]()
+		{
+			secondThread = GetCurrentThreadId();
+			sink.info("second");
+		}).join();
+
+		sink.dump();
+
+		const auto messages = recorder.messages();
+
+		const auto withoutTimestamp = [&messages](size_t index)
+		{
+			return messages[index].substr(messages[index].find("][") + 1);
+		};
+
+		Assert::AreEqual(size_t(2), messages.size());
+		Assert::AreEqual("[" + std::to_string(firstThread) + "] first", withoutTimestamp(0));
+		Assert::AreEqual("[" + std::to_string(secondThread) + "] second", withoutTimestamp(1));
+	}
+
+	TEST_METHOD(ConcurrentRecordingWhileDumping)
+	{
+		LogRecorder recorder;
+
+		FlightRecorderLogSink::Options options;
+		options.entriesPerThread = 64;
+		options.dumpOnError = false;
+
+		FlightRecorderLogSink sink(recorder.target(), options);
+
+		std::vector<std::thread> threads;
+
+		for (int i = 0; i < 4; ++i)
+		{
+			threads.emplace_back([&sink, i]()
+			{
+				for (int j = 0; j < 10000; ++j)
+				{
+					sink.trace((std::to_string(i) + " " + std::to_string(j)).c_str());
+				}
+			});
+		}
+
+		for (int i = 0; i < 100; ++i)
+		{
+			sink.dump();
+		}
+
+		for (auto &thread : threads)
+		{
+			thread.join();
+		}
+
+		sink.dump();
+
+		//
+		// Messages may be lost to overwrites, but those that are written
+		// appear once each and in the order each thread logged them.
+		//
+		const auto messages = recorder.messages();
+
+		std::vector<int> previous(4, -1);
+
+		for (const auto &message : messages)
+		{
+			const auto text = MessageText(message);
+			const auto separator = text.find(' ');
+
+			Assert::IsTrue(std::string::npos != separator);
+
+			const auto thread = std::stoi(text.substr(0, separator));
+			const auto sequence = std::stoi(text.substr(separator + 1));
+
+			Assert::IsTrue(thread >= 0 && thread < 4);
+			Assert::IsTrue(sequence > previous[thread]);
+
+			previous[thread] = sequence;
+		}
+
+		Assert::IsTrue(messages.size() <= 4 * 10000);
+	}
+};
+
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "libcommon/logging/logsink.h"
+#include "libcommon/virtualtime.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace testlibcommon
+{
+
+struct LogRecord
+{
+	common::logging::LogLevel level;
+	std::string message;
+};
+
+//
+// Collects the messages passed to its log target, in order.
+// The target may be invoked from any thread.
+//
+class LogRecorder
+{
+public:
+
+	common::logging::LogTarget target()
+	{
+		return [this](common::logging::LogLevel level, const char *msg)
+		{
+			std::scoped_lock<std::mutex> lock(m_mutex);
+			m_records.push_back(LogRecord{ level, msg });
+		};
+	}
+
+	//
+	// Log sink that forwards to the target.
+	//
+	std::shared_ptr<common::logging::LogSink> sink()
+	{
+		return std::make_shared<common::logging::LogSink>(target());
+	}
+
+	std::vector<LogRecord> records() const
+	{
+		std::scoped_lock<std::mutex> lock(m_mutex);
+		return m_records;
+	}
+
+	std::vector<std::string> messages() const
+	{
+		std::scoped_lock<std::mutex> lock(m_mutex);
+
+		std::vector<std::string> result;
+
+		for (const auto &record : m_records)
+		{
+			result.push_back(record.message);
+		}
+
+		return result;
+	}
+
+	void clear()
+	{
+		std::scoped_lock<std::mutex> lock(m_mutex);
+		m_records.clear();
+	}
+
+private:
+
+	mutable std::mutex m_mutex;
+	std::vector<LogRecord> m_records;
+};
+
+//
+// Log recorder with a virtual clock, for sinks that are passed a clock in their options.
+//
+class ClockedLogRecorder : public LogRecorder
+{
+public:
+
+	ClockedLogRecorder()
+		: clock(std::make_shared<common::VirtualClock>())
+	{
+	}
+
+	//
+	// Default options using the virtual clock.
+	//
+	template<typename Options>
+	Options options() const
+	{
+		Options result;
+		result.clock = clock;
+
+		return result;
+	}
+
+	const std::shared_ptr<common::VirtualClock> clock;
+};
+
+}
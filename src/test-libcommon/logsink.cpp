@@ -0,0 +1,118 @@
+#include "pch.h"
+#include "libcommon/logging/logsink.h"
+#include "libcommon/logging/logmacros.h"
+#include "logrecorder.h"
+#include "CppUnitTest.h"
+#include <string>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using common::logging::LogLevel;
+using common::logging::LogSink;
+
+namespace testlibcommon
+{
+
+TEST_CLASS(TestLibCommonLogSink)
+{
+public:
+
+	TEST_METHOD(AllLevelsEnabledByDefault)
+	{
+		LogRecorder recorder;
+		auto sink = recorder.sink();
+
+		Assert::IsTrue(sink->enabled(LogLevel::Error));
+		Assert::IsTrue(sink->enabled(LogLevel::Trace));
+
+		sink->trace("trace");
+
+		Assert::AreEqual(size_t(1), recorder.records().size());
+	}
+
+	TEST_METHOD(MinimumLevelFiltersMessages)
+	{
+		LogRecorder recorder;
+		auto sink = recorder.sink();
+
+		sink->setMinimumLevel(LogLevel::Info);
+
+		Assert::IsTrue(sink->enabled(LogLevel::Error));
+		Assert::IsTrue(sink->enabled(LogLevel::Warning));
+		Assert::IsTrue(sink->enabled(LogLevel::Info));
+		Assert::IsFalse(sink->enabled(LogLevel::Debug));
+		Assert::IsFalse(sink->enabled(LogLevel::Trace));
+
+		sink->error("error");
+		sink->info("info");
+		sink->debug("debug");
+		sink->trace("trace");
+
+		const auto records = recorder.records();
+
+		Assert::AreEqual(size_t(2), records.size());
+		Assert::IsTrue(LogLevel::Error == records[0].level);
+		Assert::IsTrue(LogLevel::Info == records[1].level);
+	}
+
+	TEST_METHOD(MacroFormatsEnabledMessage)
+	{
+		LogRecorder recorder;
+		auto sink = recorder.sink();
+
+		LOG_WARNING(sink, "value " << 42 << ", name " << std::string("adapter"));
+
+		const auto records = recorder.records();
+
+		Assert::AreEqual(size_t(1), records.size());
+		Assert::IsTrue(LogLevel::Warning == records[0].level);
+		Assert::AreEqual(std::string("value 42, name adapter"), records[0].message);
+	}
+
+	TEST_METHOD(MacroSkipsEvaluationWhenDisabled)
+	{
+		LogRecorder recorder;
+		auto sink = recorder.sink();
+
+		sink->setMinimumLevel(LogLevel::Warning);
+
+		int evaluations = 0;
+
+		const auto expensive = [&evaluations]()
+		{
+			++evaluations;
+			return std::string("expensive");
+		};
+
+		LOG_TRACE(sink, "trace " << expensive());
+		LOG_DEBUG(sink, "debug " << expensive());
+
+		Assert::AreEqual(0, evaluations);
+		Assert::IsTrue(recorder.records().empty());
+
+		LOG_ERROR(sink, "error " << expensive());
+
+		Assert::AreEqual(1, evaluations);
+		Assert::AreEqual(std::string("error expensive"), recorder.records()[0].message);
+	}
+
+	TEST_METHOD(MacroEvaluatesSinkOnce)
+	{
+		LogRecorder recorder;
+		auto sink = recorder.sink();
+
+		int evaluations = 0;
+
+		const auto getSink = [&]()
+		{
+			++evaluations;
+			return sink;
+		};
+
+		LOG_INFO(getSink(), "message");
+
+		Assert::AreEqual(1, evaluations);
+		Assert::AreEqual(size_t(1), recorder.records().size());
+	}
+};
+
+}
@@ -34,6 +34,14 @@ public:
 			sizeof(size_t) * 2
 		);
 	}
+
+	TEST_METHOD(RoundPowerTwoByOne)
+	{
+		Assert::AreEqual(
+			::common::math::RoundPowerTwo(size_t(7), size_t(1)),
+			size_t(7)
+		);
+	}
 };
 
 }
@@ -0,0 +1,267 @@
+#include "pch.h"
+#include "libcommon/memory.h"
+#include "CppUnitTest.h"
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace
+{
+
+struct CountingTraits
+{
+	using Type = int;
+
+	static Type Invalid()
+	{
+		return -1;
+	}
+
+	static bool IsValid(Type value)
+	{
+		return value >= 0;
+	}
+
+	static void Close(Type)
+	{
+		++Closed;
+	}
+
+	static size_t Closed;
+};
+
+size_t CountingTraits::Closed = 0;
+
+using UniqueCounted = common::memory::UniqueResource<CountingTraits>;
+
+//
+// What a guard holding `Operation` amounts to if the operation is stored inline.
+//
+template<typename Operation>
+struct InlineGuard
+{
+	Operation operation;
+	bool active;
+};
+
+template<typename Operation>
+constexpr bool IsInlineGuard()
+{
+	using Guard = common::memory::ScopeGuard<Operation>;
+
+	return sizeof(Guard) == sizeof(InlineGuard<Operation>)
+		&& std::is_nothrow_constructible_v<Guard, Operation>;
+}
+
+} // anonymous namespace
+
+namespace testlibcommon
+{
+
+TEST_CLASS(TestLibCommonMemory)
+{
+public:
+
+	TEST_METHOD(ScopeGuardRunsOperation)
+	{
+		bool ran = false;
+
+		{
+			common::memory::ScopeGuard guard([&ran]()
+			{
+				ran = true;
+			});
+
+			Assert::IsFalse(ran);
+		}
+
+		Assert::IsTrue(ran);
+	}
+
+	TEST_METHOD(ScopeGuardDismissed)
+	{
+		bool ran = false;
+
+		{
+			common::memory::ScopeGuard guard([&ran]()
+			{
+				ran = true;
+			});
+
+			guard.dismiss();
+		}
+
+		Assert::IsFalse(ran);
+	}
+
+	TEST_METHOD(ScopeGuardDoesNotAllocate)
+	{
+		HANDLE handles[4] = { nullptr };
+		size_t released = 0;
+
+		const auto first = [&released, handle = handles[0]]()
+		{
+			released += (nullptr == handle ? 1 : 0);
+		};
+
+		const auto second = [&released, &handles]()
+		{
+			for (const auto handle : handles)
+			{
+				released += (nullptr == handle ? 1 : 0);
+			}
+		};
+
+		//
+		// The guard is the operation plus a flag, and constructing it cannot throw,
+		// so there is no room for a heap allocation.
+		//
+		static_assert(IsInlineGuard<std::remove_const_t<decltype(first)> >());
+		static_assert(IsInlineGuard<std::remove_const_t<decltype(second)> >());
+
+		{
+			common::memory::ScopeGuard firstGuard(first);
+			common::memory::ScopeGuard secondGuard(second);
+		}
+
+		Assert::AreEqual(size_t(5), released);
+	}
+
+	TEST_METHOD(UniqueResourceClosesOnce)
+	{
+		CountingTraits::Closed = 0;
+
+		{
+			UniqueCounted resource(1);
+			UniqueCounted moved(std::move(resource));
+
+			Assert::IsFalse(static_cast<bool>(resource));
+			Assert::IsTrue(static_cast<bool>(moved));
+		}
+
+		Assert::AreEqual(size_t(1), CountingTraits::Closed);
+	}
+
+	TEST_METHOD(UniqueResourceReceiveClosesPrevious)
+	{
+		CountingTraits::Closed = 0;
+
+		UniqueCounted resource(1);
+
+		*resource.receive() = 2;
+
+		Assert::AreEqual(size_t(1), CountingTraits::Closed);
+		Assert::AreEqual(2, resource.get());
+
+		Assert::AreEqual(2, resource.release());
+		Assert::AreEqual(size_t(1), CountingTraits::Closed);
+	}
+
+	TEST_METHOD(UniqueKernelHandleIsInline)
+	{
+		static_assert(sizeof(common::memory::UniqueKernelHandle) == sizeof(HANDLE));
+		static_assert(std::is_nothrow_constructible_v<common::memory::UniqueKernelHandle, HANDLE>);
+		static_assert(std::is_nothrow_move_constructible_v<common::memory::UniqueKernelHandle>);
+
+		common::memory::UniqueKernelHandle event(CreateEventW(nullptr, TRUE, FALSE, nullptr));
+
+		Assert::IsTrue(static_cast<bool>(event));
+	}
+
+	TEST_METHOD(ScopeDestructorRunsInReverseOrder)
+	{
+		std::vector<int> order;
+		order.reserve(2);
+
+		{
+			common::memory::ScopeDestructor sd;
+
+			sd += [&order]()
+			{
+				order.push_back(1);
+			};
+
+			sd += [&order]()
+			{
+				order.push_back(2);
+			};
+		}
+
+		Assert::AreEqual(size_t(2), order.size());
+		Assert::AreEqual(2, order[0]);
+		Assert::AreEqual(1, order[1]);
+	}
+
+	TEST_METHOD(ByteSwapScalar)
+	{
+		static_assert(0x3412 == common::memory::ByteSwap(uint16_t(0x1234)));
+		static_assert(0x78563412 == common::memory::ByteSwap(uint32_t(0x12345678)));
+		static_assert(0x0807060504030201 == common::memory::ByteSwap(uint64_t(0x0102030405060708)));
+
+		volatile uint32_t value = 0x12345678;
+
+		Assert::AreEqual(uint32_t(0x78563412), common::memory::ByteSwap(uint32_t(value)));
+	}
+
+	TEST_METHOD(ByteSwapBulkUnaligned)
+	{
+		uint8_t source[128 + 1];
+
+		for (size_t i = 0; i < sizeof(source); ++i)
+		{
+			source[i] = static_cast<uint8_t>(i);
+		}
+
+		//
+		// Odd offset and a count that leaves a scalar tail after the vector loop.
+		//
+		constexpr size_t count = 27;
+		uint8_t destination[count * sizeof(uint32_t) + 1];
+
+		common::memory::ByteSwap32(source + 1, destination + 1, count);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			uint32_t expected, actual;
+
+			memcpy(&expected, source + 1 + i * sizeof(uint32_t), sizeof(expected));
+			memcpy(&actual, destination + 1 + i * sizeof(uint32_t), sizeof(actual));
+
+			Assert::AreEqual(common::memory::ByteSwap(expected), actual);
+		}
+	}
+
+	TEST_METHOD(ByteSwapBulkInPlace)
+	{
+		uint16_t values[19];
+		uint64_t wide[5];
+
+		for (size_t i = 0; i < _countof(values); ++i)
+		{
+			values[i] = static_cast<uint16_t>(0x0100 * i + i + 1);
+		}
+
+		for (size_t i = 0; i < _countof(wide); ++i)
+		{
+			wide[i] = 0x0102030405060708 * (i + 1);
+		}
+
+		common::memory::ByteSwap16(values, values, _countof(values));
+		common::memory::ByteSwap64(wide, wide, _countof(wide));
+
+		for (size_t i = 0; i < _countof(values); ++i)
+		{
+			Assert::AreEqual(common::memory::ByteSwap(static_cast<uint16_t>(0x0100 * i + i + 1)), values[i]);
+		}
+
+		for (size_t i = 0; i < _countof(wide); ++i)
+		{
+			Assert::AreEqual(common::memory::ByteSwap(uint64_t(0x0102030405060708 * (i + 1))), wide[i]);
+		}
+	}
+};
+
+}
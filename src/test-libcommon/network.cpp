@@ -1,6 +1,9 @@
 #include "pch.h"
 #include "libcommon/network.h"
+#include "libcommon/arena.h"
+#include "libcommon/network/adapters.h"
 #include "CppUnitTest.h"
+#include <cstdint>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -11,6 +14,22 @@ TEST_CLASS(TestLibCommonNetwork)
 {
 public:
 
+	TEST_METHOD(AdaptersInArenaAreAligned)
+	{
+		common::memory::Arena arena;
+		common::memory::ArenaResource resource(arena);
+
+		// Leave the arena at an odd offset.
+		arena.allocate(1, 1);
+
+		common::network::Adapters adapters(AF_UNSPEC, 0, &resource);
+
+		for (auto adapter = adapters.next(); nullptr != adapter; adapter = adapters.next())
+		{
+			Assert::AreEqual(uintptr_t(0), reinterpret_cast<uintptr_t>(adapter) % alignof(IP_ADAPTER_ADDRESSES));
+		}
+	}
+
 	TEST_METHOD(ConvertSlashEightPrefix)
 	{
 		Assert::AreEqual(::common::network::MaskFromRoutingPrefix(8), 0xFF000000);
@@ -36,6 +55,27 @@ public:
 		Assert::AreEqual(::common::network::MaskFromRoutingPrefix(0), 0U);
 	}
 
+	TEST_METHOD(ConvertUnalignedLiteralAddress)
+	{
+		const uint8_t data[] = { 0x00, 0x7F, 0x00, 0x00, 0x01 };
+
+		Assert::AreEqual(::common::network::LiteralAddressToNetwork(data + 1), 0x7F000001U);
+	}
+
+	TEST_METHOD(ConvertLiteralAddressTable)
+	{
+		const uint8_t data[] = { 0x00, 0x7F, 0x00, 0x00, 0x01, 0x0A, 0x00, 0x00, 0x01, 0xC0, 0xA8, 0x01, 0x01 };
+
+		uint32_t converted[3];
+
+		::common::network::LiteralAddressesToNetwork(data + 1, 3, converted);
+
+		for (size_t i = 0; i < 3; ++i)
+		{
+			Assert::AreEqual(::common::network::LiteralAddressToNetwork(data + 1 + i * 4), converted[i]);
+		}
+	}
+
 };
 
 }
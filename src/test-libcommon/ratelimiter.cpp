@@ -0,0 +1,125 @@
+#include "pch.h"
+#include "libcommon/ratelimiter.h"
+#include "libcommon/virtualtime.h"
+#include "CppUnitTest.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std::chrono_literals;
+
+namespace testlibcommon
+{
+
+TEST_CLASS(TestLibCommonRateLimiter)
+{
+public:
+
+	TEST_METHOD(BurstIsAvailableImmediately)
+	{
+		auto clock = std::make_shared<common::VirtualClock>();
+		common::RateLimiter limiter(100ms, 3, clock);
+
+		Assert::IsTrue(limiter.tryAcquire());
+		Assert::IsTrue(limiter.tryAcquire());
+		Assert::IsTrue(limiter.tryAcquire());
+		Assert::IsFalse(limiter.tryAcquire());
+	}
+
+	TEST_METHOD(PermitsRefillAtRate)
+	{
+		auto clock = std::make_shared<common::VirtualClock>();
+		common::RateLimiter limiter(100ms, 3, clock);
+
+		Assert::IsTrue(limiter.tryAcquire(3));
+
+		clock->advance(99ms);
+		Assert::IsFalse(limiter.tryAcquire());
+
+		clock->advance(1ms);
+		Assert::IsTrue(limiter.tryAcquire());
+		Assert::IsFalse(limiter.tryAcquire());
+
+		//
+		// Idle time does not accumulate beyond the burst capacity.
+		//
+		clock->advance(10s);
+		Assert::IsTrue(limiter.tryAcquire(3));
+		Assert::IsFalse(limiter.tryAcquire());
+	}
+
+	TEST_METHOD(RequestAboveBurstFails)
+	{
+		auto clock = std::make_shared<common::VirtualClock>();
+		common::RateLimiter limiter(100ms, 2, clock);
+
+		Assert::IsFalse(limiter.tryAcquire(3));
+		Assert::IsTrue(limiter.tryAcquire(2));
+	}
+
+	TEST_METHOD(AcquireWaitsForPermit)
+	{
+		auto clock = std::make_shared<common::VirtualClock>();
+		common::RateLimiter limiter(100ms, 1, clock);
+
+		limiter.acquire();
+
+		std::atomic<bool> acquired = false;
+
+		std::thread waiter([&]()
+		{
+			limiter.acquire();
+			acquired = true;
+		});
+
+		std::this_thread::sleep_for(20ms);
+		Assert::IsFalse(acquired.load());
+
+		clock->advance(100ms);
+		waiter.join();
+
+		Assert::IsTrue(acquired.load());
+	}
+
+	TEST_METHOD(ContendedAcquireRespectsRate)
+	{
+		common::RateLimiter limiter(1ms, 10);
+
+		std::atomic<int64_t> granted = 0;
+		std::vector<std::thread> threads;
+
+		const auto start = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < 8; ++i)
+		{
+			threads.emplace_back([&]()
+			{
+				const auto end = start + 200ms;
+
+				while (std::chrono::steady_clock::now() < end)
+				{
+					if (limiter.tryAcquire())
+					{
+						++granted;
+					}
+				}
+			});
+		}
+
+		for (auto &thread : threads)
+		{
+			thread.join();
+		}
+
+		const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::steady_clock::now() - start).count();
+
+		Assert::IsTrue(granted.load() <= elapsed + 10 + 1);
+		Assert::IsTrue(granted.load() >= 100);
+	}
+};
+
+}
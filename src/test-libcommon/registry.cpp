@@ -1,9 +1,11 @@
 #include "pch.h"
 #include "libcommon/registry/registry.h"
+#include "libcommon/arena.h"
 #include "CppUnitTest.h"
 #include <algorithm>
 #include <functional>
 #include <iostream>
+#include <memory_resource>
 #include <string>
 #include <vector>
 #include <unordered_set>
@@ -61,6 +63,51 @@ namespace testlibcommon
 
 using namespace common::registry;
 
+namespace
+{
+
+//
+// Forwards to another resource, keeping track of the weakest alignment requested.
+//
+class AlignmentRecordingResource : public std::pmr::memory_resource
+{
+public:
+
+	explicit AlignmentRecordingResource(std::pmr::memory_resource *upstream)
+		: m_upstream(upstream)
+		, m_minimumAlignment(alignof(std::max_align_t))
+	{
+	}
+
+	size_t minimumAlignment() const
+	{
+		return m_minimumAlignment;
+	}
+
+private:
+
+	void *do_allocate(size_t bytes, size_t alignment) override
+	{
+		m_minimumAlignment = (std::min)(m_minimumAlignment, alignment);
+		return m_upstream->allocate(bytes, alignment);
+	}
+
+	void do_deallocate(void *p, size_t bytes, size_t alignment) override
+	{
+		m_upstream->deallocate(p, bytes, alignment);
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+	{
+		return this == &other;
+	}
+
+	std::pmr::memory_resource *m_upstream;
+	size_t m_minimumAlignment;
+};
+
+} // anonymous namespace
+
 HKEY g_regroot = HKEY_CURRENT_USER;
 const wchar_t g_subkey[] = L"Software\\Amagicom-Test";
 
@@ -87,6 +134,44 @@ public:
 		Registry::OpenKey(g_regroot, g_subkey, true);
 	}
 
+	TEST_METHOD(TryOpenKey)
+	{
+		Assert::IsTrue(Registry::TryOpenKey(g_regroot, g_subkey).hasValue());
+
+		const auto missing = Registry::TryOpenKey(g_regroot, std::wstring(g_subkey).append(L"\\Missing"));
+
+		Assert::IsFalse(missing.hasValue());
+		Assert::AreEqual(DWORD(ERROR_FILE_NOT_FOUND), missing.error().code);
+	}
+
+	TEST_METHOD(TryReadValue)
+	{
+		const auto key = Registry::OpenKey(g_regroot, g_subkey, true);
+
+		const std::wstring valueName(L"TryValue");
+
+		const auto missing = key->tryReadUint32(valueName);
+
+		Assert::IsFalse(missing.hasValue());
+		Assert::AreEqual(DWORD(ERROR_FILE_NOT_FOUND), missing.error().code);
+
+		key->writeValue(valueName, uint32_t(0xbeefcafe));
+
+		Assert::AreEqual(uint32_t(0xbeefcafe), key->tryReadUint32(valueName).value());
+
+		// Wrong type.
+		const auto mismatch = key->tryReadString(valueName);
+
+		Assert::IsFalse(mismatch.hasValue());
+		Assert::IsFalse(mismatch.error().system);
+
+		// The throwing variant reports the same error.
+		Assert::ExpectException<std::runtime_error>([&key, &valueName]()
+		{
+			key->readString(valueName);
+		});
+	}
+
 	TEST_METHOD(WriteReadStringValue)
 	{
 		std::unique_ptr<RegistryKey> key;
@@ -185,6 +270,38 @@ public:
 		Assert::AreEqual(valueData, readValueData);
 	}
 
+	TEST_METHOD(ReadStringArrayIntoArena)
+	{
+		const auto key = Registry::OpenKey(g_regroot, g_subkey, true);
+
+		const std::wstring valueName(L"StringArrayValue");
+		const std::vector<std::wstring> valueData
+		{
+			L"three",
+			L"blind",
+			L"mice"
+		};
+
+		key->writeValue(valueName, valueData);
+
+		common::memory::Arena arena;
+		common::memory::ArenaResource arenaResource(arena);
+		AlignmentRecordingResource resource(&arenaResource);
+
+		// Leave the arena at an odd offset.
+		arena.allocate(1, 1);
+
+		const auto readValueData = key->readStringArray(valueName, &resource);
+
+		Assert::IsTrue(resource.minimumAlignment() >= alignof(wchar_t));
+		Assert::AreEqual(valueData.size(), readValueData.size());
+
+		for (size_t i = 0; i < valueData.size(); ++i)
+		{
+			Assert::AreEqual(valueData[i], std::wstring(readValueData[i]));
+		}
+	}
+
 	TEST_METHOD(WriteDeleteValue)
 	{
 		std::unique_ptr<RegistryKey> key;
@@ -0,0 +1,191 @@
+#include "pch.h"
+#include "libcommon/ringbuffer.h"
+#include "CppUnitTest.h"
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace testlibcommon
+{
+
+TEST_CLASS(TestLibCommonRingBuffer)
+{
+public:
+
+	TEST_METHOD(CapacityIsRoundedToPowerTwo)
+	{
+		common::ByteRingBuffer ring(100);
+
+		Assert::AreEqual(size_t(128), ring.capacity());
+	}
+
+	TEST_METHOD(WriteStopsWhenFull)
+	{
+		common::ByteRingBuffer ring(16);
+
+		const uint8_t data[32] = { 0 };
+
+		Assert::AreEqual(size_t(16), ring.write(data, sizeof(data)));
+		Assert::IsTrue(ring.reserve().empty());
+	}
+
+	TEST_METHOD(DataWrapsAround)
+	{
+		common::ByteRingBuffer ring(16);
+
+		uint8_t data[16];
+
+		for (uint8_t i = 0; i < sizeof(data); ++i)
+		{
+			data[i] = i;
+		}
+
+		uint8_t received[16];
+
+		Assert::AreEqual(size_t(12), ring.write(data, 12));
+		Assert::AreEqual(size_t(12), ring.read(received, sizeof(received)));
+
+		//
+		// Only four bytes remain before the wrap point.
+		//
+		Assert::AreEqual(size_t(4), ring.reserve().size());
+
+		Assert::AreEqual(size_t(10), ring.write(data, 10));
+		Assert::AreEqual(size_t(4), ring.peek().size());
+		Assert::AreEqual(size_t(10), ring.read(received, sizeof(received)));
+		Assert::AreEqual(0, memcmp(data, received, 10));
+	}
+
+	TEST_METHOD(RegionsEndingAtWrapPoint)
+	{
+		common::ByteRingBuffer ring(16);
+
+		const uint8_t data[16] = { 0 };
+		uint8_t received[16];
+
+		Assert::IsFalse(ring.endsAtWrapPoint(ring.reserve(8)));
+		Assert::IsTrue(ring.endsAtWrapPoint(ring.reserve()));
+
+		Assert::AreEqual(size_t(12), ring.write(data, 12));
+		Assert::AreEqual(size_t(4), ring.read(received, 4));
+
+		Assert::IsTrue(ring.endsAtWrapPoint(ring.reserve()));
+
+		Assert::AreEqual(size_t(4), ring.write(data, 4));
+
+		//
+		// Free space is [0, 4), well before the wrap point.
+		//
+		Assert::AreEqual(size_t(4), ring.reserve().size());
+		Assert::IsFalse(ring.endsAtWrapPoint(ring.reserve()));
+
+		Assert::AreEqual(size_t(8), ring.read(received, 8));
+
+		Assert::AreEqual(size_t(4), ring.peek().size());
+		Assert::IsTrue(ring.endsAtWrapPoint(ring.peek()));
+	}
+
+	TEST_METHOD(PartialCommitAndConsume)
+	{
+		common::ByteRingBuffer ring(16);
+
+		auto region = ring.reserve(8);
+		Assert::AreEqual(size_t(8), region.size());
+
+		region[0] = 0xAA;
+		region[1] = 0xBB;
+		ring.commit(2);
+
+		auto readable = ring.peek();
+		Assert::AreEqual(size_t(2), readable.size());
+		Assert::AreEqual(uint8_t(0xAA), readable[0]);
+
+		ring.consume(1);
+
+		readable = ring.peek();
+		Assert::AreEqual(size_t(1), readable.size());
+		Assert::AreEqual(uint8_t(0xBB), readable[0]);
+	}
+
+	TEST_METHOD(MirroredRegionsAreContiguous)
+	{
+		common::ByteRingBuffer ring(1, true);
+
+		const auto capacity = ring.capacity();
+
+		Assert::IsTrue(ring.mirrored());
+
+		ring.commit(capacity - 4);
+		ring.consume(capacity - 4);
+
+		//
+		// The full capacity is available in one region despite straddling the wrap point.
+		//
+		auto region = ring.reserve();
+		Assert::AreEqual(capacity, region.size());
+
+		region[4] = 0x5A;
+		ring.commit(8);
+
+		const auto readable = ring.peek();
+		Assert::AreEqual(size_t(8), readable.size());
+		Assert::AreEqual(uint8_t(0x5A), readable[4]);
+	}
+
+	TEST_METHOD(TransferAcrossThreads)
+	{
+		common::ByteRingBuffer ring(4096);
+
+		constexpr size_t total = 16 * 1024 * 1024;
+
+		uint64_t received = 0;
+		bool ordered = true;
+
+		std::thread consumer([&]()
+		{
+			uint8_t expected = 0;
+			size_t count = 0;
+
+			while (count < total)
+			{
+				const auto region = ring.peek();
+
+				for (const auto value : region)
+				{
+					ordered = ordered && (value == expected++);
+					received += value;
+				}
+
+				count += region.size();
+				ring.consume(region.size());
+			}
+		});
+
+		uint64_t sent = 0;
+		uint8_t value = 0;
+		size_t count = 0;
+
+		while (count < total)
+		{
+			const auto region = ring.reserve(total - count);
+
+			for (auto &slot : region)
+			{
+				slot = value++;
+				sent += slot;
+			}
+
+			count += region.size();
+			ring.commit(region.size());
+		}
+
+		consumer.join();
+
+		Assert::IsTrue(ordered);
+		Assert::AreEqual(sent, received);
+	}
+};
+
+}
@@ -0,0 +1,220 @@
+#include "pch.h"
+#include "libcommon/logging/rotatingfilelog.h"
+#include "libcommon/virtualtime.h"
+#include "CppUnitTest.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std::chrono_literals;
+using common::logging::LogLevel;
+using common::logging::RotatingFileLog;
+
+namespace testlibcommon
+{
+
+namespace
+{
+
+class TemporaryDirectory
+{
+public:
+
+	TemporaryDirectory()
+		: m_path(std::filesystem::temp_directory_path() / L"test-libcommon-rotatingfilelog")
+	{
+		std::filesystem::remove_all(m_path);
+		std::filesystem::create_directories(m_path);
+	}
+
+	~TemporaryDirectory()
+	{
+		std::error_code error;
+		std::filesystem::remove_all(m_path, error);
+	}
+
+	const std::filesystem::path &path() const
+	{
+		return m_path;
+	}
+
+	std::vector<std::wstring> files() const
+	{
+		std::vector<std::wstring> names;
+
+		for (const auto &entry : std::filesystem::directory_iterator(m_path))
+		{
+			names.push_back(entry.path().filename().wstring());
+		}
+
+		std::sort(names.begin(), names.end());
+
+		return names;
+	}
+
+private:
+
+	std::filesystem::path m_path;
+};
+
+std::string ReadFile(const std::filesystem::path &path)
+{
+	std::ifstream file(path, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+RotatingFileLog::Options CreateOptions(const TemporaryDirectory &directory)
+{
+	RotatingFileLog::Options options;
+
+	options.directory = directory.path().wstring();
+	options.baseName = L"test";
+
+	return options;
+}
+
+} // anonymous namespace
+
+TEST_CLASS(TestLibCommonRotatingFileLog)
+{
+public:
+
+	TEST_METHOD(LinesAreWrittenAndSegmentTruncated)
+	{
+		TemporaryDirectory directory;
+
+		{
+			RotatingFileLog log(CreateOptions(directory));
+
+			auto target = log.target();
+
+			target(LogLevel::Info, "first");
+			target(LogLevel::Error, "second");
+		}
+
+		const auto contents = ReadFile(directory.path() / L"test.1.log");
+
+		Assert::IsTrue(contents.find("][Info] first\r\n") != std::string::npos);
+		Assert::IsTrue(contents.find("][Error] second\r\n") != std::string::npos);
+
+		//
+		// The unused part of the mapping is truncated.
+		//
+		Assert::AreEqual(size_t(2), size_t(std::count(contents.begin(), contents.end(), '\n')));
+		Assert::AreEqual('\n', contents.back());
+	}
+
+	TEST_METHOD(SegmentsRollBySizeAndAreRetained)
+	{
+		TemporaryDirectory directory;
+
+		auto options = CreateOptions(directory);
+
+		options.segmentSize = 256;
+		options.retainedSegments = 3;
+
+		{
+			RotatingFileLog log(options);
+
+			for (int i = 0; i < 50; ++i)
+			{
+				log.write(LogLevel::Debug, "a line that takes up a fair share of a segment");
+			}
+		}
+
+		const auto files = directory.files();
+
+		Assert::AreEqual(size_t(3), files.size());
+
+		for (const auto &file : files)
+		{
+			const auto contents = ReadFile(directory.path() / file);
+
+			Assert::IsTrue(contents.size() <= 256);
+
+			//
+			// Lines are not split across segments.
+			//
+			Assert::AreEqual('\n', contents.back());
+		}
+	}
+
+	TEST_METHOD(SegmentsRollByAge)
+	{
+		TemporaryDirectory directory;
+		common::VirtualTimeDriver driver;
+
+		auto options = CreateOptions(directory);
+
+		options.maximumAge = 1000ms;
+		options.scheduler = driver.scheduler();
+
+		RotatingFileLog log(options);
+
+		log.write(LogLevel::Info, "first");
+
+		const auto first = log.activeSegment();
+
+		driver.advance(999ms);
+		log.write(LogLevel::Info, "second");
+
+		Assert::AreEqual(first, log.activeSegment());
+
+		driver.advance(1ms);
+		log.write(LogLevel::Info, "third");
+
+		Assert::AreNotEqual(first, log.activeSegment());
+	}
+
+	TEST_METHOD(FailedRollDropsLineAndIsRetried)
+	{
+		TemporaryDirectory directory;
+
+		auto options = CreateOptions(directory);
+
+		options.segmentSize = 64;
+
+		RotatingFileLog log(options);
+
+		log.write(LogLevel::Info, "first");
+
+		//
+		// A directory in place of the next segment makes creating it fail.
+		//
+		std::filesystem::create_directory(directory.path() / L"test.2.log");
+
+		log.write(LogLevel::Info, "second");
+
+		std::filesystem::remove(directory.path() / L"test.2.log");
+
+		log.write(LogLevel::Info, "third");
+
+		const auto contents = ReadFile(log.activeSegment());
+
+		Assert::AreEqual((directory.path() / L"test.2.log").wstring(), log.activeSegment());
+		Assert::IsTrue(contents.find("second") == std::string::npos);
+		Assert::IsTrue(contents.find("][Info] third\r\n") != std::string::npos);
+	}
+
+	TEST_METHOD(SequenceContinuesAcrossInstances)
+	{
+		TemporaryDirectory directory;
+
+		{
+			RotatingFileLog log(CreateOptions(directory));
+			log.write(LogLevel::Info, "first");
+		}
+
+		RotatingFileLog log(CreateOptions(directory));
+
+		Assert::AreEqual((directory.path() / L"test.2.log").wstring(), log.activeSegment());
+		Assert::AreEqual(size_t(2), directory.files().size());
+	}
+};
+
+}
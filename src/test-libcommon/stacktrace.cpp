@@ -0,0 +1,140 @@
+#include "pch.h"
+#include "libcommon/error.h"
+#include "libcommon/logging/logsink.h"
+#include "libcommon/stacktrace.h"
+#include "CppUnitTest.h"
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using common::StackTrace;
+using common::logging::LogLevel;
+using common::logging::LogSink;
+
+namespace testlibcommon
+{
+
+namespace
+{
+
+//
+// Restores the default when the test is done.
+//
+struct StackTracesEnabled
+{
+	StackTracesEnabled()
+	{
+		common::error::EnableStackTraces(true);
+	}
+
+	~StackTracesEnabled()
+	{
+		common::error::EnableStackTraces(false);
+	}
+};
+
+size_t CountFrameMessages(const std::vector<std::string> &messages)
+{
+	size_t frames = 0;
+
+	for (const auto &message : messages)
+	{
+		if (0 == message.compare(0, 7, "    at "))
+		{
+			++frames;
+		}
+	}
+
+	return frames;
+}
+
+std::vector<std::string> UnwindNested()
+{
+	std::vector<std::string> messages;
+
+	auto sink = std::make_shared<LogSink>([&messages](LogLevel, const char *msg)
+	{
+		messages.push_back(msg);
+	});
+
+	try
+	{
+		try
+		{
+			THROW_ERROR("Inner failure");
+		}
+		catch (...)
+		{
+			THROW_WINDOWS_ERROR(ERROR_ACCESS_DENIED, "Outer operation");
+		}
+	}
+	catch (const std::exception &err)
+	{
+		common::error::UnwindException(err, sink);
+	}
+
+	return messages;
+}
+
+} // anonymous namespace
+
+TEST_CLASS(TestLibCommonStackTrace)
+{
+public:
+
+	TEST_METHOD(CaptureIsBounded)
+	{
+		const auto trace = StackTrace::Capture();
+
+		Assert::IsTrue(trace.size() > 0);
+		Assert::IsTrue(trace.size() <= StackTrace::MaximumFrames);
+		Assert::IsTrue(nullptr != trace.frame(0));
+	}
+
+	TEST_METHOD(SymbolizeResolvesEveryFrame)
+	{
+		const auto trace = StackTrace::Capture();
+		const auto frames = trace.symbolize();
+
+		Assert::AreEqual(trace.size(), frames.size());
+
+		for (const auto &frame : frames)
+		{
+			Assert::IsFalse(frame.empty());
+		}
+	}
+
+	TEST_METHOD(UnwindLogsTracesWhenEnabled)
+	{
+		const auto untraced = UnwindNested();
+
+		Assert::AreEqual(size_t(2), untraced.size());
+		Assert::AreEqual(size_t(0), CountFrameMessages(untraced));
+
+		StackTracesEnabled enabled;
+
+		const auto traced = UnwindNested();
+
+		Assert::IsTrue(CountFrameMessages(traced) >= 2);
+		Assert::AreEqual(std::string("Outer operation: 0x00000005: "), traced[0].substr(0, 29));
+	}
+
+	TEST_METHOD(TracedExceptionKeepsType)
+	{
+		StackTracesEnabled enabled;
+
+		Assert::ExpectException<common::error::WindowsException>([]()
+		{
+			THROW_WINDOWS_ERROR(ERROR_ACCESS_DENIED, "Operation");
+		});
+
+		Assert::ExpectException<std::runtime_error>([]()
+		{
+			THROW_ERROR("Failure");
+		});
+	}
+};
+
+}
@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "libcommon/string.h"
+#include "libcommon/arena.h"
 #include "CppUnitTest.h"
 #include <algorithm>
 
@@ -97,6 +98,24 @@ public:
 		Assert::AreEqual(L"1000:2000:3000:4000:5000:6000:7000:8000", common::string::FormatIpv6(ip).c_str());
 	}
 
+	TEST_METHOD(TokenizeIntoArena)
+	{
+		common::memory::Arena arena;
+		common::memory::ArenaResource resource(arena);
+
+		const auto tokens = common::string::Tokenize(L"key1=value1;key2;;key3=", L";", &resource);
+
+		Assert::AreEqual(size_t(3), tokens.size());
+		Assert::IsTrue(tokens.get_allocator().resource() == &resource);
+
+		const auto pairs = common::string::SplitKeyValuePairs(tokens, &resource);
+
+		Assert::AreEqual(size_t(3), pairs.size());
+		Assert::AreEqual(L"value1", pairs.at(L"key1").c_str());
+		Assert::AreEqual(L"", pairs.at(L"key2").c_str());
+		Assert::AreEqual(L"", pairs.at(L"key3").c_str());
+	}
+
 };
 
 }
@@ -0,0 +1,163 @@
+#include "pch.h"
+#include "libcommon/timerwheel.h"
+#include "libcommon/burstguard.h"
+#include "libcommon/virtualtime.h"
+#include "CppUnitTest.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std::chrono_literals;
+
+namespace testlibcommon
+{
+
+namespace
+{
+
+template<typename Predicate>
+bool WaitFor(Predicate predicate, std::chrono::milliseconds timeout = 5s)
+{
+	const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+	while (false == predicate())
+	{
+		if (std::chrono::steady_clock::now() >= deadline)
+		{
+			return false;
+		}
+
+		std::this_thread::sleep_for(1ms);
+	}
+
+	return true;
+}
+
+} // anonymous namespace
+
+TEST_CLASS(TestLibCommonTimerWheel)
+{
+public:
+
+	TEST_METHOD(TimerFiresAfterDelay)
+	{
+		common::TimerWheel wheel;
+
+		std::atomic<bool> fired = false;
+		common::TimerWheel::Timer timer(wheel, [&fired]() { fired = true; });
+
+		const auto start = std::chrono::steady_clock::now();
+
+		timer.arm(20ms);
+
+		Assert::IsTrue(WaitFor([&fired]() { return fired.load(); }));
+		Assert::IsTrue(std::chrono::steady_clock::now() - start >= 20ms);
+		Assert::IsFalse(timer.armed());
+	}
+
+	TEST_METHOD(CancelledTimerDoesNotFire)
+	{
+		common::TimerWheel wheel;
+
+		std::atomic<int> fired = 0;
+		common::TimerWheel::Timer timer(wheel, [&fired]() { ++fired; });
+
+		timer.arm(10ms);
+
+		Assert::IsTrue(timer.cancel());
+		Assert::IsFalse(timer.cancel());
+
+		std::this_thread::sleep_for(30ms);
+
+		Assert::AreEqual(0, fired.load());
+	}
+
+	TEST_METHOD(RearmReplacesExpiry)
+	{
+		common::TimerWheel wheel;
+
+		std::atomic<int> fired = 0;
+		common::TimerWheel::Timer timer(wheel, [&fired]() { ++fired; });
+
+		timer.arm(10ms);
+		timer.arm(150ms);
+
+		std::this_thread::sleep_for(50ms);
+		Assert::AreEqual(0, fired.load());
+
+		Assert::IsTrue(WaitFor([&fired]() { return 1 == fired.load(); }));
+	}
+
+	TEST_METHOD(TimersBeyondInnerLevelFire)
+	{
+		common::TimerWheel wheel;
+
+		std::atomic<int> fired = 0;
+
+		common::TimerWheel::Timer near(wheel, [&fired]() { ++fired; });
+		common::TimerWheel::Timer far(wheel, [&fired]() { ++fired; });
+
+		near.arm(5ms);
+		far.arm(300ms);
+
+		Assert::IsTrue(WaitFor([&fired]() { return 2 == fired.load(); }));
+	}
+
+	TEST_METHOD(ThousandGuardsShareWheel)
+	{
+		auto wheel = std::make_shared<common::TimerWheel>();
+
+		std::atomic<int> fired = 0;
+		std::vector<std::unique_ptr<common::BurstGuard>> guards;
+
+		for (int i = 0; i < 1000; ++i)
+		{
+			guards.emplace_back(std::make_unique<common::BurstGuard>([&fired]() { ++fired; }, 20, 0, wheel));
+		}
+
+		for (int round = 0; round < 3; ++round)
+		{
+			for (auto &guard : guards)
+			{
+				guard->trigger();
+			}
+		}
+
+		Assert::IsTrue(WaitFor([&fired]() { return 1000 == fired.load(); }));
+
+		//
+		// Each guard saw one burst.
+		//
+		std::this_thread::sleep_for(50ms);
+		Assert::AreEqual(1000, fired.load());
+	}
+
+	TEST_METHOD(ManualWheelFiresInVirtualTime)
+	{
+		common::VirtualTimeDriver driver;
+
+		std::vector<int64_t> fired;
+
+		common::TimerWheel::Timer timer(*driver.scheduler(), [&]()
+		{
+			fired.push_back(std::chrono::duration_cast<std::chrono::milliseconds>(driver.now()).count());
+		});
+
+		//
+		// Beyond the range of the outermost level.
+		//
+		timer.arm(10h);
+
+		driver.advance(10h - 1ms);
+		Assert::IsTrue(fired.empty());
+
+		driver.advance(1ms);
+		Assert::AreEqual(size_t(1), fired.size());
+		Assert::AreEqual(int64_t(10 * 60 * 60 * 1000), fired[0]);
+	}
+};
+
+}